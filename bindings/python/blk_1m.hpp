@@ -205,27 +205,32 @@ namespace libcloudphxx {
         );
       }
 
+      // columns along the last axis, returns the rain flux out of the domain in each column
       template<class arr_t>
-      typename arr_t::T_numtype rhs_columnwise(
+      bp::object rhs_columnwise(
         const b1m::opts_t<typename arr_t::T_numtype> &opts,
         bp_array &dot_rr,
         const bp_array &rhod,
         const bp_array &rr,
         const typename arr_t::T_numtype &dz
       ) {
-        arr_t
-        np2bz_dot_rr(np2bz<arr_t>(dot_rr));
-        return b1m::rhs_columnwise(
+        using real_t = typename arr_t::T_numtype;
+        const columns_t<real_t> cols(rhod);
+        std::vector<real_t> flux(cols.n_col);
+        b1m::rhs_columnwise_batch(
           opts,
-          np2bz_dot_rr,
-          np2bz<arr_t>(rhod),
-          np2bz<arr_t>(rr),
-          dz
+          cols.n_col, cols.n_z, cols.n_z, 1,
+          cols.ptr(dot_rr),
+          cols.ptr(rhod),
+          cols.ptr(rr),
+          dz,
+          flux.data()
         );
+        return cols.out(std::move(flux));
       }
 
       template <class arr_t>
-      typename arr_t::T_numtype rhs_columnwise_ice(
+      bp::object rhs_columnwise_ice(
         const b1m::opts_t<typename arr_t::T_numtype> &opts,
         bp_array &dot_ri,
         const bp_array &rhod,
@@ -233,16 +238,20 @@ namespace libcloudphxx {
         const typename arr_t::T_numtype &dz,
         const b1m::ice_t ice_type
       ) {
-        arr_t
-        np2bz_dot_ri(np2bz<arr_t>(dot_ri));
-        return b1m::rhs_columnwise_ice(
+        using real_t = typename arr_t::T_numtype;
+        const columns_t<real_t> cols(rhod);
+        std::vector<real_t> flux(cols.n_col);
+        b1m::rhs_columnwise_ice_batch(
           opts,
-          np2bz_dot_ri,
-          np2bz<arr_t>(rhod),
-          np2bz<arr_t>(ri),
+          cols.n_col, cols.n_z, cols.n_z, 1,
+          cols.ptr(dot_ri),
+          cols.ptr(rhod),
+          cols.ptr(ri),
           dz,
-          ice_type
+          ice_type,
+          flux.data()
         );
+        return cols.out(std::move(flux));
       }
     };
   };
@@ -9,6 +9,7 @@
 #include <libcloudph++/blk_2m/options.hpp>
 #include <libcloudph++/blk_2m/rhs_cellwise.hpp>
 #include <libcloudph++/blk_2m/rhs_columnwise.hpp>
+#include <libcloudph++/lgrngn/backend.hpp>
 
 namespace libcloudphxx
 {
@@ -34,7 +35,8 @@ namespace libcloudphxx
 	const bp_array &nc,
 	const bp_array &rr,
 	const bp_array &nr,
-	const typename arr_t::T_numtype &dt
+	const typename arr_t::T_numtype &dt,
+	const libcloudphxx::lgrngn::backend_t &backend
       )
       {
 	arr_t
@@ -63,12 +65,38 @@ namespace libcloudphxx
 	  np2bz_nc,
 	  np2bz_rr,
 	  np2bz_nr,
-	  dt
+	  dt,
+	  arr_t(),
+	  backend
 	);
       }
 
+      // backend defaults to serial (as in the C++ API)
+      template <typename arr_t>
+      void rhs_cellwise_serial(
+	const b2m::opts_t<typename arr_t::T_numtype> &opts,
+	bp_array &dot_th,
+	bp_array &dot_rv,
+	bp_array &dot_rc,
+	bp_array &dot_nc,
+	bp_array &dot_rr,
+	bp_array &dot_nr,
+	const bp_array &rhod,
+	const bp_array &th,
+	const bp_array &rv,
+	const bp_array &rc,
+	const bp_array &nc,
+	const bp_array &rr,
+	const bp_array &nr,
+	const typename arr_t::T_numtype &dt
+      )
+      {
+	rhs_cellwise<arr_t>(opts, dot_th, dot_rv, dot_rc, dot_nc, dot_rr, dot_nr, rhod, th, rv, rc, nc, rr, nr, dt, libcloudphxx::lgrngn::serial);
+      }
+
+      // columns along the last axis, returns the rain flux out of the domain in each column
       template <typename arr_t>
-      typename arr_t::T_numtype rhs_columnwise(
+      bp::object rhs_columnwise(
 	const b2m::opts_t<typename arr_t::T_numtype> &opts,
 	bp_array &dot_rr,
 	bp_array &dot_nr,
@@ -78,19 +106,22 @@ namespace libcloudphxx
 	const typename arr_t::T_numtype &dt,
 	const typename arr_t::T_numtype &dz
       ) {
-	arr_t
-	  np2bz_dot_rr(np2bz<arr_t>(dot_rr)),
-	  np2bz_dot_nr(np2bz<arr_t>(dot_nr));
-	return b2m::rhs_columnwise(
+	using real_t = typename arr_t::T_numtype;
+	const columns_t<real_t> cols(rhod);
+	std::vector<real_t> flux(cols.n_col);
+	b2m::rhs_columnwise_batch(
 	  opts,
-	  np2bz_dot_rr,
-	  np2bz_dot_nr,
-	  np2bz<arr_t>(rhod),
-	  np2bz<arr_t>(rr),
-	  np2bz<arr_t>(nr),
+	  cols.n_col, cols.n_z, cols.n_z, 1,
+	  cols.ptr(dot_rr),
+	  cols.ptr(dot_nr),
+	  cols.ptr(rhod),
+	  cols.ptr(rr),
+	  cols.ptr(nr),
 	  dt,
-	  dz
+	  dz,
+	  flux.data()
 	);
+	return cols.out(std::move(flux));
       }
 
       template <typename real_t>
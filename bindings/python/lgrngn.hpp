@@ -32,6 +32,8 @@ namespace libcloudphxx
       
           real_t funval(const real_t x) const
           {
+            // called from C++ code that may run with the GIL released
+            gil_acquire gil;
             return bp::extract<real_t>(fun(x)); 
           }
         };
@@ -44,6 +46,8 @@ namespace libcloudphxx
       ) {
         if(ran_with_mpi())
           throw std::runtime_error("The Python bindings of libcloudph++ Lagrangian microphysics can't be used in MPI runs.");
+        if(opts_init.rebalance_freq > 0)
+          throw std::runtime_error("opts_init.rebalance_freq > 0 is not supported in the Python bindings (there is no rebalance_hook to report the new MPI decomposition)");
         return lgr::factory(backend, opts_init);
       }
 
@@ -56,19 +60,38 @@ namespace libcloudphxx
           sizeof(real_t)
           * std::max(1, arg->opts_init->nx) 
           * std::max(1, arg->opts_init->ny) 
-          * std::max(1, arg->opts_init->nz), 
+          * std::max(1, arg->opts_init->nz) 
+          * std::max(1, arg->opts_init->n_ens), 
           PyBUF_READ
         ))); // TODO: this assumes Python 2 -> make it compatible with P3 or require P2 in CMake
       }
 
+      // (sequence number, NumPy array) of the oldest queued output or None if not ready;
+      // the data is copied, as the queue slot is reused after outbuf_pop()
       template <typename real_t>
-      const std::array<int, 3> sz(
+      bp::object outbuf_front(
+        lgr::particles_proto_t<real_t> *arg
+      ) {
+        unsigned long long seq;
+        const real_t *buf = arg->outbuf_front(seq);
+        if (buf == NULL) return bp::object();
+        const Py_intptr_t n = 
+            std::max(1, arg->opts_init->nx) 
+          * std::max(1, arg->opts_init->ny) 
+          * std::max(1, arg->opts_init->nz) 
+          * std::max(1, arg->opts_init->n_ens);
+        return bp::make_tuple(seq, vec2np(std::vector<real_t>(buf, buf + n), {n}));
+      }
+
+      template <typename real_t>
+      const std::array<int, 4> sz(
         const lgr::particles_proto_t<real_t> &arg
       ) {
-        return std::array<int, 3>({
+        return std::array<int, 4>({
           arg.opts_init->nx,
           arg.opts_init->ny,
-          arg.opts_init->nz
+          arg.opts_init->nz,
+          arg.opts_init->n_ens
         });
       }
 
@@ -95,14 +118,145 @@ namespace libcloudphxx
             np2ai<real_t>(bp::extract<bp_array>(ambient_chem.values()[i]), sz(*arg))
           ));
 
+        lgr::arrinfo_t<real_t>
+          np2ai_th(np2ai<real_t>(th, sz(*arg))),
+          np2ai_rv(np2ai<real_t>(rv, sz(*arg))),
+          np2ai_rhod(np2ai<real_t>(rhod, sz(*arg))),
+          np2ai_p(np2ai<real_t>(p, sz(*arg))),
+          np2ai_Cx(np2ai<real_t>(Cx, sz(*arg))),
+          np2ai_Cy(np2ai<real_t>(Cy, sz(*arg))),
+          np2ai_Cz(np2ai<real_t>(Cz, sz(*arg)));
+
+        gil_release gil;
         arg->init(
-          np2ai<real_t>(th,      sz(*arg)),
-          np2ai<real_t>(rv,      sz(*arg)),
-          np2ai<real_t>(rhod,    sz(*arg)),
-          np2ai<real_t>(p,       sz(*arg)),
-          np2ai<real_t>(Cx,      sz(*arg)),
-          np2ai<real_t>(Cy,      sz(*arg)),
-          np2ai<real_t>(Cz,      sz(*arg)),
+          np2ai_th,
+          np2ai_rv,
+          np2ai_rhod,
+          np2ai_p,
+          np2ai_Cx,
+          np2ai_Cy,
+          np2ai_Cz,
+          map // ambient_chem
+        );
+      }
+
+      namespace detail
+      {
+        // pointer to the data of a 1D array of SD attributes (NULL if not passed)
+        template <typename T>
+        const T *np2ptr(const bp_array &arg, const std::string &dtype, const std::size_t &n_sd)
+        {
+          if (not_numeric(arg))
+            return NULL;
+
+          if (std::string(bp::extract<std::string>(arg.attr("dtype").attr("name"))) != dtype)
+            throw std::runtime_error("dtype=" + dtype + " required for SD attributes");
+          if (!bp::extract<bool>(arg.attr("flags").attr("c_contiguous")))
+            throw std::runtime_error("contiguous memory layout required");
+          if (std::size_t(bp::extract<long>(arg.attr("size"))) != n_sd)
+            throw std::runtime_error("all SD attribute arrays have to be of the same size");
+
+          return reinterpret_cast<const T*>(
+            (py_ptr_t)bp::extract<py_ptr_t>(arg.attr("ctypes").attr("data"))
+          );
+        }
+      };
+
+      template <typename real_t>
+      bp::object get_attr(
+        lgr::particles_proto_t<real_t> *arg,
+        const std::string &name
+      ) {
+        std::vector<real_t> out;
+        {
+          gil_release gil;
+          out = arg->get_attr(name);
+        }
+        const Py_intptr_t n_sd = out.size();
+        return vec2np(std::move(out), {n_sd});
+      }
+
+      // 2D array, one row per attribute
+      template <typename real_t>
+      bp::object get_attrs(
+        lgr::particles_proto_t<real_t> *arg,
+        const bp::list &names
+      ) {
+        std::vector<std::string> nms;
+        for (int i = 0; i < len(names); ++i)
+          nms.push_back(bp::extract<std::string>(names[i]));
+        if (nms.empty())
+          throw std::runtime_error("at least one attribute name required");
+
+        std::vector<real_t> out;
+        {
+          gil_release gil;
+          out = arg->get_attrs(nms);
+        }
+        const Py_intptr_t n_attr = nms.size(), n_sd = out.size() / nms.size();
+        return vec2np(std::move(out), {n_attr, n_sd});
+      }
+
+      template <typename real_t>
+      void init_from_attrs(
+        lgr::particles_proto_t<real_t> *arg,
+        const bp_array &th,
+        const bp_array &rv,
+        const bp_array &rhod,
+        const bp_array &p,
+        const bp_array &Cx,
+        const bp_array &Cy,
+        const bp_array &Cz,
+        const bp::dict &ambient_chem,
+        const bp_array &n,
+        const bp_array &rd3,
+        const bp_array &kappa,
+        const bp_array &x,
+        const bp_array &y,
+        const bp_array &z,
+        const bp_array &rw2,
+        const bp_array &rd2_insol
+      )
+      {
+        typedef std::map<enum cmn::chem::chem_species_t, const lgr::arrinfo_t<real_t> > map_t;
+        map_t map;
+
+        for (int i = 0; i < len(ambient_chem.keys()); ++i)
+          map.insert(typename map_t::value_type(
+            bp::extract<enum cmn::chem::chem_species_t>(ambient_chem.keys()[i]),
+            np2ai<real_t>(bp::extract<bp_array>(ambient_chem.values()[i]), sz(*arg))
+          ));
+
+        lgr::sd_attrs_t<real_t> attrs;
+        attrs.n_sd = not_numeric(n) ? 0 : long(bp::extract<long>(n.attr("size")));
+        attrs.n         = detail::np2ptr<unsigned long long>(n, "uint64", attrs.n_sd);
+        attrs.rd3       = detail::np2ptr<real_t>(rd3,       "float64", attrs.n_sd);
+        attrs.kappa     = detail::np2ptr<real_t>(kappa,     "float64", attrs.n_sd);
+        attrs.x         = detail::np2ptr<real_t>(x,         "float64", attrs.n_sd);
+        attrs.y         = detail::np2ptr<real_t>(y,         "float64", attrs.n_sd);
+        attrs.z         = detail::np2ptr<real_t>(z,         "float64", attrs.n_sd);
+        attrs.rw2       = detail::np2ptr<real_t>(rw2,       "float64", attrs.n_sd);
+        attrs.rd2_insol = detail::np2ptr<real_t>(rd2_insol, "float64", attrs.n_sd);
+
+        lgr::arrinfo_t<real_t>
+          np2ai_th(np2ai<real_t>(th, sz(*arg))),
+          np2ai_rv(np2ai<real_t>(rv, sz(*arg))),
+          np2ai_rhod(np2ai<real_t>(rhod, sz(*arg))),
+          np2ai_p(np2ai<real_t>(p, sz(*arg))),
+          np2ai_Cx(np2ai<real_t>(Cx, sz(*arg))),
+          np2ai_Cy(np2ai<real_t>(Cy, sz(*arg))),
+          np2ai_Cz(np2ai<real_t>(Cz, sz(*arg)));
+
+        gil_release gil;
+        arg->init_from_attrs(
+          attrs,
+          np2ai_th,
+          np2ai_rv,
+          np2ai_rhod,
+          np2ai_p,
+          np2ai_Cx,
+          np2ai_Cy,
+          np2ai_Cz,
           map // ambient_chem
         );
       }
@@ -133,16 +287,23 @@ namespace libcloudphxx
 
         lgr::arrinfo_t<real_t>
           np2ai_th(np2ai<real_t>(th, sz(*arg))),
-          np2ai_rv(np2ai<real_t>(rv, sz(*arg)));
+          np2ai_rv(np2ai<real_t>(rv, sz(*arg))),
+          np2ai_rhod(np2ai<real_t>(rhod, sz(*arg))),
+          np2ai_Cx(np2ai<real_t>(Cx, sz(*arg))),
+          np2ai_Cy(np2ai<real_t>(Cy, sz(*arg))),
+          np2ai_Cz(np2ai<real_t>(Cz, sz(*arg))),
+          np2ai_diss_rate(np2ai<real_t>(diss_rate, sz(*arg)));
+
+        gil_release gil;
         arg->step_sync(
           opts, 
           np2ai_th,
           np2ai_rv,
-          np2ai<real_t>(rhod, sz(*arg)),
-          np2ai<real_t>(Cx, sz(*arg)),
-          np2ai<real_t>(Cy, sz(*arg)),
-          np2ai<real_t>(Cz, sz(*arg)),
-          np2ai<real_t>(diss_rate, sz(*arg)),
+          np2ai_rhod,
+          np2ai_Cx,
+          np2ai_Cy,
+          np2ai_Cz,
+          np2ai_diss_rate,
           map
         );
       }
@@ -172,15 +333,22 @@ namespace libcloudphxx
 
         lgr::arrinfo_t<real_t>
           np2ai_th(np2ai<real_t>(th, sz(*arg))),
-          np2ai_rv(np2ai<real_t>(rv, sz(*arg)));
+          np2ai_rv(np2ai<real_t>(rv, sz(*arg))),
+          np2ai_rhod(np2ai<real_t>(rhod, sz(*arg))),
+          np2ai_Cx(np2ai<real_t>(Cx, sz(*arg))),
+          np2ai_Cy(np2ai<real_t>(Cy, sz(*arg))),
+          np2ai_Cz(np2ai<real_t>(Cz, sz(*arg))),
+          np2ai_diss_rate(np2ai<real_t>(diss_rate, sz(*arg)));
+
+        gil_release gil;
         arg->sync_in(
           np2ai_th,
           np2ai_rv,
-          np2ai<real_t>(rhod, sz(*arg)),
-          np2ai<real_t>(Cx, sz(*arg)),
-          np2ai<real_t>(Cy, sz(*arg)),
-          np2ai<real_t>(Cz, sz(*arg)),
-          np2ai<real_t>(diss_rate, sz(*arg)),
+          np2ai_rhod,
+          np2ai_Cx,
+          np2ai_Cy,
+          np2ai_Cz,
+          np2ai_diss_rate,
           map
         );
       }
@@ -207,6 +375,7 @@ namespace libcloudphxx
         lgr::arrinfo_t<real_t>
           np2ai_th(np2ai<real_t>(th, sz(*arg))),
           np2ai_rv(np2ai<real_t>(rv, sz(*arg)));
+        gil_release gil;
         arg->step_cond(
           opts, 
           np2ai_th,
@@ -437,6 +606,46 @@ namespace libcloudphxx
         throw std::runtime_error("kernel_paramteres does not feature a getter yet - TODO");
       }
 
+      // (number of bins, number of cells) array
+      template <typename real_t>
+      bp::object diag_dry_spectrum(
+        lgr::particles_proto_t<real_t> *arg,
+        const bp_array &r_edges,
+        const int &k
+      )
+      {
+        const blitz::Array<real_t, 1> edges(np2bz<blitz::Array<real_t, 1>>(r_edges));
+        const std::vector<real_t> edges_vec(edges.begin(), edges.end());
+        std::vector<real_t> out;
+        {
+          gil_release gil;
+          out = arg->diag_dry_spectrum(edges_vec, k);
+        }
+        const Py_intptr_t n_bins = edges_vec.size() - 1,
+                          n_cell = out.size() / n_bins;
+        return vec2np(std::move(out), {n_bins, n_cell});
+      }
+
+      // (number of bins, number of cells) array
+      template <typename real_t>
+      bp::object diag_wet_spectrum(
+        lgr::particles_proto_t<real_t> *arg,
+        const bp_array &r_edges,
+        const int &k
+      )
+      {
+        const blitz::Array<real_t, 1> edges(np2bz<blitz::Array<real_t, 1>>(r_edges));
+        const std::vector<real_t> edges_vec(edges.begin(), edges.end());
+        std::vector<real_t> out;
+        {
+          gil_release gil;
+          out = arg->diag_wet_spectrum(edges_vec, k);
+        }
+        const Py_intptr_t n_bins = edges_vec.size() - 1,
+                          n_cell = out.size() / n_bins;
+        return vec2np(std::move(out), {n_bins, n_cell});
+      }
+
       template <typename real_t>
       void set_w_LS(
         lgr::opts_init_t<real_t> *arg,
@@ -170,6 +170,8 @@ BOOST_PYTHON_MODULE(libcloudphxx)
       .def_readwrite("r_c0", &b1m::opts_t<real_t>::r_c0)
       .def_readwrite("r_eps", &b1m::opts_t<real_t>::r_eps)
       .def_readwrite("nwtrph_iters", &b1m::opts_t<real_t>::nwtrph_iters)
+      .def_readwrite("nwtrph_tetens", &b1m::opts_t<real_t>::nwtrph_tetens)
+      .def_readwrite("nwtrph_eps", &b1m::opts_t<real_t>::nwtrph_eps)
       .def_readwrite("const_p", &b1m::opts_t<real_t>::const_p)
       .def_readwrite("th_dry", &b1m::opts_t<real_t>::th_dry)
       .def_readwrite("adj_nwtrph", &b1m::opts_t<real_t>::adj_nwtrph)
@@ -178,7 +180,7 @@ BOOST_PYTHON_MODULE(libcloudphxx)
     bp::def("rhs_cellwise", blk_1m::rhs_cellwise<arr_t>);
     bp::def("rhs_cellwise_revap", blk_1m::rhs_cellwise_revap<arr_t>);
     bp::def("rhs_cellwise_ice", blk_1m::rhs_cellwise_ice<arr_t>);
-    bp::def("rhs_columnwise", blk_1m::rhs_columnwise<arr_t>); // TODO: handle the returned flux
+    bp::def("rhs_columnwise", blk_1m::rhs_columnwise<arr_t>);
     bp::def("rhs_columnwise_ice", blk_1m::rhs_columnwise_ice<arr_t>);
 
     bp::enum_<b1m::ice_t>("ice_t")
@@ -203,8 +205,9 @@ BOOST_PYTHON_MODULE(libcloudphxx)
       .def_readwrite("const_p", &b2m::opts_t<real_t>::const_p)
       .def_readwrite("th_dry", &b2m::opts_t<real_t>::th_dry)
     ;
-    bp::def("rhs_cellwise", blk_2m::rhs_cellwise<arr_t>);
-    bp::def("rhs_columnwise", blk_2m::rhs_columnwise<arr_t>); // TODO: handle the returned flux
+    bp::def("rhs_cellwise", blk_2m::rhs_cellwise_serial<arr_t>);
+    bp::def("rhs_cellwise", blk_2m::rhs_cellwise<arr_t>); // with backend (lgrngn.backend_t)
+    bp::def("rhs_columnwise", blk_2m::rhs_columnwise<arr_t>);
   } 
 
   // lgrngn stuff
@@ -252,7 +255,11 @@ BOOST_PYTHON_MODULE(libcloudphxx)
     bp::enum_<lgr::src_t>("src_t") 
       .value("off", lgr::src_t::off)
       .value("simple", lgr::src_t::simple)
-      .value("matching", lgr::src_t::matching);
+      .value("matching", lgr::src_t::matching)
+      .value("matching_indexed", lgr::src_t::matching_indexed);
+    bp::enum_<lgr::chem_solver_t>("chem_solver_t") 
+      .value("rk4", lgr::chem_solver_t::rk4)
+      .value("ros2", lgr::chem_solver_t::ros2);
 
     bp::enum_<cmn::chem::chem_species_t>("chem_species_t")
       .value("H",    cmn::chem::H)
@@ -290,6 +297,7 @@ BOOST_PYTHON_MODULE(libcloudphxx)
       .add_property("dry_sizes", &lgrngn::get_ds<real_t>, &lgrngn::set_ds<real_t>)
       .add_property("rlx_dry_distros", &lgrngn::get_rdd<real_t>, &lgrngn::set_rdd<real_t>)
       .def_readwrite("nx", &lgr::opts_init_t<real_t>::nx)
+      .def_readwrite("n_ens", &lgr::opts_init_t<real_t>::n_ens)
       .def_readwrite("ny", &lgr::opts_init_t<real_t>::ny)
       .def_readwrite("nz", &lgr::opts_init_t<real_t>::nz)
       .def_readwrite("dx", &lgr::opts_init_t<real_t>::dx)
@@ -303,6 +311,8 @@ BOOST_PYTHON_MODULE(libcloudphxx)
       .def_readwrite("z1", &lgr::opts_init_t<real_t>::z1)
       .def_readwrite("dev_id", &lgr::opts_init_t<real_t>::dev_id)
       .def_readwrite("dev_count", &lgr::opts_init_t<real_t>::dev_count)
+      .def_readwrite("rebalance_freq", &lgr::opts_init_t<real_t>::rebalance_freq)
+      .def_readwrite("outbuf_queue_len", &lgr::opts_init_t<real_t>::outbuf_queue_len)
       .def_readwrite("src_x0", &lgr::opts_init_t<real_t>::src_x0)
       .def_readwrite("src_x1", &lgr::opts_init_t<real_t>::src_x1)
       .def_readwrite("src_y0", &lgr::opts_init_t<real_t>::src_y0)
@@ -342,6 +352,9 @@ BOOST_PYTHON_MODULE(libcloudphxx)
       .def_readwrite("src_type", &lgr::opts_init_t<real_t>::src_type)
       .def_readwrite("RH_formula", &lgr::opts_init_t<real_t>::RH_formula)
       .def_readwrite("chem_rho", &lgr::opts_init_t<real_t>::chem_rho)
+      .def_readwrite("chem_solver", &lgr::opts_init_t<real_t>::chem_solver)
+      .def_readwrite("chem_ros2_eps", &lgr::opts_init_t<real_t>::chem_ros2_eps)
+      .def_readwrite("chem_dissoc_warm_start", &lgr::opts_init_t<real_t>::chem_dissoc_warm_start)
       .def_readwrite("RH_max", &lgr::opts_init_t<real_t>::RH_max)
       .def_readwrite("rng_seed", &lgr::opts_init_t<real_t>::rng_seed)
       .def_readwrite("rng_seed_init", &lgr::opts_init_t<real_t>::rng_seed_init)
@@ -372,6 +385,24 @@ BOOST_PYTHON_MODULE(libcloudphxx)
         bp::arg("Cz")  = BP_ARR_FROM_BP_OBJ,
         bp::arg("ambient_chem") = bp::dict()
       ))
+      .def("init_from_attrs", &lgrngn::init_from_attrs<real_t>, (
+        bp::arg("th")  = BP_ARR_FROM_BP_OBJ,
+        bp::arg("rv")  = BP_ARR_FROM_BP_OBJ,
+        bp::arg("rhod")= BP_ARR_FROM_BP_OBJ,
+        bp::arg("p")   = BP_ARR_FROM_BP_OBJ,
+        bp::arg("Cx")  = BP_ARR_FROM_BP_OBJ,
+        bp::arg("Cy")  = BP_ARR_FROM_BP_OBJ,
+        bp::arg("Cz")  = BP_ARR_FROM_BP_OBJ,
+        bp::arg("ambient_chem") = bp::dict(),
+        bp::arg("n")     = BP_ARR_FROM_BP_OBJ,
+        bp::arg("rd3")   = BP_ARR_FROM_BP_OBJ,
+        bp::arg("kappa") = BP_ARR_FROM_BP_OBJ,
+        bp::arg("x")     = BP_ARR_FROM_BP_OBJ,
+        bp::arg("y")     = BP_ARR_FROM_BP_OBJ,
+        bp::arg("z")     = BP_ARR_FROM_BP_OBJ,
+        bp::arg("rw2")   = BP_ARR_FROM_BP_OBJ,
+        bp::arg("rd2_insol") = BP_ARR_FROM_BP_OBJ
+      ))
       .def("step_sync",    &lgrngn::step_sync<real_t>, (
         bp::arg("th")  = BP_ARR_FROM_BP_OBJ,
         bp::arg("rv")  = BP_ARR_FROM_BP_OBJ,
@@ -397,38 +428,50 @@ BOOST_PYTHON_MODULE(libcloudphxx)
         bp::arg("rv")  = BP_ARR_FROM_BP_OBJ,
         bp::arg("ambient_chem") = bp::dict()
       ))
-      .def("step_async",   &lgr::particles_proto_t<real_t>::step_async)
-      .def("diag_sd_conc", &lgr::particles_proto_t<real_t>::diag_sd_conc)
-      .def("diag_all",     &lgr::particles_proto_t<real_t>::diag_all)
-      .def("diag_rw_ge_rc",&lgr::particles_proto_t<real_t>::diag_rw_ge_rc)
-      .def("diag_RH_ge_Sc",&lgr::particles_proto_t<real_t>::diag_RH_ge_Sc)
-      .def("diag_RH",&lgr::particles_proto_t<real_t>::diag_RH)
-      .def("diag_pressure",&lgr::particles_proto_t<real_t>::diag_pressure)
-      .def("diag_temperature",&lgr::particles_proto_t<real_t>::diag_temperature)
-      .def("diag_vel_div",&lgr::particles_proto_t<real_t>::diag_vel_div)
-      .def("diag_dry_rng", &lgr::particles_proto_t<real_t>::diag_dry_rng) 
-      .def("diag_wet_rng", &lgr::particles_proto_t<real_t>::diag_wet_rng) 
-      .def("diag_kappa_rng", &lgr::particles_proto_t<real_t>::diag_kappa_rng)
-      .def("diag_dry_rng_cons", &lgr::particles_proto_t<real_t>::diag_dry_rng_cons) 
-      .def("diag_wet_rng_cons", &lgr::particles_proto_t<real_t>::diag_wet_rng_cons) 
-      .def("diag_kappa_rng_cons", &lgr::particles_proto_t<real_t>::diag_kappa_rng_cons)
-      .def("diag_dry_mom", &lgr::particles_proto_t<real_t>::diag_dry_mom)
-      .def("diag_wet_mom", &lgr::particles_proto_t<real_t>::diag_wet_mom)
-      .def("diag_kappa_mom",    &lgr::particles_proto_t<real_t>::diag_kappa_mom)
-      .def("diag_incloud_time_mom",    &lgr::particles_proto_t<real_t>::diag_incloud_time_mom)
-      .def("diag_wet_mass_dens", &lgr::particles_proto_t<real_t>::diag_wet_mass_dens)
-      .def("diag_chem",    &lgr::particles_proto_t<real_t>::diag_chem)
-      .def("diag_precip_rate",    &lgr::particles_proto_t<real_t>::diag_precip_rate)
+      .def("step_async",   nogil(&lgr::particles_proto_t<real_t>::step_async))
+      .def("diag_sd_conc", nogil(&lgr::particles_proto_t<real_t>::diag_sd_conc))
+      .def("diag_all",     nogil(&lgr::particles_proto_t<real_t>::diag_all))
+      .def("diag_rw_ge_rc",nogil(&lgr::particles_proto_t<real_t>::diag_rw_ge_rc))
+      .def("diag_RH_ge_Sc",nogil(&lgr::particles_proto_t<real_t>::diag_RH_ge_Sc))
+      .def("diag_RH",nogil(&lgr::particles_proto_t<real_t>::diag_RH))
+      .def("diag_pressure",nogil(&lgr::particles_proto_t<real_t>::diag_pressure))
+      .def("diag_temperature",nogil(&lgr::particles_proto_t<real_t>::diag_temperature))
+      .def("diag_vel_div",nogil(&lgr::particles_proto_t<real_t>::diag_vel_div))
+      .def("diag_dry_rng", nogil(&lgr::particles_proto_t<real_t>::diag_dry_rng)) 
+      .def("diag_wet_rng", nogil(&lgr::particles_proto_t<real_t>::diag_wet_rng)) 
+      .def("diag_kappa_rng", nogil(&lgr::particles_proto_t<real_t>::diag_kappa_rng))
+      .def("diag_dry_rng_cons", nogil(&lgr::particles_proto_t<real_t>::diag_dry_rng_cons)) 
+      .def("diag_wet_rng_cons", nogil(&lgr::particles_proto_t<real_t>::diag_wet_rng_cons)) 
+      .def("diag_kappa_rng_cons", nogil(&lgr::particles_proto_t<real_t>::diag_kappa_rng_cons))
+      .def("diag_dry_mom", nogil(&lgr::particles_proto_t<real_t>::diag_dry_mom))
+      .def("diag_wet_mom", nogil(&lgr::particles_proto_t<real_t>::diag_wet_mom))
+      .def("diag_dry_spectrum", &lgrngn::diag_dry_spectrum<real_t>)
+      .def("diag_wet_spectrum", &lgrngn::diag_wet_spectrum<real_t>)
+      .def("diag_kappa_mom",    nogil(&lgr::particles_proto_t<real_t>::diag_kappa_mom))
+      .def("diag_incloud_time_mom",    nogil(&lgr::particles_proto_t<real_t>::diag_incloud_time_mom))
+      .def("diag_wet_mass_dens", nogil(&lgr::particles_proto_t<real_t>::diag_wet_mass_dens))
+      .def("diag_chem",    nogil(&lgr::particles_proto_t<real_t>::diag_chem))
+      .def("diag_chem_dissoc_iter", nogil(&lgr::particles_proto_t<real_t>::diag_chem_dissoc_iter))
+      .def("diag_precip_rate",    nogil(&lgr::particles_proto_t<real_t>::diag_precip_rate))
       .def("diag_puddle",    &lgrngn::diag_puddle<real_t>)
-      .def("diag_ice",    &lgr::particles_proto_t<real_t>::diag_ice)
-      .def("diag_water",    &lgr::particles_proto_t<real_t>::diag_water)
-      .def("diag_ice_cons",    &lgr::particles_proto_t<real_t>::diag_ice_cons)
-      .def("diag_water_cons",    &lgr::particles_proto_t<real_t>::diag_water_cons)
-      .def("diag_ice_a_mom",    &lgr::particles_proto_t<real_t>::diag_ice_a_mom)
-      .def("diag_ice_c_mom",    &lgr::particles_proto_t<real_t>::diag_ice_c_mom)
-      .def("diag_ice_mix_ratio",    &lgr::particles_proto_t<real_t>::diag_ice_mix_ratio)
+      .def("diag_ice",    nogil(&lgr::particles_proto_t<real_t>::diag_ice))
+      .def("diag_water",    nogil(&lgr::particles_proto_t<real_t>::diag_water))
+      .def("diag_ice_cons",    nogil(&lgr::particles_proto_t<real_t>::diag_ice_cons))
+      .def("diag_water_cons",    nogil(&lgr::particles_proto_t<real_t>::diag_water_cons))
+      .def("diag_ice_a_mom",    nogil(&lgr::particles_proto_t<real_t>::diag_ice_a_mom))
+      .def("diag_ice_c_mom",    nogil(&lgr::particles_proto_t<real_t>::diag_ice_c_mom))
+      .def("diag_ice_mix_ratio",    nogil(&lgr::particles_proto_t<real_t>::diag_ice_mix_ratio))
       .def("outbuf",       &lgrngn::outbuf<real_t>)
-      .def("get_attr",    &lgr::particles_proto_t<real_t>::get_attr)
+      .def("outbuf_enqueue", nogil(&lgr::particles_proto_t<real_t>::outbuf_enqueue))
+      .def("outbuf_front",   &lgrngn::outbuf_front<real_t>)
+      .def("outbuf_pop",     &lgr::particles_proto_t<real_t>::outbuf_pop)
+      .def("outbuf_profile", nogil(&lgr::particles_proto_t<real_t>::outbuf_profile))
+      .def("outbuf_column",  nogil(&lgr::particles_proto_t<real_t>::outbuf_column))
+      .def("outbuf_domain",  nogil(&lgr::particles_proto_t<real_t>::outbuf_domain))
+      .def("get_attr",    &lgrngn::get_attr<real_t>)
+      .def("get_attrs",   &lgrngn::get_attrs<real_t>)
+      .def("save_state",  nogil(&lgr::particles_proto_t<real_t>::save_state))
+      .def("load_state",  nogil(&lgr::particles_proto_t<real_t>::load_state))
     ;
     // functions
     bp::def("factory", lgrngn::factory<real_t>, bp::return_value_policy<bp::manage_new_object>());
@@ -14,6 +14,7 @@
 
 #define BOOST_PYTHON_MAX_ARITY 20 // max number of arguments in a function
 #include <boost/python.hpp>
+#include <boost/mpl/vector.hpp>
 #ifdef BPNUMPY
 #include <boost/python/numpy.hpp>
 #endif
@@ -34,6 +35,52 @@ namespace libcloudphxx
     using bp_array = bp::numpy::ndarray;
 #endif
 
+    // releases the GIL for the lifetime of the object,
+    // to be used around C++ calls that do not touch Python objects
+    class gil_release
+    {
+      PyThreadState *state;
+
+      public:
+
+      gil_release() : state(PyEval_SaveThread()) {}
+      ~gil_release() { PyEval_RestoreThread(state); }
+
+      gil_release(const gil_release &) = delete;
+      gil_release &operator=(const gil_release &) = delete;
+    };
+
+    // (re)acquires the GIL for the lifetime of the object, e.g. in callbacks into Python
+    class gil_acquire
+    {
+      PyGILState_STATE state;
+
+      public:
+
+      gil_acquire() : state(PyGILState_Ensure()) {}
+      ~gil_acquire() { PyGILState_Release(state); }
+
+      gil_acquire(const gil_acquire &) = delete;
+      gil_acquire &operator=(const gil_acquire &) = delete;
+    };
+
+    // Python-callable wrapper of a member function that releases the GIL for the duration of the call;
+    // here and in the gil_release scopes in lgrngn.hpp the C++ code does not touch Python objects,
+    // except for callbacks into Python (the size distributions, cf. lgrngn::detail::pyunary) that take gil_acquire
+    template <class ret_t, class cls_t, class... args_t>
+    bp::object nogil(ret_t (cls_t::*fn)(args_t...))
+    {
+      return bp::make_function(
+        [fn](cls_t *obj, args_t... args) -> ret_t
+        {
+          gil_release gil;
+          return (obj->*fn)(args...);
+        },
+        bp::default_call_policies(),
+        boost::mpl::vector<ret_t, cls_t*, args_t...>()
+      );
+    }
+
     void sanity_checks(const bp_array &arg)
     {
       // assuring double precision
@@ -45,6 +92,41 @@ namespace libcloudphxx
 	throw std::runtime_error("contiguous memory layout required");
     }
 
+    // NumPy array of the given shape taking over the data of vec (without a copy if Boost.Python NumPy is available)
+    template <typename real_t>
+    bp::object vec2np(std::vector<real_t> &&vec, const std::vector<Py_intptr_t> &shape)
+    {
+#if defined BPNUMPY
+      std::vector<real_t> *data = new std::vector<real_t>(std::move(vec));
+      // the capsule frees the vector when the array (its base) is garbage collected
+      PyObject *capsule = PyCapsule_New(data, NULL, [](PyObject *cap) {
+        delete static_cast<std::vector<real_t>*>(PyCapsule_GetPointer(cap, NULL));
+      });
+      if (capsule == NULL)
+      {
+        delete data;
+        bp::throw_error_already_set();
+      }
+      bp::object owner{bp::handle<>(capsule)};
+
+      std::vector<Py_intptr_t> strides(shape.size(), sizeof(real_t));
+      for (int d = int(shape.size()) - 2; d >= 0; --d) strides[d] = strides[d+1] * shape[d+1];
+      return bp::numpy::from_data(
+        data->data(),
+        bp::numpy::dtype::get_builtin<real_t>(),
+        shape, strides, owner
+      );
+#else
+      // single memcpy through the buffer protocol
+      bp::object view(bp::handle<>(PyMemoryView_FromMemory(
+        reinterpret_cast<char *>(vec.data()), sizeof(real_t) * vec.size(), PyBUF_READ
+      )));
+      bp::list shp;
+      for (auto &s : shape) shp.append(s);
+      return bp::import("numpy").attr("frombuffer")(view).attr("reshape")(bp::tuple(shp)).attr("copy")();
+#endif
+    }
+
     template <class arr_t>
     arr_t np2bz(const bp_array &arg)
     {
@@ -63,6 +145,47 @@ namespace libcloudphxx
       );
     }
 
+    // 1D, 2D or 3D arrays treated as a set of columns along the last (vertical) axis
+    template <class real_t>
+    struct columns_t
+    {
+      std::size_t n_col, n_z;
+      std::vector<Py_intptr_t> shape; // shape of the horizontal axes (empty for a single 1D column)
+
+      columns_t(const bp_array &arg)
+      {
+        sanity_checks(arg);
+        const int n_dims = bp::len(arg.attr("shape"));
+        if (n_dims < 1 || n_dims > 3)
+          throw std::runtime_error("1D, 2D or 3D arrays expected, with the vertical dimension last");
+        n_z = bp::extract<std::size_t>(arg.attr("shape")[n_dims - 1]);
+        n_col = 1;
+        for (int d = 0; d < n_dims - 1; ++d)
+        {
+          shape.push_back(bp::extract<Py_intptr_t>(arg.attr("shape")[d]));
+          n_col *= shape.back();
+        }
+      }
+
+      // pointer to the data of an array of the same size
+      real_t *ptr(const bp_array &arg) const
+      {
+        sanity_checks(arg);
+        if (std::size_t(bp::extract<std::size_t>(arg.attr("size"))) != n_col * n_z)
+          throw std::runtime_error("all arrays have to be of the same size");
+        return reinterpret_cast<real_t*>(
+          (py_ptr_t)bp::extract<py_ptr_t>(arg.attr("ctypes").attr("data"))
+        );
+      }
+
+      // per-column values returned as a float for a single column and as an array otherwise
+      bp::object out(std::vector<real_t> &&vec) const
+      {
+        if (shape.empty()) return bp::object(vec[0]);
+        return vec2np(std::move(vec), shape);
+      }
+    };
+
     // This is intended to recognise arrays containing the None object
     // which are used to mark skipped function parameters
     bool not_numeric(
@@ -74,7 +197,7 @@ namespace libcloudphxx
     template <class real_t>
     lgrngn::arrinfo_t<real_t> np2ai(
       const bp_array &arg,
-      const std::array<int, 3> &sz
+      const std::array<int, 4> &sz // nx, ny, nz, n_ens
     ) {
       // handling empty-array case (e.g. unspecified method argument)
       if (not_numeric(arg))
@@ -133,8 +256,8 @@ namespace libcloudphxx
         case 0: // parcel set-up
           if (bp::len(arg.attr("shape")) != 1)
             throw std::runtime_error("incompatible array size: 0D parcel set-up accepts only 1D arrays");
-          if (bp::extract<int>(arg.attr("shape")[0]) != 1) 
-	    throw std::runtime_error("incompatible array size: 0D parcel set-up accepts single-element arrays only");
+          if (bp::extract<int>(arg.attr("shape")[0]) != std::max(1, sz[3])) 
+	    throw std::runtime_error("incompatible array size: 0D parcel set-up accepts single-element arrays only (n_ens-element arrays for an ensemble of parcels)");
           break;
         default: 
           assert(false);
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "extincl.hpp"
+#include "../common/detail/raw_array.hpp"
 
 namespace libcloudphxx
 {
@@ -87,26 +88,20 @@ namespace libcloudphxx
       };
     }
 
-    template <typename real_t, class cont_t>
-    void adj_cellwise_nwtrph(
-      const opts_t<real_t> &opts,
-      const cont_t &rhod_cont,
-      const cont_t &p_cont,
-      cont_t &th_cont,
-      cont_t &rv_cont,
-      cont_t &rc_cont,
-      const real_t &dt
-    )
+    namespace detail
     {
-      using namespace common;
-      if (!opts.cond) return; // ignoring values of opts.cevp
-
-      for (auto tup : zip(rhod_cont, p_cont, th_cont, rv_cont, rc_cont))
+      // Newton-Raphson saturation adjustment in a single cell
+      template <typename real_t>
+      inline void adj_nwtrph_cell(
+        const opts_t<real_t> &opts,
+        const real_t &rhod_in,
+        const real_t &p_in,
+        real_t &th,
+        real_t &rv,
+        real_t &rc
+      )
       {
-        real_t
-          &th = std::get<2>(tup),
-          &rv = std::get<3>(tup),
-          &rc = std::get<4>(tup);
+        using namespace common;
 
         // double-checking....
         //assert(th >= 273.15); // TODO: that's theta, not T!
@@ -123,19 +118,19 @@ namespace libcloudphxx
         quantity<si::pressure, real_t>      p;
         quantity<si::dimensionless, real_t> exner;
 
-        if(!opts.const_p && opts.th_dry)
+        // (opts.const_p != opts.th_dry checked by the caller)
+        if(opts.th_dry)
         {
-          rhod = std::get<0>(tup) * si::kilograms / si::cubic_metres;
+          rhod = rhod_in * si::kilograms / si::cubic_metres;
           T = common::theta_dry::T<real_t>(th_tmp, rhod);
           p = common::theta_dry::p<real_t>(rhod, rv, T);
         }
-        else if(opts.const_p && !opts.th_dry)
+        else
         {
-          p = std::get<1>(tup) * si::pascals;
+          p = p_in * si::pascals;
           exner = common::theta_std::exner(p);
           T = th_tmp * exner;
         }
-        else throw std::runtime_error("adj_cellwise: one (and only one) of opts.const_p and opts.th_dry must be true");
 
         // constant l_v used in theta update
         auto L0 = const_cp::l_v(T);
@@ -143,7 +138,7 @@ namespace libcloudphxx
         T_tmp = T;
         for (int iter = 0; iter < opts.nwtrph_iters; ++iter)
         {
-          // TODO: use the approximate Tetens formulas for p_vs and r_vs from tetens.hpp?
+          // (see adj_nwtrph_tetens_block() for a variant with the approximate Tetens formula)
           quantity<si::pressure, real_t> p_vs = const_cp::p_vs(T_tmp);
 
           // tricky, constant L0 comes from theta = theta + L0 / (c_pd * exner_p) * drc
@@ -162,7 +157,7 @@ namespace libcloudphxx
             T_tmp = common::theta_dry::T<real_t>(th_tmp, rhod);
           else
             T_tmp = th_tmp * exner;
-            
+
           if(!opts.const_p)
             p = common::theta_dry::p<real_t>(rhod, rv_tmp, T_tmp);
         }
@@ -179,6 +174,198 @@ namespace libcloudphxx
         assert(rc >= 0);
         assert(rv >= 0);
       }
+
+      // number of cells adjusted in lock-step by the Tetens variant below
+      const int nwtrph_block = 32;
+
+      // Tetens formula for the saturation vapour pressure over water [Pa], T in kelvins
+      // (written in plain arithmetic so that the loops below vectorise)
+      template <typename real_t>
+      inline real_t p_vs_tetens(const real_t &T)
+      {
+        return real_t(610.78) * std::exp(real_t(17.27) * (T - real_t(273.15)) / (T - real_t(35.85)));
+      }
+
+      // Newton-Raphson saturation adjustment as in adj_nwtrph_cell() but with p_vs from the Tetens formula,
+      // done in lock-step for n <= nwtrph_block cells and stopped when the increments are below opts.nwtrph_eps
+      template <typename real_t>
+      void adj_nwtrph_tetens_block(
+        const opts_t<real_t> &opts,
+        const int n,
+        const real_t *rhod,
+        const real_t *p_in,
+        real_t *th,
+        real_t *rv,
+        real_t *rc
+      )
+      {
+        using namespace common;
+
+        // constants in SI units
+        const real_t
+          c_pd = moist_air::c_pd<real_t>() * si::kilograms * si::kelvins / si::joules,
+          R_d = moist_air::R_d<real_t>() * si::kilograms * si::kelvins / si::joules,
+          R_v = moist_air::R_v<real_t>() * si::kilograms * si::kelvins / si::joules,
+          eps = moist_air::eps<real_t>(),
+          l_tri = const_cp::l_tri<real_t>() * si::kilograms / si::joules,
+          dl_dT = (moist_air::c_pv<real_t>() - moist_air::c_pw<real_t>()) * si::kilograms * si::kelvins / si::joules,
+          T_tri = const_cp::T_tri<real_t>() / si::kelvins,
+          p_1000 = theta_std::p_1000<real_t>() / si::pascals,
+          T_exp = c_pd / (c_pd - R_d); // T = (th * exn)^T_exp if th_dry, T = th * exn otherwise
+
+        real_t exn[nwtrph_block], p[nwtrph_block], T[nwtrph_block], L0[nwtrph_block], act[nwtrph_block],
+               drc[nwtrph_block], rv_tmp[nwtrph_block], th_tmp[nwtrph_block], T_tmp[nwtrph_block];
+
+        int n_act = 0;
+#if defined(_OPENMP)
+#  pragma omp simd reduction(+:n_act)
+#endif
+        for (int i = 0; i < n; ++i)
+        {
+          if(opts.th_dry)
+          {
+            exn[i] = std::pow(rhod[i] * R_d / p_1000, R_d / c_pd);
+            T[i] = std::pow(th[i] * exn[i], T_exp);
+            p[i] = rhod[i] * (R_d + rv[i] * R_v) * T[i];
+          }
+          else
+          {
+            p[i] = p_in[i];
+            exn[i] = std::pow(p[i] / p_1000, R_d / c_pd);
+            T[i] = th[i] * exn[i];
+          }
+          // constant l_v used in theta update
+          L0[i] = l_tri + dl_dT * (T[i] - T_tri);
+
+          // nothing to adjust in subsaturated cells without cloud water
+          act[i] = (rc[i] > 0 || rv[i] > eps / (p[i] / p_vs_tetens(T[i]) - 1)) ? 1 : 0;
+          n_act += act[i];
+
+          drc[i] = 0;
+          rv_tmp[i] = rv[i];
+          th_tmp[i] = th[i];
+          T_tmp[i] = T[i];
+        }
+        if (n_act == 0) return;
+
+        for (int iter = 0; iter < opts.nwtrph_iters; ++iter)
+        {
+          real_t max_inc = 0;
+#if defined(_OPENMP)
+#  pragma omp simd reduction(max:max_inc)
+#endif
+          for (int i = 0; i < n; ++i)
+          {
+            const real_t
+              p_vs = p_vs_tetens(T_tmp[i]),
+              L = l_tri + dl_dT * (T_tmp[i] - T_tri),
+              coeff = L * L0[i] / (c_pd * R_v) / (T_tmp[i] * T_tmp[i]) / (1 - p_vs / p[i]),
+              r_vs = eps / (p[i] / p_vs - 1),
+              inc = act[i] * (rv_tmp[i] - r_vs) / (1 + coeff * r_vs);
+
+            drc[i] += inc;
+            rv_tmp[i] = rv[i] - drc[i];
+            th_tmp[i] = th[i] + th_tmp[i] / T_tmp[i] * L0[i] / c_pd * drc[i];
+
+            if(opts.th_dry)
+            {
+              T_tmp[i] = std::pow(th_tmp[i] * exn[i], T_exp);
+              p[i] = rhod[i] * (R_d + rv_tmp[i] * R_v) * T_tmp[i];
+            }
+            else
+              T_tmp[i] = th_tmp[i] * exn[i];
+
+            max_inc = std::max(max_inc, std::abs(inc));
+          }
+          if (max_inc < opts.nwtrph_eps) break;
+        }
+
+#if defined(_OPENMP)
+#  pragma omp simd
+#endif
+        for (int i = 0; i < n; ++i)
+        {
+          // limiting
+          const real_t drc_lim = std::min(rv[i], std::max(-rc[i], drc[i]));
+
+          rv[i] -= drc_lim;
+          rc[i] += drc_lim;
+          th[i] += th[i] / T[i] * L0[i] / c_pd * drc_lim;
+        }
+      }
+    };
+
+    // batched version operating on n cells stored in contiguous arrays (structure of arrays);
+    // rhod is used only if opts.th_dry, p only if opts.const_p (may be NULL otherwise)
+    template <typename real_t>
+    void adj_cellwise_nwtrph_batch(
+      const opts_t<real_t> &opts,
+      const std::size_t n,
+      const real_t *rhod,
+      const real_t *p,
+      real_t *th,
+      real_t *rv,
+      real_t *rc,
+      const real_t &dt
+    )
+    {
+      if (!opts.cond) return; // ignoring values of opts.cevp
+
+      if (opts.const_p == opts.th_dry)
+        throw std::runtime_error("adj_cellwise: one (and only one) of opts.const_p and opts.th_dry must be true");
+
+      if (opts.nwtrph_tetens)
+      {
+        const std::ptrdiff_t n_blk = (n + detail::nwtrph_block - 1) / detail::nwtrph_block;
+#if defined(_OPENMP)
+#  pragma omp parallel for
+#endif
+        for (std::ptrdiff_t b = 0; b < n_blk; ++b)
+        {
+          const std::size_t i0 = b * detail::nwtrph_block;
+          detail::adj_nwtrph_tetens_block(opts, int(std::min<std::size_t>(detail::nwtrph_block, n - i0)),
+            opts.th_dry ? rhod + i0 : rhod,
+            opts.const_p ? p + i0 : p,
+            th + i0, rv + i0, rc + i0
+          );
+        }
+        return;
+      }
+
+#if defined(_OPENMP)
+#  pragma omp parallel for
+#endif
+      for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(n); ++i)
+        detail::adj_nwtrph_cell(opts,
+          opts.th_dry ? rhod[i] : real_t(0),
+          opts.const_p ? p[i] : real_t(0),
+          th[i], rv[i], rc[i]
+        );
+    }
+
+    // adaptor for arbitrary containers (e.g. Blitz++ arrays), copied to temporary arrays if their storage is not contiguous
+    template <typename real_t, class cont_t>
+    void adj_cellwise_nwtrph(
+      const opts_t<real_t> &opts,
+      const cont_t &rhod_cont,
+      const cont_t &p_cont,
+      cont_t &th_cont,
+      cont_t &rv_cont,
+      cont_t &rc_cont,
+      const real_t &dt
+    )
+    {
+      using namespace common::detail;
+      if (!opts.cond) return; // ignoring values of opts.cevp
+
+      const std::size_t n = th_cont.size();
+      raw_inout_t<real_t, cont_t> th(th_cont, n), rv(rv_cont, n), rc(rc_cont, n);
+      adj_cellwise_nwtrph_batch<real_t>(opts, n,
+        raw_in_t<real_t, cont_t>(rhod_cont, opts.th_dry ? n : 0).data(),
+        raw_in_t<real_t, cont_t>(p_cont, opts.const_p ? n : 0).data(),
+        th.data(), rv.data(), rc.data(),
+        dt
+      );
     }
 
 // Below are saturation adjustment functions that use RK4 integration (from boost.odeint)
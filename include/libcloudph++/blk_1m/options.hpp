@@ -38,6 +38,8 @@ namespace libcloudphxx
 
       bool adj_nwtrph = true; // if true, use simpler Newton-Raphson iteration in saturation adjustment; otherwise use RK4 from boost.odeint
       int nwtrph_iters = 3; // number of iterations in Newton-Raphson saturation adjustment
+      bool nwtrph_tetens = false; // if true, Newton-Raphson saturation adjustment uses the Tetens formula for p_vs and iterates over blocks of cells in lock-step (vectorisable)
+      real_t nwtrph_eps = 1e-10; // with nwtrph_tetens, iterations stop once the change in cloud water is below nwtrph_eps in all cells of a block
 
       // NOTE: only tested combinations are: th_dry == true && const_p == false; th_dry == false && const_p == true
       // NOTE:  th_dry == true && const_p == false doesn't work very well with Newton-Raphson, e.g. sat_adj_blk_1m test (TODO: probably Newton-Raphson needs to be fixed)
@@ -9,29 +9,27 @@
 #pragma once
 
 #include "extincl.hpp"
+#include "../common/detail/raw_array.hpp"
 
 namespace libcloudphxx
 {
   namespace blk_1m
   {
-    template <typename real_t, class cont_t>
-    void rhs_cellwise_hlpr(
-      const opts_t<real_t> &opts,
-      cont_t &dot_rc_cont,
-      cont_t &dot_rr_cont,
-      const cont_t &rc_cont,
-      const cont_t &rr_cont
-    )
+    namespace detail
     {
-      for (auto tup : zip(dot_rc_cont, dot_rr_cont, rc_cont, rr_cont))
+      // per-cell kernels of the batched routines below (inlined into OpenMP-parallel loops over raw arrays)
+
+      // autoconversion and collection
+      template <typename real_t>
+      inline void rhs_warm_cell(
+        const opts_t<real_t> &opts,
+        real_t &dot_rc,
+        real_t &dot_rr,
+        const real_t &rc,
+        const real_t &rr
+      )
       {
-        real_t
-          rc_to_rr = 0,
-          &dot_rc = std::get<0>(tup),
-          &dot_rr = std::get<1>(tup);
-        const real_t
-          &rc     = std::get<2>(tup),
-          &rr     = std::get<3>(tup);
+        real_t rc_to_rr = 0;
 
         // autoconversion
         if (opts.conv)
@@ -59,79 +57,59 @@ namespace libcloudphxx
         dot_rr += rc_to_rr;
         dot_rc -= rc_to_rr;
       }
-    }
-
-    template <typename real_t, class cont_t>
-    void rhs_cellwise(
-      const opts_t<real_t> &opts,
-      cont_t &dot_rc_cont,
-      cont_t &dot_rr_cont,
-      const cont_t &rc_cont,
-      const cont_t &rr_cont
-    )
-    {
-      assert(!opts.adj_nwtrph && "libcloudph++: rhs_cellwise without rain evap requires RK4 in adj_cellwise");
-      rhs_cellwise_hlpr<real_t, cont_t>(opts, dot_rc_cont, dot_rr_cont,  rc_cont, rr_cont);
-    }
 
-    template <typename real_t, class cont_t>
-    void rhs_cellwise_revap(
-      const opts_t<real_t> &opts,
-      cont_t &dot_th_cont,
-      cont_t &dot_rv_cont,
-      cont_t &dot_rc_cont,
-      cont_t &dot_rr_cont,
-      const cont_t &rhod_cont,
-      const cont_t &p_cont,
-      const cont_t &th_cont,
-      const cont_t &rv_cont,
-      const cont_t &rc_cont,
-      const cont_t &rr_cont,
-      const real_t &dt
-    )
-    {
-      assert(opts.adj_nwtrph && "libcloudph++: rhs_cellwise with rain evap requires Newton-Raphson in adj_cellwise");
-      rhs_cellwise_hlpr<real_t, cont_t>(opts, dot_rc_cont, dot_rr_cont,  rc_cont, rr_cont);
+      // temperature and pressure (th_dry and const_p options already checked)
+      template <typename real_t>
+      inline void T_p_cell(
+        const opts_t<real_t> &opts,
+        const quantity<si::mass_density, real_t> &rhod,
+        const real_t &p_in,
+        const quantity<si::temperature, real_t> &th,
+        const real_t &rv,
+        quantity<si::temperature, real_t> &T,
+        quantity<si::pressure, real_t> &p
+      )
+      {
+        if(opts.th_dry)
+        {
+          T = common::theta_dry::T<real_t>(th, rhod);
+          p = common::theta_dry::p<real_t>(rhod, rv, T);
+        }
+        else
+        {
+          p = p_in * si::pascals;
+          T = th * common::theta_std::exner(p);
+        }
+      }
 
-      // rain evaporation treated as a force in Newthon-Raphson saturation adjustment
-      for (auto tup : zip(dot_th_cont, dot_rv_cont, dot_rr_cont, rhod_cont, p_cont, th_cont, rv_cont, rr_cont))
+      // rain evaporation
+      template <typename real_t>
+      inline void rhs_revap_cell(
+        const opts_t<real_t> &opts,
+        real_t &dot_th,
+        real_t &dot_rv,
+        real_t &dot_rr,
+        const real_t &rhod_in,
+        const real_t &p_in,
+        const real_t &th_in,
+        const real_t &rv,
+        const real_t &rr,
+        const real_t &dt
+      )
       {
         using namespace common;
 
-        real_t
-          rr_to_rv = 0,
-          &dot_th = std::get<0>(tup),
-          &dot_rv = std::get<1>(tup),
-          &dot_rr = std::get<2>(tup);
+        real_t rr_to_rv = 0;
 
         const quantity<si::mass_density, real_t>
-          rhod = std::get<3>(tup) * si::kilograms / si::cubic_metres;
-
-        // const quantity<si::pressure, real_t>
-        //   p   = std::get<4>(tup) * si::pascals;
+          rhod = rhod_in * si::kilograms / si::cubic_metres;
 
         const quantity<si::temperature, real_t>
-          th = std::get<5>(tup) * si::kelvins;
-
-        const real_t
-          &rv = std::get<6>(tup),
-          &rr = std::get<7>(tup);
+          th = th_in * si::kelvins;
 
-        // quantity<si::temperature, real_t> T = th * theta_std::exner(p);
         quantity<si::temperature, real_t> T;
         quantity<si::pressure, real_t>    p;
-
-        if(!opts.const_p && opts.th_dry)
-        {
-          T = common::theta_dry::T<real_t>(th, rhod);
-          p = common::theta_dry::p<real_t>(rhod, rv, T);
-        }
-        else if(opts.const_p && !opts.th_dry)
-        {
-          p = std::get<4>(tup) * si::pascals;
-          T = th * common::theta_std::exner(p);
-        }
-        else throw std::runtime_error("rhs_cellwise: one (and only one) of opts.const_p and opts.th_dry must be true");
+        T_p_cell(opts, rhod, p_in, th, rv, T, p);
 
         real_t r_vs = const_cp::r_vs(T, p);
 
@@ -153,37 +131,27 @@ namespace libcloudphxx
         //dot_th -= const_cp::l_v(T) / (moist_air::c_pd<real_t>() * theta_std::exner(p)) * rr_to_rv / si::kelvins;
         dot_th += common::theta_dry::d_th_d_rv<real_t>(T, th) * rr_to_rv / si::kelvins;
       }
-    }
 
-    template <typename real_t, class cont_t>
-    void rhs_cellwise_ice(
-      const opts_t<real_t> &opts,
-      cont_t &dot_th_cont,
-      cont_t &dot_rv_cont,
-      cont_t &dot_rc_cont,
-      cont_t &dot_rr_cont,
-      cont_t &dot_ria_cont,
-      cont_t &dot_rib_cont,
-      const cont_t &rhod_cont,
-      const cont_t &p_cont,
-      const cont_t &th_cont,
-      const cont_t &rv_cont,
-      const cont_t &rc_cont,
-      const cont_t &rr_cont,
-      const cont_t &ria_cont,
-      const cont_t &rib_cont,
-      const real_t &dt
-    )
-    {
-      // autoconversion, collection and rain evaporation:
-      if(opts.adj_nwtrph)
-        rhs_cellwise_revap<real_t, cont_t>(opts, dot_th_cont, dot_rv_cont, dot_rc_cont, dot_rr_cont, rhod_cont, p_cont,
-                                     th_cont, rv_cont, rc_cont, rr_cont, dt);
-      else
-        rhs_cellwise<real_t, cont_t>(opts, dot_rc_cont, dot_rr_cont,  rc_cont, rr_cont);
-
-      for (auto tup : zip(dot_th_cont, dot_rv_cont, dot_rc_cont, dot_rr_cont, dot_ria_cont, dot_rib_cont, rhod_cont,
-                          p_cont, th_cont, rv_cont, rc_cont, rr_cont, ria_cont, rib_cont))
+      // ice nucleation, growth and melting
+      template <typename real_t>
+      inline void rhs_ice_cell(
+        const opts_t<real_t> &opts,
+        real_t &dot_th,
+        real_t &dot_rv,
+        real_t &dot_rc,
+        real_t &dot_rr,
+        real_t &dot_ria,
+        real_t &dot_rib,
+        const real_t &rhod_in,
+        const real_t &p_in,
+        const real_t &th_in,
+        const real_t &rv,
+        const real_t &rc,
+        const real_t &rr,
+        const real_t &ria,
+        const real_t &rib,
+        const real_t &dt
+      )
       {
         using namespace common;
 
@@ -195,45 +163,17 @@ namespace libcloudphxx
           rr_to_rib = 0,
           ria_to_rib = 0,
           ria_to_rr = 0,
-          rib_to_rr = 0,
-        &dot_th = std::get<0>(tup),
-        &dot_rv = std::get<1>(tup),
-        &dot_rc = std::get<2>(tup),
-        &dot_rr = std::get<3>(tup),
-        &dot_ria = std::get<4>(tup),
-        &dot_rib = std::get<5>(tup);
+          rib_to_rr = 0;
 
         const quantity<si::mass_density, real_t>
-          rhod = std::get<6>(tup) * si::kilograms / si::cubic_metres;
-
-        // const quantity<si::pressure, real_t>
-        //   p   = std::get<7>(tup) * si::pascals;
+          rhod = rhod_in * si::kilograms / si::cubic_metres;
 
         const quantity<si::temperature, real_t>
-          th = std::get<8>(tup) * si::kelvins;
-
-        const real_t
-          &rv     = std::get<9>(tup),
-          &rc     = std::get<10>(tup),
-          &rr     = std::get<11>(tup),
-          &ria    = std::get<12>(tup),
-          &rib    = std::get<13>(tup);
+          th = th_in * si::kelvins;
 
-        // quantity<si::temperature, real_t> T = th * theta_std::exner(p);
         quantity<si::temperature, real_t> T;
         quantity<si::pressure, real_t>    p;
-
-        if(!opts.const_p && opts.th_dry)
-        {
-          T = common::theta_dry::T<real_t>(th, rhod);
-          p = common::theta_dry::p<real_t>(rhod, rv, T);
-        }
-        else if(opts.const_p && !opts.th_dry)
-        {
-          p = std::get<7>(tup) * si::pascals;
-          T = th * common::theta_std::exner(p);
-        }
-        else throw std::runtime_error("rhs_cellwise: one (and only one) of opts.const_p and opts.th_dry must be true");
+        T_p_cell(opts, rhod, p_in, th, rv, T, p);
 
         real_t rvs = const_cp::r_vs(T, p);
         real_t rvsi = const_cp::r_vsi(T, p);
@@ -419,9 +359,194 @@ namespace libcloudphxx
           si::kelvins; //heat of sublimation
         dot_th += th / T * const_cp::l_f(T) / (moist_air::c_pd<real_t>()) * (rc_to_ria + rc_to_rib +
           rr_to_rib - rib_to_rr - ria_to_rr) / si::kelvins; //heat of freezing
+      }
+
+      inline void check_T_p_opts(const bool const_p, const bool th_dry)
+      {
+        if (const_p == th_dry)
+          throw std::runtime_error("rhs_cellwise: one (and only one) of opts.const_p and opts.th_dry must be true");
+      }
+    };
+
+    // batched versions operating on n cells stored in contiguous arrays (structure of arrays);
+    // p is used only if opts.const_p (may be NULL otherwise)
+
+    template <typename real_t>
+    void rhs_cellwise_batch(
+      const opts_t<real_t> &opts,
+      const std::size_t n,
+      real_t *dot_rc,
+      real_t *dot_rr,
+      const real_t *rc,
+      const real_t *rr
+    )
+    {
+      assert(!opts.adj_nwtrph && "libcloudph++: rhs_cellwise without rain evap requires RK4 in adj_cellwise");
+#if defined(_OPENMP)
+#  pragma omp parallel for
+#endif
+      for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(n); ++i)
+        detail::rhs_warm_cell(opts, dot_rc[i], dot_rr[i], rc[i], rr[i]);
+    }
+
+    template <typename real_t>
+    void rhs_cellwise_revap_batch(
+      const opts_t<real_t> &opts,
+      const std::size_t n,
+      real_t *dot_th,
+      real_t *dot_rv,
+      real_t *dot_rc,
+      real_t *dot_rr,
+      const real_t *rhod,
+      const real_t *p,
+      const real_t *th,
+      const real_t *rv,
+      const real_t *rc,
+      const real_t *rr,
+      const real_t &dt
+    )
+    {
+      assert(opts.adj_nwtrph && "libcloudph++: rhs_cellwise with rain evap requires Newton-Raphson in adj_cellwise");
+      detail::check_T_p_opts(opts.const_p, opts.th_dry);
+#if defined(_OPENMP)
+#  pragma omp parallel for
+#endif
+      for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(n); ++i)
+      {
+        detail::rhs_warm_cell(opts, dot_rc[i], dot_rr[i], rc[i], rr[i]);
+        // rain evaporation treated as a force in Newthon-Raphson saturation adjustment
+        detail::rhs_revap_cell(opts, dot_th[i], dot_rv[i], dot_rr[i],
+          rhod[i], opts.const_p ? p[i] : real_t(0), th[i], rv[i], rr[i], dt);
+      }
+    }
+
+    template <typename real_t>
+    void rhs_cellwise_ice_batch(
+      const opts_t<real_t> &opts,
+      const std::size_t n,
+      real_t *dot_th,
+      real_t *dot_rv,
+      real_t *dot_rc,
+      real_t *dot_rr,
+      real_t *dot_ria,
+      real_t *dot_rib,
+      const real_t *rhod,
+      const real_t *p,
+      const real_t *th,
+      const real_t *rv,
+      const real_t *rc,
+      const real_t *rr,
+      const real_t *ria,
+      const real_t *rib,
+      const real_t &dt
+    )
+    {
+      detail::check_T_p_opts(opts.const_p, opts.th_dry);
+#if defined(_OPENMP)
+#  pragma omp parallel for
+#endif
+      for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(n); ++i)
+      {
+        const real_t p_i = opts.const_p ? p[i] : real_t(0);
+
+        // autoconversion, collection and rain evaporation
+        detail::rhs_warm_cell(opts, dot_rc[i], dot_rr[i], rc[i], rr[i]);
+        if(opts.adj_nwtrph)
+          detail::rhs_revap_cell(opts, dot_th[i], dot_rv[i], dot_rr[i], rhod[i], p_i, th[i], rv[i], rr[i], dt);
 
+        detail::rhs_ice_cell(opts, dot_th[i], dot_rv[i], dot_rc[i], dot_rr[i], dot_ria[i], dot_rib[i],
+          rhod[i], p_i, th[i], rv[i], rc[i], rr[i], ria[i], rib[i], dt);
       }
     }
 
+    // adaptors for arbitrary containers of equal size (e.g. Blitz++ arrays),
+    // copied to temporary arrays if their storage is not contiguous
+
+    template <typename real_t, class cont_t>
+    void rhs_cellwise(
+      const opts_t<real_t> &opts,
+      cont_t &dot_rc_cont,
+      cont_t &dot_rr_cont,
+      const cont_t &rc_cont,
+      const cont_t &rr_cont
+    )
+    {
+      using namespace common::detail;
+      const std::size_t n = rc_cont.size();
+      raw_inout_t<real_t, cont_t> dot_rc(dot_rc_cont, n), dot_rr(dot_rr_cont, n);
+      rhs_cellwise_batch<real_t>(opts, n, dot_rc.data(), dot_rr.data(),
+        raw_in_t<real_t, cont_t>(rc_cont, n).data(), raw_in_t<real_t, cont_t>(rr_cont, n).data());
+    }
+
+    template <typename real_t, class cont_t>
+    void rhs_cellwise_revap(
+      const opts_t<real_t> &opts,
+      cont_t &dot_th_cont,
+      cont_t &dot_rv_cont,
+      cont_t &dot_rc_cont,
+      cont_t &dot_rr_cont,
+      const cont_t &rhod_cont,
+      const cont_t &p_cont,
+      const cont_t &th_cont,
+      const cont_t &rv_cont,
+      const cont_t &rc_cont,
+      const cont_t &rr_cont,
+      const real_t &dt
+    )
+    {
+      using namespace common::detail;
+      const std::size_t n = th_cont.size();
+      raw_inout_t<real_t, cont_t>
+        dot_th(dot_th_cont, n), dot_rv(dot_rv_cont, n), dot_rc(dot_rc_cont, n), dot_rr(dot_rr_cont, n);
+      rhs_cellwise_revap_batch<real_t>(opts, n,
+        dot_th.data(), dot_rv.data(), dot_rc.data(), dot_rr.data(),
+        raw_in_t<real_t, cont_t>(rhod_cont, n).data(),
+        raw_in_t<real_t, cont_t>(p_cont, opts.const_p ? n : 0).data(),
+        raw_in_t<real_t, cont_t>(th_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rv_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rc_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rr_cont, n).data(),
+        dt
+      );
+    }
+
+    template <typename real_t, class cont_t>
+    void rhs_cellwise_ice(
+      const opts_t<real_t> &opts,
+      cont_t &dot_th_cont,
+      cont_t &dot_rv_cont,
+      cont_t &dot_rc_cont,
+      cont_t &dot_rr_cont,
+      cont_t &dot_ria_cont,
+      cont_t &dot_rib_cont,
+      const cont_t &rhod_cont,
+      const cont_t &p_cont,
+      const cont_t &th_cont,
+      const cont_t &rv_cont,
+      const cont_t &rc_cont,
+      const cont_t &rr_cont,
+      const cont_t &ria_cont,
+      const cont_t &rib_cont,
+      const real_t &dt
+    )
+    {
+      using namespace common::detail;
+      const std::size_t n = th_cont.size();
+      raw_inout_t<real_t, cont_t>
+        dot_th(dot_th_cont, n), dot_rv(dot_rv_cont, n), dot_rc(dot_rc_cont, n), dot_rr(dot_rr_cont, n),
+        dot_ria(dot_ria_cont, n), dot_rib(dot_rib_cont, n);
+      rhs_cellwise_ice_batch<real_t>(opts, n,
+        dot_th.data(), dot_rv.data(), dot_rc.data(), dot_rr.data(), dot_ria.data(), dot_rib.data(),
+        raw_in_t<real_t, cont_t>(rhod_cont, n).data(),
+        raw_in_t<real_t, cont_t>(p_cont, opts.const_p ? n : 0).data(),
+        raw_in_t<real_t, cont_t>(th_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rv_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rc_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rr_cont, n).data(),
+        raw_in_t<real_t, cont_t>(ria_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rib_cont, n).data(),
+        dt
+      );
+    }
   }
 }
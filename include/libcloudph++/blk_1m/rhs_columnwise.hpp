@@ -9,6 +9,7 @@
 #pragma once
 
 #include "extincl.hpp"
+#include "../common/detail/raw_array.hpp"
 
 namespace libcloudphxx
 {
@@ -16,6 +17,173 @@ namespace libcloudphxx
   {
     enum class ice_t {iceA, iceB};
 
+    namespace detail
+    {
+      // number of columns swept in lock-step (vectorised across columns)
+      const int columnwise_block = 32;
+
+      // rain flux [kg/m3/s] through the bottom edge of a cell (rhod, rr) lying above a cell (rhod_below, rr_below);
+      // terminal momenta at grid-cell edge (to assure precip mass conservation), rhod_0 is the density at the lowest level
+      template <typename real_t>
+      inline real_t rain_flux(
+        const real_t &rhod_below,
+        const real_t &rr_below,
+        const real_t &rhod,
+        const real_t &rr,
+        const real_t &rhod_0,
+        const real_t &dz
+      )
+      {
+        return real_t(-real_t(.5) * ( // averaging + axis orientation
+          (rhod_below * si::kilograms / si::cubic_metres) * formulae::v_term(
+            rr_below   * si::kilograms / si::kilograms,
+            rhod_below * si::kilograms / si::cubic_metres,
+            rhod_0     * si::kilograms / si::cubic_metres
+          ) +
+          (rhod * si::kilograms / si::cubic_metres) * formulae::v_term(
+            rr         * si::kilograms / si::kilograms,
+            rhod       * si::kilograms / si::cubic_metres,
+            rhod_0     * si::kilograms / si::cubic_metres
+          )
+        ) * (rr * si::kilograms / si::kilograms) / (dz * si::metres) / (si::kilograms / si::cubic_metres / si::seconds));
+      }
+
+      // same for ice A or ice B (from Grabowski 1999)
+      template <typename real_t>
+      inline real_t ice_flux(
+        const ice_t &ice_type,
+        const real_t &rhod_below,
+        const real_t &ri_below,
+        const real_t &rhod,
+        const real_t &ri,
+        const real_t &dz
+      )
+      {
+        const auto v_below = ice_type == ice_t::iceA
+          ? formulae::velocity_iceA(ri_below * si::kilograms / si::kilograms, rhod_below * si::kilograms / si::cubic_metres)
+          : formulae::velocity_iceB(ri_below * si::kilograms / si::kilograms, rhod_below * si::kilograms / si::cubic_metres);
+        const auto v = ice_type == ice_t::iceA
+          ? formulae::velocity_iceA(ri * si::kilograms / si::kilograms, rhod * si::kilograms / si::cubic_metres)
+          : formulae::velocity_iceB(ri * si::kilograms / si::kilograms, rhod * si::kilograms / si::cubic_metres);
+
+        return real_t(-real_t(.5) * ( // averaging + axis orientation
+          (rhod_below * si::kilograms / si::cubic_metres) * v_below +
+          (rhod * si::kilograms / si::cubic_metres) * v
+        ) * (ri * si::kilograms / si::kilograms) / (dz * si::metres) / (si::kilograms / si::cubic_metres / si::seconds));
+      }
+
+      // upstream sweep from the top to the bottom of n_col columns, flux(o_below, o, o_0) gives the flux
+      // through the bottom edge of the cell at offset o (o_0 being the offset of the lowest cell in the column)
+      template <typename real_t, class flux_fun_t>
+      void columnwise_sweep(
+        const std::size_t n_col,
+        const std::size_t n_z,
+        const std::ptrdiff_t col_stride,
+        const std::ptrdiff_t lev_stride,
+        real_t *dot,
+        const real_t *rhod,
+        real_t *flux_out_dom,
+        const flux_fun_t &flux
+      )
+      {
+        const std::ptrdiff_t n_blk = (n_col + columnwise_block - 1) / columnwise_block;
+#if defined(_OPENMP)
+#  pragma omp parallel for
+#endif
+        for (std::ptrdiff_t b = 0; b < n_blk; ++b)
+        {
+          const std::ptrdiff_t c0 = b * columnwise_block;
+          const int n_c = std::min<std::ptrdiff_t>(columnwise_block, n_col - c0);
+
+          // zero flux from above the domain top
+          real_t flux_in[columnwise_block];
+          for (int c = 0; c < n_c; ++c) flux_in[c] = 0;
+
+          for (std::ptrdiff_t k = std::ptrdiff_t(n_z) - 1; k >= 0; --k)
+          {
+#if defined(_OPENMP)
+#  pragma omp simd
+#endif
+            for (int c = 0; c < n_c; ++c)
+            {
+              const std::ptrdiff_t
+                o_0 = (c0 + c) * col_stride,
+                o = o_0 + k * lev_stride,
+                o_below = k > 0 ? o - lev_stride : o; // the bottom grid cell with mid-cell vterm approximation
+
+              const real_t flux_out = flux(o_below, o, o_0);
+              dot[o] -= (flux_in[c] - flux_out) / rhod[o];
+              flux_in[c] = flux_out; // inflow = outflow from above
+            }
+          }
+
+          // outflow from the domain
+          if (flux_out_dom != NULL)
+            for (int c = 0; c < n_c; ++c) flux_out_dom[c0 + c] = n_z > 0 ? flux_in[c] : 0;
+        }
+      }
+    };
+
+    // batched versions for n_col columns of n_z levels: level k (k=0 being the lowest) of column c
+    // is at [c * col_stride + k * lev_stride], e.g. col_stride = n_z and lev_stride = 1 for C-ordered
+    // (nx, nz) or (nx, ny, nz) arrays; rain flux out of the domain of each column is stored in flux (if not NULL)
+    template <typename real_t>
+    void rhs_columnwise_batch(
+      const opts_t<real_t> &opts,
+      const std::size_t n_col,
+      const std::size_t n_z,
+      const std::ptrdiff_t col_stride,
+      const std::ptrdiff_t lev_stride,
+      real_t *dot_rr,
+      const real_t *rhod,
+      const real_t *rr,
+      const real_t &dz,
+      real_t *flux = NULL
+    )
+    {
+      if (!opts.sedi)
+      {
+        if (flux != NULL) std::fill(flux, flux + n_col, real_t(0));
+        return;
+      }
+
+      detail::columnwise_sweep(n_col, n_z, col_stride, lev_stride, dot_rr, rhod, flux,
+        [=](const std::ptrdiff_t &o_below, const std::ptrdiff_t &o, const std::ptrdiff_t &o_0)
+        {
+          return detail::rain_flux(rhod[o_below], rr[o_below], rhod[o], rr[o], rhod[o_0], dz);
+        }
+      );
+    }
+
+    template <typename real_t>
+    void rhs_columnwise_ice_batch(
+      const opts_t<real_t> &opts,
+      const std::size_t n_col,
+      const std::size_t n_z,
+      const std::ptrdiff_t col_stride,
+      const std::ptrdiff_t lev_stride,
+      real_t *dot_ri,
+      const real_t *rhod,
+      const real_t *ri,
+      const real_t &dz,
+      const ice_t &ice_type, // ice A or ice B (from Grabowski 1999)
+      real_t *flux = NULL
+    )
+    {
+      if (!opts.sedi)
+      {
+        if (flux != NULL) std::fill(flux, flux + n_col, real_t(0));
+        return;
+      }
+
+      detail::columnwise_sweep(n_col, n_z, col_stride, lev_stride, dot_ri, rhod, flux,
+        [=](const std::ptrdiff_t &o_below, const std::ptrdiff_t &o, const std::ptrdiff_t &)
+        {
+          return detail::ice_flux(ice_type, rhod[o_below], ri[o_below], rhod[o], ri[o], dz);
+        }
+      );
+    }
+
     // expects the arguments to be columns with begin() pointing to the lowest level
     // returns rain flux out of the domain
 //<listing>
@@ -29,64 +197,20 @@ namespace libcloudphxx
     )
 //</listing>
     {
-      using flux_t = quantity<divide_typeof_helper<si::mass_density, si::time>::type, real_t>;
-
-      auto dot_rr_unit = si::hertz;
+      using namespace common::detail;
 
       if (!opts.sedi) return 0;
 
-      //
-      flux_t flux_in = 0 * si::kilograms / si::cubic_metres / si::seconds;
-      real_t *dot_rr = NULL;
-      const real_t zero = 0;
-
-      // this should give zero flux from above the domain top
-      const real_t *rhod = &*(--(rhod_cont.end())), *rr = &zero;
-
-      auto iter = zip(dot_rr_cont, rhod_cont, rr_cont);
-      for (auto tup_ptr = iter.end(); tup_ptr != iter.begin();)
-      {
-        --tup_ptr;
-
-        const real_t
-          *rhod_below  = &std::get<1>(*tup_ptr),
-          *rr_below    = &std::get<2>(*tup_ptr);
-
-        if (dot_rr != NULL) // i.e. all but first (top) grid cell
-        {
-          // terminal momenta at grid-cell edge (to assure precip mass conservation)
-          flux_t flux_out = -real_t(.5) * ( // averaging + axis orientation
-            (*rhod_below * si::kilograms / si::cubic_metres) * formulae::v_term(
-              *rr_below          * si::kilograms / si::kilograms,
-              *rhod_below        * si::kilograms / si::cubic_metres,
-              *rhod_cont.begin() * si::kilograms / si::cubic_metres
-            ) +
-            (*rhod * si::kilograms / si::cubic_metres) * formulae::v_term(
-              *rr                * si::kilograms / si::kilograms,
-              *rhod              * si::kilograms / si::cubic_metres,
-              *rhod_cont.begin() * si::kilograms / si::cubic_metres
-            )
-          ) * (*rr * si::kilograms / si::kilograms) / (dz * si::metres);
-
-          *dot_rr -= (flux_in - flux_out) / (*rhod * si::kilograms / si::cubic_metres) / dot_rr_unit;
-          flux_in = flux_out; // inflow = outflow from above
-        }
-
-        dot_rr = &std::get<0>(*tup_ptr);
-        rhod   = rhod_below;
-        rr     = rr_below;
-      }
-
-      // the bottom grid cell (with mid-cell vterm approximation)
-      flux_t flux_out = - (*rhod * si::kilograms / si::cubic_metres) * formulae::v_term(
-        *rr                * si::kilograms / si::kilograms,
-        *rhod              * si::kilograms / si::cubic_metres,
-        *rhod_cont.begin() * si::kilograms / si::cubic_metres
-      ) * (*rr * si::kilograms / si::kilograms) / (dz * si::metres);
-      *dot_rr -= (flux_in - flux_out) / (*rhod * si::kilograms / si::cubic_metres) / dot_rr_unit;
-
-      // outflow from the domain
-      return real_t(flux_out / (si::kilograms / si::cubic_metres / si::seconds));
+      const std::size_t n = rhod_cont.size();
+      raw_inout_t<real_t, cont_t> dot_rr(dot_rr_cont, n);
+      real_t flux;
+      rhs_columnwise_batch<real_t>(opts, 1, n, n, 1,
+        dot_rr.data(),
+        raw_in_t<real_t, cont_t>(rhod_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rr_cont, n).data(),
+        dz, &flux
+      );
+      return flux;
     }
 
 
@@ -102,90 +226,20 @@ namespace libcloudphxx
     )
 //</listing>
     {
-      using flux_t = quantity<divide_typeof_helper<si::mass_density, si::time>::type, real_t>;
-
-      auto dot_ri_unit = si::hertz;
+      using namespace common::detail;
 
       if (!opts.sedi) return 0;
 
-      //
-      flux_t flux_in = 0 * si::kilograms / si::cubic_metres / si::seconds;
-      real_t *dot_ri = NULL;
-      const real_t zero = 0;
-
-      // this should give zero flux from above the domain top
-      const real_t *rhod = &*(--(rhod_cont.end())), *ri = &zero;
-
-      auto iter = zip(dot_ri_cont, rhod_cont, ri_cont);
-      for (auto tup_ptr = iter.end(); tup_ptr != iter.begin();)
-      {
-        --tup_ptr;
-
-        const real_t
-          *rhod_below  = &std::get<1>(*tup_ptr),
-          *ri_below     = &std::get<2>(*tup_ptr);
-
-        if (dot_ri != NULL) // i.e. all but first (top) grid cell
-        {
-          flux_t flux_out = real_t(0) * si::kilograms / si::cubic_metres / si::seconds;
-          if (ice_type == ice_t::iceA)
-          {
-            // terminal momenta at grid-cell edge (to assure precip mass conservation)
-            flux_out += -real_t(.5) * ( // averaging + axis orientation
-              (*rhod_below * si::kilograms / si::cubic_metres) * formulae::velocity_iceA(
-                *ri_below          * si::kilograms / si::kilograms,
-                *rhod_below        * si::kilograms / si::cubic_metres
-              ) +
-              (*rhod * si::kilograms / si::cubic_metres) * formulae::velocity_iceA(
-                *ri                * si::kilograms / si::kilograms,
-                *rhod              * si::kilograms / si::cubic_metres
-              )
-            ) * (*ri * si::kilograms / si::kilograms) / (dz * si::metres);
-          }
-          else if (ice_type == ice_t::iceB)
-          {
-            // terminal momenta at grid-cell edge (to assure precip mass conservation)
-            flux_out += -real_t(.5) * ( // averaging + axis orientation
-              (*rhod_below * si::kilograms / si::cubic_metres) * formulae::velocity_iceB(
-                *ri_below          * si::kilograms / si::kilograms,
-                *rhod_below        * si::kilograms / si::cubic_metres
-              ) +
-              (*rhod * si::kilograms / si::cubic_metres) * formulae::velocity_iceB(
-                *ri                * si::kilograms / si::kilograms,
-                *rhod              * si::kilograms / si::cubic_metres
-              )
-            ) * (*ri * si::kilograms / si::kilograms) / (dz * si::metres);
-          }
-
-          *dot_ri -= (flux_in - flux_out) / (*rhod * si::kilograms / si::cubic_metres) / dot_ri_unit;
-          flux_in = flux_out; // inflow = outflow from above
-        }
-
-        dot_ri = &std::get<0>(*tup_ptr);
-        rhod   = rhod_below;
-        ri     = ri_below;
-      }
-
-      // the bottom grid cell (with mid-cell vterm approximation)
-      flux_t flux_out = real_t(0) * si::kilograms / si::cubic_metres / si::seconds;
-      if (ice_type == ice_t::iceA)
-      {
-        flux_out += - (*rhod * si::kilograms / si::cubic_metres) * formulae::velocity_iceA(
-          *ri                * si::kilograms / si::kilograms,
-          *rhod              * si::kilograms / si::cubic_metres
-        ) * (*ri * si::kilograms / si::kilograms) / (dz * si::metres);
-      }
-      else if (ice_type == ice_t::iceB)
-      {
-        flux_out += - (*rhod * si::kilograms / si::cubic_metres) * formulae::velocity_iceB(
-          *ri                * si::kilograms / si::kilograms,
-          *rhod              * si::kilograms / si::cubic_metres
-        ) * (*ri * si::kilograms / si::kilograms) / (dz * si::metres);
-      }
-
-      *dot_ri -= (flux_in - flux_out) / (*rhod * si::kilograms / si::cubic_metres) / dot_ri_unit;
-      // outflow from the domain
-      return real_t(flux_out / (si::kilograms / si::cubic_metres / si::seconds));
+      const std::size_t n = rhod_cont.size();
+      raw_inout_t<real_t, cont_t> dot_ri(dot_ri_cont, n);
+      real_t flux;
+      rhs_columnwise_ice_batch<real_t>(opts, 1, n, n, 1,
+        dot_ri.data(),
+        raw_in_t<real_t, cont_t>(rhod_cont, n).data(),
+        raw_in_t<real_t, cont_t>(ri_cont, n).data(),
+        dz, ice_type, &flux
+      );
+      return flux;
     }
   };
 };
@@ -11,81 +11,44 @@
 
 #include <libcloudph++/common/theta_dry.hpp>
 #include <libcloudph++/common/theta_std.hpp>
+#include <libcloudph++/common/detail/raw_array.hpp>
+#include <libcloudph++/lgrngn/backend.hpp>
 
 namespace libcloudphxx
 {
   namespace blk_2m
   {
-//<listing>
-    template <typename real_t, class cont_t>
-    void rhs_cellwise(
-      const opts_t<real_t> &opts,
-      cont_t &dot_th_cont,
-      cont_t &dot_rv_cont,
-      cont_t &dot_rc_cont,
-      cont_t &dot_nc_cont,
-      cont_t &dot_rr_cont,
-      cont_t &dot_nr_cont,
-      const cont_t &rhod_cont,
-      const cont_t &th_cont,              // dry potential temperature (if const_p == false) or "standard" potential temperature (if const_p == true)
-      const cont_t &rv_cont,
-      const cont_t &rc_cont,
-      const cont_t &nc_cont,
-      const cont_t &rr_cont,
-      const cont_t &nr_cont,
-      const real_t &dt,
-      const cont_t &p_cont = cont_t()     // pressure, required if const_p == true
-    )
-//</listing>
+    namespace detail
     {
-      // sanity checks
-      assert(min(rv_cont) >= 0);
-      assert(min(th_cont) > 0);
-      assert(min(rc_cont) >= 0);
-      assert(min(rr_cont) >= 0);
-      assert(min(nc_cont) >= 0);
-      assert(min(nr_cont) >= 0);
-      assert(!opts.const_p || p_cont.size() == th_cont.size());
-      assert(!opts.const_p || min(p_cont) > 0);
-      assert(opts.const_p != opts.th_dry); // either const_p or th_dry
-
-      using namespace formulae;
-      using namespace common::moist_air;
-      using namespace common::theta_dry;
-      using namespace common::theta_std;
-
-      for (auto tup : zip(
-        dot_th_cont,
-        dot_rv_cont,
-        dot_rc_cont,
-        dot_nc_cont,
-        dot_rr_cont,
-        dot_nr_cont,
-        rhod_cont,
-        th_cont,
-        rv_cont,
-        rc_cont,
-        nc_cont,
-        rr_cont,
-        nr_cont,
-        p_cont           // NOTE: for const_p == false, is zipping an empty p_cont safe?
-      ))
+      // microphysics of a single cell (activation, condensation/evaporation, autoconversion and accretion)
+      template <typename real_t>
+      inline void rhs_cell(
+        const opts_t<real_t> &opts,
+        real_t &dot_th,
+        real_t &dot_rv,
+        real_t &dot_rc,
+        real_t &dot_nc,
+        real_t &dot_rr,
+        real_t &dot_nr,
+        const real_t &rhod_in,
+        const real_t &th_in,
+        const real_t &rv_in,
+        const real_t &rc,
+        const real_t &nc,
+        const real_t &rr,
+        const real_t &nr,
+        const real_t &p_in,
+        const real_t &dt
+      )
       {
-        real_t
-          &dot_th = std::get<0>(tup),
-          &dot_rv = std::get<1>(tup),
-          &dot_rc = std::get<2>(tup),
-          &dot_nc = std::get<3>(tup),
-          &dot_rr = std::get<4>(tup),
-          &dot_nr = std::get<5>(tup);
-        const quantity<si::mass_density,  real_t> &rhod  = std::get<6>(tup) * si::kilograms / si::cubic_metres;
-        const quantity<si::temperature,   real_t> &th    = std::get<7>(tup) * si::kelvins;
-        const quantity<si::dimensionless, real_t> &rv    = std::get<8>(tup) * si::dimensionless();
-        const real_t
-          &rc = std::get<9>(tup),
-          &nc = std::get<10>(tup),
-          &rr = std::get<11>(tup),
-          &nr = std::get<12>(tup);
+        using namespace formulae;
+        using namespace common::moist_air;
+        using namespace common::theta_dry;
+        using namespace common::theta_std;
+
+        const quantity<si::mass_density,  real_t> rhod  = rhod_in * si::kilograms / si::cubic_metres;
+        const quantity<si::temperature,   real_t> th    = th_in * si::kelvins;
+        const quantity<si::dimensionless, real_t> rv    = rv_in * si::dimensionless();
 
         // helper dimensionless verions of real_t...
         const quantity<si::dimensionless, real_t> rr_dim = rr * si::dimensionless();
@@ -96,17 +59,17 @@ namespace libcloudphxx
         quantity<si::temperature, real_t> T;
         quantity<si::pressure, real_t>    p;
 
-        if(!opts.const_p && opts.th_dry)
+        // (opts.const_p != opts.th_dry checked by the caller)
+        if(opts.th_dry)
         {
           T = common::theta_dry::T<real_t>(th, rhod);
           p = common::theta_dry::p<real_t>(rhod, rv, T);
         }
-        else if(opts.const_p && !opts.th_dry)
+        else
         {
-          p = std::get<13>(tup) * si::pascals;
+          p = p_in * si::pascals;
           T = th * common::theta_std::exner(p);
         }
-        else throw std::runtime_error("rhs_cellwise: one (and only one) of opts.const_p and opts.th_dry must be true");
 
         // rhs only due to rhs_cellwise microphysics functions (needed for limiting)
         real_t local_dot_rc = 0,
@@ -295,6 +258,118 @@ namespace libcloudphxx
           dot_nr += local_dot_nr;
         }
       }
+    };
+
+    // batched version operating on n cells stored in contiguous arrays (structure of arrays),
+    // run on the CPU backends of lgrngn: serially or in parallel with OpenMP;
+    // p is used only if opts.const_p (may be NULL otherwise)
+    template <typename real_t>
+    void rhs_cellwise_batch(
+      const lgrngn::backend_t backend,
+      const opts_t<real_t> &opts,
+      const std::size_t n,
+      real_t *dot_th,
+      real_t *dot_rv,
+      real_t *dot_rc,
+      real_t *dot_nc,
+      real_t *dot_rr,
+      real_t *dot_nr,
+      const real_t *rhod,
+      const real_t *th,              // dry potential temperature (if const_p == false) or "standard" potential temperature (if const_p == true)
+      const real_t *rv,
+      const real_t *rc,
+      const real_t *nc,
+      const real_t *rr,
+      const real_t *nr,
+      const real_t &dt,
+      const real_t *p = NULL         // pressure, required if const_p == true
+    )
+    {
+      if (opts.const_p == opts.th_dry)
+        throw std::runtime_error("rhs_cellwise: one (and only one) of opts.const_p and opts.th_dry must be true");
+
+      auto cell = [&](const std::ptrdiff_t i)
+      {
+        detail::rhs_cell(opts,
+          dot_th[i], dot_rv[i], dot_rc[i], dot_nc[i], dot_rr[i], dot_nr[i],
+          rhod[i], th[i], rv[i], rc[i], nc[i], rr[i], nr[i],
+          opts.const_p ? p[i] : real_t(0),
+          dt
+        );
+      };
+
+      switch (backend)
+      {
+        case lgrngn::OpenMP:
+#if defined(_OPENMP)
+#  pragma omp parallel for
+          for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(n); ++i) cell(i);
+          break;
+#else
+          throw std::runtime_error("libcloudph++: OpenMP backend was not compiled");
+#endif
+        case lgrngn::serial:
+          for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(n); ++i) cell(i);
+          break;
+        case lgrngn::CUDA:
+        case lgrngn::multi_CUDA:
+          throw std::runtime_error("libcloudph++: blk_2m microphysics is not available in the CUDA backends");
+        default:
+          throw std::runtime_error("libcloudph++: unknown backend");
+      }
+    }
+
+//<listing>
+    template <typename real_t, class cont_t>
+    void rhs_cellwise(
+      const opts_t<real_t> &opts,
+      cont_t &dot_th_cont,
+      cont_t &dot_rv_cont,
+      cont_t &dot_rc_cont,
+      cont_t &dot_nc_cont,
+      cont_t &dot_rr_cont,
+      cont_t &dot_nr_cont,
+      const cont_t &rhod_cont,
+      const cont_t &th_cont,              // dry potential temperature (if const_p == false) or "standard" potential temperature (if const_p == true)
+      const cont_t &rv_cont,
+      const cont_t &rc_cont,
+      const cont_t &nc_cont,
+      const cont_t &rr_cont,
+      const cont_t &nr_cont,
+      const real_t &dt,
+      const cont_t &p_cont = cont_t(),    // pressure, required if const_p == true
+      const lgrngn::backend_t backend = lgrngn::serial
+    )
+//</listing>
+    {
+      // sanity checks
+      assert(min(rv_cont) >= 0);
+      assert(min(th_cont) > 0);
+      assert(min(rc_cont) >= 0);
+      assert(min(rr_cont) >= 0);
+      assert(min(nc_cont) >= 0);
+      assert(min(nr_cont) >= 0);
+      assert(!opts.const_p || p_cont.size() == th_cont.size());
+      assert(!opts.const_p || min(p_cont) > 0);
+      assert(opts.const_p != opts.th_dry); // either const_p or th_dry
+
+      using namespace common::detail;
+      const std::size_t n = th_cont.size();
+      raw_inout_t<real_t, cont_t>
+        dot_th(dot_th_cont, n), dot_rv(dot_rv_cont, n), dot_rc(dot_rc_cont, n),
+        dot_nc(dot_nc_cont, n), dot_rr(dot_rr_cont, n), dot_nr(dot_nr_cont, n);
+      rhs_cellwise_batch<real_t>(backend, opts, n,
+        dot_th.data(), dot_rv.data(), dot_rc.data(), dot_nc.data(), dot_rr.data(), dot_nr.data(),
+        raw_in_t<real_t, cont_t>(rhod_cont, n).data(),
+        raw_in_t<real_t, cont_t>(th_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rv_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rc_cont, n).data(),
+        raw_in_t<real_t, cont_t>(nc_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rr_cont, n).data(),
+        raw_in_t<real_t, cont_t>(nr_cont, n).data(),
+        dt,
+        raw_in_t<real_t, cont_t>(p_cont, opts.const_p ? n : 0).data()
+      );
     }
   };
 };
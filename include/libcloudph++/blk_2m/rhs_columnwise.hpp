@@ -9,11 +9,134 @@
 #pragma once
 
 #include <libcloudph++/blk_2m/extincl.hpp>
+#include <libcloudph++/common/detail/raw_array.hpp>
 
 namespace libcloudphxx
 {
   namespace blk_2m
   {
+    namespace detail
+    {
+      // number of columns swept in lock-step (vectorised across columns)
+      const int columnwise_block = 32;
+
+      // terminal momenta [kg/m2/s] of rain mass (mom_m) and number (mom_n) at the bottom edge of a cell (rhod, rr, nr)
+      // lying above a cell (rhod_below, rr_below, nr_below), averaged over the two cells (to assure precip mass conservation)
+      template <typename real_t>
+      inline void rain_mom(
+        const real_t &rhod_below,
+        const real_t &rr_below,
+        const real_t &nr_below,
+        const real_t &rhod,
+        const real_t &rr,
+        const real_t &nr,
+        real_t &mom_m,
+        real_t &mom_n
+      )
+      {
+        const auto mom_unit = si::kilograms / si::square_metres / si::seconds;
+
+        mom_m = -real_t(.5) * ( // averaging + axis orientation
+          (rhod_below * si::kilograms / si::cubic_metres) * formulae::v_term_m(
+            rhod_below * si::kilograms / si::cubic_metres,
+            rr_below * si::kilograms / si::kilograms,
+            nr_below / si::kilograms
+          ) +
+          (rhod * si::kilograms / si::cubic_metres) * formulae::v_term_m(
+            rhod * si::kilograms / si::cubic_metres,
+            rr * si::kilograms / si::kilograms,
+            nr / si::kilograms
+          )
+        ) / mom_unit;
+
+        mom_n = -real_t(.5) * ( // averaging + axis orientation
+          (rhod_below * si::kilograms / si::cubic_metres) * formulae::v_term_n(
+            rhod_below * si::kilograms / si::cubic_metres,
+            rr_below * si::kilograms / si::kilograms,
+            nr_below / si::kilograms
+          ) +
+          (rhod * si::kilograms / si::cubic_metres) * formulae::v_term_n(
+            rhod * si::kilograms / si::cubic_metres,
+            rr * si::kilograms / si::kilograms,
+            nr / si::kilograms
+          )
+        ) / mom_unit;
+      }
+    };
+
+    // batched version for n_col columns of n_z levels: level k (k=0 being the lowest) of column c
+    // is at [c * col_stride + k * lev_stride], e.g. col_stride = n_z and lev_stride = 1 for C-ordered
+    // (nx, nz) or (nx, ny, nz) arrays; rain flux out of the domain of each column is stored in flux (if not NULL)
+    template <typename real_t>
+    void rhs_columnwise_batch(
+      const opts_t<real_t> &opts,
+      const std::size_t n_col,
+      const std::size_t n_z,
+      const std::ptrdiff_t col_stride,
+      const std::ptrdiff_t lev_stride,
+      real_t *dot_rr,
+      real_t *dot_nr,
+      const real_t *rhod,
+      const real_t *rr,
+      const real_t *nr,
+      const real_t &dt,
+      const real_t &dz,
+      real_t *flux = NULL
+    )
+    {
+      using detail::columnwise_block;
+
+      if (!opts.sedi)
+      {
+        if (flux != NULL) std::fill(flux, flux + n_col, real_t(0));
+        return;
+      }
+
+      const std::ptrdiff_t n_blk = (n_col + columnwise_block - 1) / columnwise_block;
+#if defined(_OPENMP)
+#  pragma omp parallel for
+#endif
+      for (std::ptrdiff_t b = 0; b < n_blk; ++b)
+      {
+        const std::ptrdiff_t c0 = b * columnwise_block;
+        const int n_c = std::min<std::ptrdiff_t>(columnwise_block, n_col - c0);
+
+        // zero flux from above the domain top
+        real_t flux_rr_in[columnwise_block], flux_nr_in[columnwise_block];
+        for (int c = 0; c < n_c; ++c) flux_rr_in[c] = flux_nr_in[c] = 0;
+
+        for (std::ptrdiff_t k = std::ptrdiff_t(n_z) - 1; k >= 0; --k)
+        {
+#if defined(_OPENMP)
+#  pragma omp simd
+#endif
+          for (int c = 0; c < n_c; ++c)
+          {
+            const std::ptrdiff_t
+              o = (c0 + c) * col_stride + k * lev_stride,
+              o_below = k > 0 ? o - lev_stride : o; // the bottom grid cell with mid-cell vterm approximation
+
+            real_t mom_m, mom_n;
+            detail::rain_mom(rhod[o_below], rr[o_below], nr[o_below], rhod[o], rr[o], nr[o], mom_m, mom_n);
+
+            // limited not to remove more than there is in the cell
+            const real_t
+              flux_rr_out = - std::min(-mom_m * rr[o] / dz, rhod[o] * (rr[o] + dt * dot_rr[o]) / dt),
+              flux_nr_out = - std::min(-mom_n * nr[o] / dz, rhod[o] * (nr[o] + dt * dot_nr[o]) / dt);
+
+            dot_rr[o] -= (flux_rr_in[c] - flux_rr_out) / rhod[o];
+            flux_rr_in[c] = flux_rr_out; // inflow = outflow from above
+            dot_nr[o] -= (flux_nr_in[c] - flux_nr_out) / rhod[o];
+            flux_nr_in[c] = flux_nr_out; // inflow = outflow from above
+          }
+        }
+
+        // outflow from the domain
+        if (flux != NULL)
+          for (int c = 0; c < n_c; ++c) flux[c0 + c] = n_z > 0 ? flux_rr_in[c] : 0;
+      }
+    }
+
     // expects the arguments to be columns with begin() pointing to the lowest level
     // returns rain flux out of the domain
 //<listing>
@@ -30,116 +153,21 @@ namespace libcloudphxx
     )
 //</listing>
     {
-      if (!opts.sedi) return 0;
-
-      using flux_rr = quantity<divide_typeof_helper<si::mass_density, si::time>::type, real_t>;
-      using flux_nr = quantity<divide_typeof_helper<si::frequency, si::volume>::type, real_t>;
-
-      auto dot_rr_unit = si::hertz;
-      auto dot_nr_unit = si::hertz / si::kilograms;
-
-      auto rflux_unit = si::kilograms / si::seconds / si::cubic_metres;
-      auto nflux_unit = si::hertz / si::cubic_metres;
-
-      flux_rr flux_rr_in = 0 * si::kilograms / si::cubic_metres / si::seconds;
-      flux_nr flux_nr_in = 0 / si::cubic_metres / si::seconds;
-
-      real_t *dot_rr = NULL;
-      real_t *dot_nr = NULL;
-      const real_t zero = 0;
+      using namespace common::detail;
 
-      // initial values that should give zero flux from above the domain top
-      const real_t
-        *rr = &zero,
-        *nr = &zero,
-        *rhod = &*(--(rhod_cont.end()));
-
-      auto iter = zip(rhod_cont, rr_cont, nr_cont, dot_rr_cont, dot_nr_cont);
-      for (auto tup_ptr = iter.end(); tup_ptr != iter.begin();)
-      {
-        --tup_ptr;
-
-        const real_t
-          *rhod_below = &std::get<0>(*tup_ptr),
-          *rr_below   = &std::get<1>(*tup_ptr),
-          *nr_below   = &std::get<2>(*tup_ptr);
-
-        if (dot_rr != NULL) // i.e. all but first (top) grid cell
-        {
-          // terminal velocities at grid-cell edge (to assure precip mass conservation)
-          quantity<multiply_typeof_helper<si::velocity, si::mass_density>::type, real_t> tmp_mom_m  = -real_t(.5) * ( // averaging + axis orientation
-            (*rhod_below * si::kilograms / si::cubic_metres) * formulae::v_term_m(
-              *rhod_below * si::kilograms / si::cubic_metres,
-              *rr_below * si::kilograms / si::kilograms,
-              *nr_below / si::kilograms
-            ) +
-            (*rhod * si::kilograms / si::cubic_metres) * formulae::v_term_m(
-              *rhod * si::kilograms / si::cubic_metres,
-              *rr * si::kilograms / si::kilograms,
-              *nr / si::kilograms
-            )
-          );
-
-          quantity<multiply_typeof_helper<si::velocity, si::mass_density>::type, real_t> tmp_mom_n  = -real_t(.5) * ( // averaging + axis orientation
-            (*rhod_below * si::kilograms / si::cubic_metres) * formulae::v_term_n(
-              *rhod_below * si::kilograms / si::cubic_metres,
-              *rr_below * si::kilograms / si::kilograms,
-              *nr_below / si::kilograms
-            ) +
-            (*rhod * si::kilograms / si::cubic_metres) * formulae::v_term_n(
-              *rhod * si::kilograms / si::cubic_metres,
-              *rr * si::kilograms / si::kilograms,
-              *nr / si::kilograms
-            )
-          );
-
-          flux_rr flux_rr_out = tmp_mom_m * (*rr * si::kilograms / si::kilograms) / (dz * si::metres);
-          flux_rr_out = - std::min(real_t(-flux_rr_out / rflux_unit), *rhod * (*rr + dt * *dot_rr) / dt) * rflux_unit;
-
-          flux_nr flux_nr_out = tmp_mom_n * (*nr / si::kilograms) / (dz * si::metres);
-          flux_nr_out = - std::min(real_t(-flux_nr_out / nflux_unit), *rhod * (*nr + dt * *dot_nr) / dt) * nflux_unit;
-
-          *dot_rr -= (flux_rr_in - flux_rr_out) / (*rhod * si::kilograms / si::cubic_metres) / dot_rr_unit;
-          flux_rr_in = flux_rr_out; // inflow = outflow from above
-          *dot_nr -= (flux_nr_in - flux_nr_out) / (*rhod * si::kilograms / si::cubic_metres) / dot_nr_unit;
-          flux_nr_in = flux_nr_out; // inflow = outflow from above
-        }
-
-        dot_rr = &std::get<3>(*tup_ptr);
-        dot_nr = &std::get<4>(*tup_ptr);
-        rhod = rhod_below;
-        rr = rr_below;
-        nr = nr_below;
-      }
-
-      // the bottom grid cell (with mid-cell vterm approximation)
-      quantity<multiply_typeof_helper<si::velocity, si::mass_density>::type, real_t>
-        tmp_mom_m = - (*rhod * si::kilograms / si::cubic_metres) * formulae::v_term_m(
-          *rhod * si::kilograms / si::cubic_metres,
-          *rr * si::kilograms / si::kilograms,
-          *nr / si::kilograms
-        );
-      quantity<multiply_typeof_helper<si::velocity, si::mass_density>::type, real_t>
-        tmp_mom_n = - (*rhod * si::kilograms / si::cubic_metres) * formulae::v_term_n(
-          *rhod * si::kilograms / si::cubic_metres,
-          *rr * si::kilograms / si::kilograms,
-          *nr / si::kilograms
-        );
-
-      // outflow from the domain
-      {
-        flux_nr flux_nr_out = tmp_mom_n * (*nr / si::kilograms) / (dz * si::metres);
-        flux_nr_out = - std::min(real_t(-flux_nr_out / nflux_unit), *rhod * (*nr + dt * *dot_nr) / dt) * nflux_unit;
-        *dot_nr -= (flux_nr_in - flux_nr_out) / (*rhod * si::kilograms / si::cubic_metres) / dot_nr_unit;
-      }
-
-      {
-        flux_rr flux_rr_out = tmp_mom_m * (*rr * si::kilograms / si::kilograms) / (dz * si::metres);
-        flux_rr_out = - std::min(real_t(-flux_rr_out / rflux_unit), *rhod * (*rr + dt * *dot_rr) / dt) * rflux_unit;
-        *dot_rr -= (flux_rr_in - flux_rr_out) / (*rhod * si::kilograms / si::cubic_metres) / dot_rr_unit;
+      if (!opts.sedi) return 0;
 
-        return flux_rr_out / (si::kilograms / si::cubic_metres / si::seconds);
-      }
+      const std::size_t n = rhod_cont.size();
+      raw_inout_t<real_t, cont_t> dot_rr(dot_rr_cont, n), dot_nr(dot_nr_cont, n);
+      real_t flux;
+      rhs_columnwise_batch<real_t>(opts, 1, n, n, 1,
+        dot_rr.data(), dot_nr.data(),
+        raw_in_t<real_t, cont_t>(rhod_cont, n).data(),
+        raw_in_t<real_t, cont_t>(rr_cont, n).data(),
+        raw_in_t<real_t, cont_t>(nr_cont, n).data(),
+        dt, dz, &flux
+      );
+      return flux;
     }
   };
 };
@@ -0,0 +1,99 @@
+/** @file
+  * @copyright University of Warsaw
+  * @section LICENSE
+  * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
+  * @brief Access to the values of a container as a raw array (for the batched cellwise routines)
+  */
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace libcloudphxx
+{
+  namespace common
+  {
+    namespace detail
+    {
+      // pointer to the storage of Blitz++ arrays (detected by their isStorageContiguous() member)
+      // if the values are stored contiguously in the order of iteration, i.e. in C order with positive strides...
+      template <class arr_t>
+      auto contiguous_data(arr_t &arr, int) -> decltype((void)arr.isStorageContiguous(), arr.data())
+      {
+        if (!arr.isStorageContiguous()) return nullptr;
+        for (int d = arr.rank() - 1, stride = 1; d >= 0; stride *= arr.extent(d), --d)
+          if (arr.stride(d) != stride) return nullptr;
+        return arr.data();
+      }
+
+      // ... of other containers with contiguous storage (std::vector and alike)...
+      template <class cont_t>
+      auto contiguous_data(cont_t &cont, long) -> typename std::enable_if<
+        std::is_same<
+          typename std::iterator_traits<decltype(std::begin(cont))>::iterator_category,
+          std::random_access_iterator_tag
+        >::value,
+        decltype(cont.data())
+      >::type
+      {
+        return cont.data();
+      }
+
+      // ... and NULL for other ones (e.g. non-contiguous Blitz++ slices)
+      template <class cont_t>
+      std::nullptr_t contiguous_data(cont_t &, ...)
+      {
+        return nullptr;
+      }
+
+      // read-only access to n values of a container (in the order of its iterators), copied if needed
+      template <typename real_t, class cont_t>
+      class raw_in_t
+      {
+        std::vector<real_t> buf;
+        const real_t *ptr;
+
+        public:
+
+        raw_in_t(const cont_t &cont, const std::size_t &n) : ptr(contiguous_data(cont, 0))
+        {
+          if (ptr != nullptr || n == 0) return;
+          buf.resize(n);
+          std::copy_n(std::begin(cont), n, buf.begin());
+          ptr = buf.data();
+        }
+
+        const real_t *data() const { return ptr; }
+      };
+
+      // read-write access to n values of a container, copied back (if needed) when going out of scope
+      template <typename real_t, class cont_t>
+      class raw_inout_t
+      {
+        cont_t &cont;
+        std::vector<real_t> buf;
+        real_t *ptr;
+
+        public:
+
+        raw_inout_t(cont_t &cont, const std::size_t &n) : cont(cont), ptr(contiguous_data(cont, 0))
+        {
+          if (ptr != nullptr || n == 0) return;
+          buf.resize(n);
+          std::copy_n(std::begin(cont), n, buf.begin());
+          ptr = buf.data();
+        }
+
+        ~raw_inout_t()
+        {
+          if (!buf.empty()) std::copy(buf.begin(), buf.end(), std::begin(cont));
+        }
+
+        real_t *data() { return ptr; }
+      };
+    };
+  };
+};
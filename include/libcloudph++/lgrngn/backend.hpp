@@ -1,4 +1,7 @@
-#pragma once 
+#pragma once
+
+#include <string>
+#include <unordered_map>
 
 namespace libcloudphxx
 {
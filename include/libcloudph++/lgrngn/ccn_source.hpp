@@ -5,16 +5,18 @@ namespace libcloudphxx
   namespace lgrngn
   {
 //<listing>
-    enum class src_t { off, simple, matching };
+    enum class src_t { off, simple, matching, matching_indexed };
 //</listing>
     // off - no source
     // simple -   src_dry_distros: new SD are added;                                                               src_dry_sizes: new SD are added
     // matching - src_dry_distros: find similar SD and increase their multiplicity. Add new SD if match not found; src_dry_sizes: new SD are added
+    // matching_indexed - as matching, but the similar SDs are found with a (cell, size bin) lookup table instead of sorting all SDs
 
     const std::unordered_map<src_t, std::string> src_name = {
       {src_t::off, "off"},
       {src_t::simple, "simple"},
-      {src_t::matching, "matching"}
+      {src_t::matching, "matching"},
+      {src_t::matching_indexed, "matching_indexed"}
     };
   };
 };
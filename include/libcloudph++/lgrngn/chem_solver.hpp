@@ -0,0 +1,18 @@
+#pragma once 
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+//<listing>
+    enum class chem_solver_t { rk4, ros2 };
+//</listing>
+    // rk4  - explicit fixed-step 4th order Runge-Kutta (odeint) over the state of all flagged SDs, one step per chemistry substep
+    // ros2 - implicit 2nd order Rosenbrock integrating each SD independently with its own adaptive step (suitable for the stiff oxidation)
+
+    const std::unordered_map<chem_solver_t, std::string> chem_solver_name = {
+      {chem_solver_t::rk4, "rk4"},
+      {chem_solver_t::ros2, "ros2"}
+    };
+  };
+};
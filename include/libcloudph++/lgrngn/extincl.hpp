@@ -3,6 +3,7 @@
 #include <cstddef> // ptrdiff_t
 
 #include <cassert>
+#include <functional>
 #include <memory>
 #include <map>
 #include <unordered_map>
@@ -13,6 +13,7 @@
 #include "advection_scheme.hpp"
 #include "RH_formula.hpp"
 #include "ccn_source.hpp"
+#include "chem_solver.hpp"
 #include "distro_t.hpp"
 #include "../common/chem.hpp"
 #include "../common/ice_nucleation.hpp"
@@ -38,6 +39,9 @@ namespace libcloudphxx
       int nx, ny, nz;
       real_t dx, dy, dz, dt;
 
+      // number of independent parcels in a 0D setup (ensemble members), each one is a separate cell
+      int n_ens;
+
       // no. of substeps for condensation/coalescence. If adaptive_sstp_cond=true, sstp_cond is the maximum no. of substeps.
       int sstp_cond, sstp_coal; 
       // no. of condensation substeps for SDs that activate/deactivate in this timestep
@@ -110,6 +114,14 @@ namespace libcloudphxx
            
       real_t chem_rho;
 
+      // solver of the S(IV) oxidation equations (chem_rct)
+      chem_solver_t chem_solver = chem_solver_t::rk4;
+      real_t chem_ros2_eps = 1e-3; // relative tolerance of the per-SD step size control in the ros2 solver
+
+      // if true, chem_dissoc searches for H+ in a narrow bracket around its previous value (widened if needed)
+      // instead of the fixed [1e-8, 10] mol/L one
+      bool chem_dissoc_warm_start = false;
+
       // do we want to track the time SDs spend inside clouds
       bool diag_incloud_time;
 
@@ -129,6 +141,17 @@ namespace libcloudphxx
       // GPU number to use, only used in CUDA backend (and not in multi_CUDA)
       int dev_id;
 
+      // number of steps between rebalancing of the x-slab decomposition between MPI processes, 0 for no rebalancing
+      int rebalance_freq;
+
+      // called after rebalancing with the new decomposition of this process:
+      // number of cells in x in processes to the left of this one and number of cells in x in this process;
+      // Eulerian arrays passed to the next sync_in() have to follow the new decomposition
+      std::function<void(const int &, const int &)> rebalance_hook;
+
+      // number of host buffers in the queue of diagnostic results (see outbuf_enqueue())
+      int outbuf_queue_len;
+
       // subsidence rate profile, positive downwards [m/s]
       std::vector<real_t> w_LS;
 
@@ -193,6 +216,7 @@ namespace libcloudphxx
       // ctor with defaults (C++03 compliant) ...
       opts_init_t() : 
         nx(0), ny(0), nz(0),
+        n_ens(1),
         dx(1), dy(1), dz(1),
         x0(0), y0(0), z0(0),
         x1(1), y1(1), z1(1),
@@ -227,6 +251,8 @@ namespace libcloudphxx
         RH_formula(RH_formula_t::pv_cc),
         dev_count(0),
         dev_id(-1),
+        rebalance_freq(0),
+        outbuf_queue_len(2),
         n_sd_max(0),
         src_x0(0),
         src_x1(0),
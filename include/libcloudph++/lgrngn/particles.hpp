@@ -6,6 +6,7 @@
 #include "../common/output.hpp"
 #include "opts_init.hpp"
 #include "arrinfo.hpp"
+#include "sd_attrs.hpp"
 #include "backend.hpp"
 
 namespace libcloudphxx
@@ -29,6 +30,21 @@ namespace libcloudphxx
       ) { 
         assert(false);
       }  
+
+      // initialisation with pre-generated SDs instead of opts_init.dry_distros/dry_sizes
+      virtual void init_from_attrs(
+        const sd_attrs_t<real_t> &,
+        const arrinfo_t<real_t> th,
+        const arrinfo_t<real_t> rv,
+        const arrinfo_t<real_t> rhod,
+        const arrinfo_t<real_t> p = arrinfo_t<real_t>(),
+        const arrinfo_t<real_t> courant_x = arrinfo_t<real_t>(),
+        const arrinfo_t<real_t> courant_y = arrinfo_t<real_t>(), 
+        const arrinfo_t<real_t> courant_z = arrinfo_t<real_t>(),
+        const std::map<enum common::chem::chem_species_t, const arrinfo_t<real_t> > ambient_chem = std::map<enum common::chem::chem_species_t, const arrinfo_t<real_t> >()
+      ) { 
+        assert(false);
+      }  
  
       // stuff that requires Eulerian component to wait
       virtual void step_sync(
@@ -110,7 +126,14 @@ namespace libcloudphxx
       virtual void diag_ice_c_mom(const int&)                                   { assert(false); }
       virtual void diag_ice_mix_ratio()                                         { assert(false); }
       virtual void diag_wet_mass_dens(const real_t&, const real_t&)             { assert(false); }
+
+      // k-th moments of the dry/wet spectrum in bins with given radius edges, for all SDs,
+      // in one pass; returns [n_bins x n_cell] values (bin index varies slowest, cells as in outbuf())
+      virtual std::vector<real_t> diag_dry_spectrum(const std::vector<real_t> &, const int&) { assert(false); return std::vector<real_t>(); }
+      virtual std::vector<real_t> diag_wet_spectrum(const std::vector<real_t> &, const int&) { assert(false); return std::vector<real_t>(); }
+
       virtual void diag_chem(const enum common::chem::chem_species_t&)          { assert(false); }
+      virtual void diag_chem_dissoc_iter()                                      { assert(false); }
       virtual void diag_precip_rate()                                           { assert(false); }
       virtual void diag_precip_rate_ice_mass()                                  { assert(false); }
       virtual void diag_kappa_mom(const int&)                                   { assert(false); }
@@ -122,8 +145,31 @@ namespace libcloudphxx
       virtual void diag_vel_div()                                               { assert(false); }
       virtual std::map<libcloudphxx::common::output_t, real_t> diag_puddle()    { assert(false); return std::map<libcloudphxx::common::output_t, real_t>(); }
       virtual std::vector<real_t> get_attr(const std::string &)                 { assert(false); return std::vector<real_t>(); }
+      // several attributes in one call, attr_names.size() * n_sd values (all values of the first attribute, then of the second, ...)
+      virtual std::vector<real_t> get_attrs(const std::vector<std::string> &)   { assert(false); return std::vector<real_t>(); }
       virtual real_t *outbuf()                                                  { assert(false); return NULL; }
 
+      // reductions of the last moment diagnostic computed on the device (instead of outbuf()):
+      // air-mass-weighted horizontal mean at each level [nz], vertical integral of rhod times the moment
+      // in each column [nx x ny] (e.g. LWP from diag_wet_mom(3)), air-mass-weighted domain mean;
+      // profile and domain are reduced over all MPI processes
+      virtual std::vector<real_t> outbuf_profile()                              { assert(false); return std::vector<real_t>(); }
+      virtual std::vector<real_t> outbuf_column()                               { assert(false); return std::vector<real_t>(); }
+      virtual real_t outbuf_domain()                                            { assert(false); return 0; }
+
+      // queue of diagnostic results (alternative to outbuf()):
+      // outbuf_enqueue() snapshots the last diagnostic into one of opts_init.outbuf_queue_len host buffers and returns
+      // its sequence number, waiting if all buffers are queued; outbuf_front() returns the oldest buffer
+      // (n_cell values, as in outbuf()) if it is already copied to the host, NULL otherwise; outbuf_pop() releases it;
+      // outbuf_front() and outbuf_pop() may be called from another thread
+      virtual unsigned long long outbuf_enqueue()                               { assert(false); return 0; }
+      virtual const real_t *outbuf_front(unsigned long long &)                  { assert(false); return NULL; }
+      virtual void outbuf_pop()                                                 { assert(false); }
+
+      // checkpointing of the complete state of SDs (to be called after init() and outside of step_cond()/step_async() pair)
+      virtual void save_state(const std::string &)                              { assert(false); }
+      virtual void load_state(const std::string &)                              { assert(false); }
+
       // storing a pointer to opts_init (e.g. for interrogatin about
       // dimensions in Python bindings)
       opts_init_t<real_t> *opts_init;
@@ -148,6 +194,17 @@ namespace libcloudphxx
         const arrinfo_t<real_t> courant_z,
         const std::map<enum common::chem::chem_species_t, const arrinfo_t<real_t> > ambient_chem
       );
+      void init_from_attrs(
+        const sd_attrs_t<real_t> &,
+        const arrinfo_t<real_t> th,
+        const arrinfo_t<real_t> rv,
+        const arrinfo_t<real_t> rhod,
+        const arrinfo_t<real_t> p,
+        const arrinfo_t<real_t> courant_x,
+        const arrinfo_t<real_t> courant_y, 
+        const arrinfo_t<real_t> courant_z,
+        const std::map<enum common::chem::chem_species_t, const arrinfo_t<real_t> > ambient_chem
+      );
       // time-stepping methods
       void step_sync(
         const opts_t<real_t> &,
@@ -204,6 +261,8 @@ namespace libcloudphxx
       void diag_water_cons();
       void diag_dry_mom(const int &k);
       void diag_wet_mom(const int &k);
+      std::vector<real_t> diag_dry_spectrum(const std::vector<real_t> &, const int &k);
+      std::vector<real_t> diag_wet_spectrum(const std::vector<real_t> &, const int &k);
       void diag_ice_a_mom(const int &k);
       void diag_ice_c_mom(const int &k);
       void diag_ice_mix_ratio();
@@ -215,6 +274,7 @@ namespace libcloudphxx
       void diag_wet_mass_dens(const real_t&, const real_t&);
 
       void diag_chem(const enum common::chem::chem_species_t&);
+      void diag_chem_dissoc_iter();
       void diag_rw_ge_rc();
       void diag_RH_ge_Sc();
       void diag_all();
@@ -224,7 +284,17 @@ namespace libcloudphxx
       void diag_vel_div();
       std::map<libcloudphxx::common::output_t, real_t> diag_puddle();
       std::vector<real_t> get_attr(const std::string &);
+      std::vector<real_t> get_attrs(const std::vector<std::string> &);
       real_t *outbuf();
+      std::vector<real_t> outbuf_profile();
+      std::vector<real_t> outbuf_column();
+      real_t outbuf_domain();
+      unsigned long long outbuf_enqueue();
+      const real_t *outbuf_front(unsigned long long &);
+      void outbuf_pop();
+
+      void save_state(const std::string &);
+      void load_state(const std::string &);
 
       struct impl;
       std::unique_ptr<impl> pimpl;
@@ -254,7 +324,18 @@ namespace libcloudphxx
         const arrinfo_t<real_t> courant_x,
         const arrinfo_t<real_t> courant_y, 
         const arrinfo_t<real_t> courant_z,
-        const std::map<enum common::chem::chem_species_t, const arrinfo_t<real_t> > ambient_chem 
+        const std::map<enum common::chem::chem_species_t, const arrinfo_t<real_t> > ambient_chem
+      );
+      void init_from_attrs(
+        const sd_attrs_t<real_t> &,
+        const arrinfo_t<real_t> th,
+        const arrinfo_t<real_t> rv,
+        const arrinfo_t<real_t> rhod,
+        const arrinfo_t<real_t> p,
+        const arrinfo_t<real_t> courant_x,
+        const arrinfo_t<real_t> courant_y,
+        const arrinfo_t<real_t> courant_z,
+        const std::map<enum common::chem::chem_species_t, const arrinfo_t<real_t> > ambient_chem
       );
 
       // time-stepping methods
@@ -313,6 +394,8 @@ namespace libcloudphxx
       void diag_water_cons();
       void diag_dry_mom(const int &k);
       void diag_wet_mom(const int &k);
+      std::vector<real_t> diag_dry_spectrum(const std::vector<real_t> &, const int &k);
+      std::vector<real_t> diag_wet_spectrum(const std::vector<real_t> &, const int &k);
       void diag_ice_a_mom(const int &k);
       void diag_ice_c_mom(const int &k);
       void diag_ice_mix_ratio();
@@ -323,9 +406,20 @@ namespace libcloudphxx
       void diag_incloud_time_mom(const int&);
       void diag_wet_mass_dens(const real_t&, const real_t&);
       std::vector<real_t> get_attr(const std::string &);
+      std::vector<real_t> get_attrs(const std::vector<std::string> &);
       real_t *outbuf();
+      std::vector<real_t> outbuf_profile();
+      std::vector<real_t> outbuf_column();
+      real_t outbuf_domain();
+      unsigned long long outbuf_enqueue();
+      const real_t *outbuf_front(unsigned long long &);
+      void outbuf_pop();
+
+      void save_state(const std::string &);
+      void load_state(const std::string &);
 
       void diag_chem(const enum common::chem::chem_species_t&);
+      void diag_chem_dissoc_iter();
       void diag_rw_ge_rc();
       void diag_RH_ge_Sc();
       void diag_all();
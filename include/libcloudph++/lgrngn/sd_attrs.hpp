@@ -0,0 +1,31 @@
+#pragma once
+
+#include "extincl.hpp"
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    // pre-generated super-droplets passed to init_from_attrs(),
+    // host arrays of length n_sd, not copied (have to be valid only during the call);
+    // positions are in the coordinates of the whole domain, each GPU keeps the SDs from its own subdomain;
+    // with MPI, only the SDs passed to process 0 are used and each is sent to the process that owns it
+    template <typename real_t>
+    struct sd_attrs_t
+    {
+      std::size_t n_sd;
+
+      const unsigned long long *n; // multiplicity
+      const real_t
+        *rd3,       // dry radius cubed [m^3]
+        *kappa,     // hygroscopicity
+        *x, *y, *z, // position [m], only these used in the given number of dimensions
+        *rw2,       // wet radius squared [m^2], optional - if NULL, equilibrium with the ambient RH is assumed
+        *rd2_insol; // insoluble dry radius squared [m^2], optional - if NULL, zero is assumed; used only with ice_switch
+
+      sd_attrs_t() :
+        n_sd(0), n(NULL), rd3(NULL), kappa(NULL), x(NULL), y(NULL), z(NULL), rw2(NULL), rd2_insol(NULL)
+      {}
+    };
+  };
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstring>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // version of the checkpoint file format, increment on any change of the layout below
+      const unsigned int checkpoint_version = 2;
+
+      // data blocks start at multiples of this (in bytes), so that a memory-mapped file can be accessed directly
+      const std::size_t checkpoint_align = 64;
+
+      // header at the beginning of a checkpoint file
+      struct checkpoint_hdr_t
+      {
+        char magic[8];                    // "LCPPSTAT"
+        unsigned int version,             // checkpoint_version
+                     real_size,           // sizeof(real_t)
+                     n_size,              // sizeof(n_t)
+                     n_blk;               // number of data blocks
+        unsigned long long layout,        // checksum of the SD attribute order, see distmem_layout()
+                           n_part,        // number of SDs
+                           n_cell,        // number of cells
+                           src_stp_ctr,   // step counters
+                           rlx_stp_ctr,
+                           rebalance_stp_ctr;
+        int sstp_cond, sstp_coal, sstp_chem, sstp_cond_act;
+        int nx, nx_bfr;                   // x-slab of this process: its nx and the nx of processes to the left
+        double dt;
+      };
+
+      // header is followed by n_blk of these, describing where the data is in the file
+      struct checkpoint_blk_t
+      {
+        unsigned long long offset, // from the beginning of the file, multiple of checkpoint_align
+                           size;   // in bytes
+      };
+
+      inline void checkpoint_set_magic(checkpoint_hdr_t &hdr)
+      {
+        std::memcpy(hdr.magic, "LCPPSTAT", sizeof(hdr.magic));
+      }
+
+      inline bool checkpoint_check_magic(const checkpoint_hdr_t &hdr)
+      {
+        return std::memcmp(hdr.magic, "LCPPSTAT", sizeof(hdr.magic)) == 0;
+      }
+
+      inline std::size_t checkpoint_aligned(const std::size_t &offset)
+      {
+        return (offset + checkpoint_align - 1) / checkpoint_align * checkpoint_align;
+      }
+    };
+  };
+};
@@ -23,6 +23,7 @@ namespace libcloudphxx
         const real_t rd_min_init = 1e-14, 
                      rd_max_init = 1e-3;   // bounding values for the initial dry radius distro
         const int bfr_fraction = 2;      // in/out buffers size = ny * nz * n_sd_max / bfr_fraction
+        const real_t rebalance_imbalance = 1.1; // x-slabs are rebalanced only if the busiest MPI process has that many times the mean number of SDs
         const real_t cond_mlt = 2.;      // arbitrary multiplier that defines range over which equilibrium radius is searched during condensation
         const int vt0_n_bin = 10000;     // number of bins to cache terminal velocity in beard77fast case
         // range of beard77fast bins:
@@ -0,0 +1,33 @@
+#pragma once
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // header of the byte buffer with SDs copied to another process/GPU;
+      // the header is followed by the n_t attributes and then by the real_t attributes,
+      // each attribute stored as a contiguous block of n_sd values
+      struct distmem_bfr_hdr_t
+      {
+        unsigned long long n_sd,      // number of SDs in the buffer
+                           n_vctrs_n, // number of n_t attributes per SD
+                           n_vctrs_real, // number of real_t attributes per SD
+                           layout;    // checksum of the attribute order, has to match on both ends
+      };
+
+      // size in bytes of a buffer holding n_sd SDs
+      template <typename n_t, typename real_t>
+      std::size_t distmem_bfr_size(
+        const std::size_t n_sd,
+        const std::size_t n_vctrs_n,
+        const std::size_t n_vctrs_real
+      )
+      {
+        static_assert(sizeof(distmem_bfr_hdr_t) % sizeof(n_t) == 0 && sizeof(n_t) % sizeof(real_t) == 0, "");
+        return sizeof(distmem_bfr_hdr_t) + n_sd * (n_vctrs_n * sizeof(n_t) + n_vctrs_real * sizeof(real_t));
+      }
+    };
+  };
+};
@@ -10,7 +10,7 @@ namespace libcloudphxx
       namespace
       {
         // mpi message tags
-        enum {tag_n_lft, tag_real_lft, tag_n_rgt, tag_real_rgt};
+        enum {tag_lft, tag_rgt}; // SDs going left/right
 
         template<typename real_t>
         MPI_Datatype get_mpi_type()
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <stdexcept>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // ring of host buffers with diagnostic results;
+      // filled by the thread that steps the model, drained by the caller (e.g. by an I/O thread)
+      template <typename real_t, class dev_vec_t>
+      class outbuf_queue
+      {
+        public:
+
+        struct slot_t
+        {
+          dev_vec_t dev;   // copy of the result on the device
+          real_t *host;    // page-locked on CUDA, so that the copy is asynchronous
+          std::size_t n;   // size of host
+          unsigned long long seq;
+#if defined(__NVCC__)
+          cudaEvent_t copied;
+#endif
+
+          slot_t() : host(NULL), n(0)
+          {
+#if defined(__NVCC__)
+            gpuErrchk(cudaEventCreateWithFlags(&copied, cudaEventDisableTiming));
+#endif
+          }
+
+          ~slot_t()
+          {
+#if defined(__NVCC__)
+            cudaEventDestroy(copied);
+            if (host != NULL) cudaFreeHost(host);
+#else
+            delete[] host;
+#endif
+          }
+
+          void resize(const std::size_t &new_n)
+          {
+            dev.resize(new_n);
+            if (new_n == n) return;
+#if defined(__NVCC__)
+            if (host != NULL) gpuErrchk(cudaFreeHost(host));
+            gpuErrchk(cudaMallocHost(&host, new_n * sizeof(real_t)));
+#else
+            delete[] host;
+            host = new real_t[new_n];
+#endif
+            n = new_n;
+          }
+
+          // start copying dev to host
+          void copy()
+          {
+#if defined(__NVCC__)
+            gpuErrchk(cudaMemcpyAsync(host, thrust::raw_pointer_cast(dev.data()), n * sizeof(real_t), cudaMemcpyDeviceToHost, 0));
+            gpuErrchk(cudaEventRecord(copied, 0));
+#else
+            thrust::copy(dev.begin(), dev.end(), host);
+#endif
+          }
+
+          bool ready()
+          {
+#if defined(__NVCC__)
+            const cudaError_t err = cudaEventQuery(copied);
+            if (err == cudaErrorNotReady) return false;
+            gpuErrchk(err);
+#endif
+            return true;
+          }
+        };
+
+        private:
+
+        std::vector<std::unique_ptr<slot_t>> slots;
+        std::size_t head,  // oldest queued buffer
+                    count; // number of queued buffers
+        unsigned long long next_seq;
+        std::mutex mtx;
+        std::condition_variable not_full;
+
+        public:
+
+        outbuf_queue(const std::size_t &n_slots) : head(0), count(0), next_seq(0)
+        {
+          for (std::size_t i = 0; i < n_slots; ++i)
+            slots.emplace_back(new slot_t());
+        }
+
+        // free slot to be filled with a result of size n; waits while all buffers are queued
+        slot_t &acquire(const std::size_t &n)
+        {
+          std::unique_lock<std::mutex> lock(mtx);
+          not_full.wait(lock, [this]{ return count < slots.size(); });
+          slot_t &slot = *slots[(head + count) % slots.size()];
+          lock.unlock();
+          slot.resize(n);
+          return slot;
+        }
+
+        // queue the slot returned by the last acquire() (after its dev was filled)
+        unsigned long long push(slot_t &slot)
+        {
+          slot.copy();
+          std::lock_guard<std::mutex> lock(mtx);
+          slot.seq = next_seq++;
+          ++count;
+          return slot.seq;
+        }
+
+        // oldest buffer if it is already copied to the host, NULL otherwise
+        const real_t *front(unsigned long long &seq)
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          if (count == 0) return NULL;
+          slot_t &slot = *slots[head];
+          if (!slot.ready()) return NULL;
+          seq = slot.seq;
+          return slot.host;
+        }
+
+        // release the oldest buffer
+        void pop()
+        {
+          {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (count == 0)
+              throw std::runtime_error("libcloudph++: outbuf_pop() called with no queued output");
+            head = (head + 1) % slots.size();
+            --count;
+          }
+          not_full.notify_one();
+        }
+      };
+    };
+  };
+};
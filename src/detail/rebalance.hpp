@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cassert>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // new x-slab boundaries (in columns, first one is 0, last one is the total nx)
+      // that even out the number of SDs per process, given the number of SDs in each column;
+      // each boundary is moved at most up to the neighbouring old boundary,
+      // so that SDs have to be copied by at most one process
+      inline std::vector<int> balanced_x_bnds(
+        const std::vector<double> &col_n_sd, // number of SDs in each column of the whole domain
+        const std::vector<int> &old_bnds,    // current boundaries, size = number of processes + 1
+        const int &min_nx                    // minimal number of columns per process
+      )
+      {
+        const int size = old_bnds.size() - 1,
+                  nx   = old_bnds.back();
+        assert(col_n_sd.size() == nx);
+
+        // cum[c] - number of SDs in columns [0, c)
+        std::vector<double> cum(nx + 1, 0);
+        std::partial_sum(col_n_sd.begin(), col_n_sd.end(), cum.begin() + 1);
+
+        std::vector<int> new_bnds(old_bnds);
+        for(int k = 1; k < size; ++k)
+        {
+          const double target = cum.back() * k / size;
+          int b = std::lower_bound(cum.begin(), cum.end(), target) - cum.begin();
+          if(b > 0 && target - cum[b-1] < cum[b] - target) --b;
+
+          b = std::min(std::max(b, old_bnds[k-1]), old_bnds[k+1]);
+          new_bnds[k] = std::max(b, new_bnds[k-1] + min_nx);
+        }
+        for(int k = size - 1; k > 0; --k)
+          new_bnds[k] = std::min(new_bnds[k], new_bnds[k+1] - min_nx);
+
+        return new_bnds;
+      }
+    };
+  };
+};
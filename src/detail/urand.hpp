@@ -7,8 +7,11 @@
 #  include <limits>
 #else
 #  include <random>
+#  include <cmath>
 #  include <algorithm>
 #endif
+#include <iostream>
+#include <stdexcept>
 
 namespace libcloudphxx
 {
@@ -16,6 +19,42 @@ namespace libcloudphxx
   {
     namespace detail
     {
+      // splitmix64 finaliser
+      BOOST_GPU_ENABLED
+      inline unsigned long long splitmix64(unsigned long long z)
+      {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+      }
+
+      // counter-based stream of normal variates with mean 0 and std dev 1:
+      // the i-th variate depends only on the stream key and on i, so it can be
+      // evaluated inline in any kernel without storing the random numbers
+      template <typename real_t>
+      struct normal01_ctr
+      {
+        const unsigned long long key;
+
+        normal01_ctr(const unsigned long long &key) : key(key) {}
+
+        BOOST_GPU_ENABLED
+        real_t operator()(const unsigned long long &i) const
+        {
+#if !defined(__NVCC__)
+          using std::sqrt;
+          using std::log;
+          using std::cos;
+#endif
+          const unsigned long long bits = splitmix64(key + (i + 1) * 0x9e3779b97f4a7c15ULL);
+          // two uniform variates from the upper and lower 32 bits, u1 in (0,1] and u2 in [0,1)
+          const real_t u1 = (real_t(bits >> 32) + real_t(1)) * real_t(2.3283064365386963e-10),
+                       u2 = real_t(bits & 0xffffffffULL) * real_t(2.3283064365386963e-10);
+          // Box-Muller transform
+          return sqrt(real_t(-2) * log(u1)) * cos(real_t(6.283185307179586) * u2);
+        }
+      };
+
       template <typename real_t, int backend>
       class rng
       {
@@ -61,6 +100,18 @@ namespace libcloudphxx
           engine.seed(seed);
         }
 
+        // complete state (incl. values cached by the distributions), used for checkpointing
+        void save(std::ostream &os) const
+        {
+          os << engine << ' ' << dist_u01 << ' ' << dist_normal01 << ' ' << dist_un;
+        }
+
+        void load(std::istream &is)
+        {
+          is >> engine >> dist_u01 >> dist_normal01 >> dist_un;
+          if(!is) throw std::runtime_error("libcloudph++: corrupted random number generator state in checkpoint");
+        }
+
         void generate_n(
           thrust_device::vector<real_t> &u01, 
           const thrust_size_t n
@@ -84,6 +135,13 @@ namespace libcloudphxx
           // note: generate_n copies the third argument!!!
           std::generate_n(un.begin(), n, fnctr_un({engine, dist_un})); 
         }
+
+        // key of a new counter-based stream (see normal01_ctr)
+        unsigned long long stream_key()
+        {
+          const unsigned long long hi = engine();
+          return (hi << 32) | engine();
+        }
 #endif
       };
  
@@ -95,17 +153,38 @@ namespace libcloudphxx
 
         // private member fields
         curandGenerator_t gen;
+        unsigned long long seed,   // last seed used
+                           n_calls; // number of calls to generate functions since then
         
         public:
 
-        rng(int seed)
+        rng(int _seed) : seed(_seed), n_calls(0)
         {
           gpuErrchk(curandCreateGenerator(&gen, CURAND_RNG_PSEUDO_MTGP32));
           gpuErrchk(curandSetPseudoRandomGeneratorSeed(gen, seed));
         }
 
-        void reseed(int seed)
+        void reseed(int _seed)
+        {
+          seed = _seed;
+          n_calls = 0;
+          gpuErrchk(curandSetPseudoRandomGeneratorSeed(gen, seed));
+        }
+
+        // curand host API gives no access to the MTGP32 state, hence a checkpoint stores
+        // the seed and the number of calls and the generator is reseeded with a value derived from both;
+        // restarts from a given checkpoint are reproducible, but differ from an uninterrupted run
+        void save(std::ostream &os) const
+        {
+          os << seed << ' ' << n_calls;
+        }
+
+        void load(std::istream &is)
         {
+          is >> seed >> n_calls;
+          if(!is) throw std::runtime_error("libcloudph++: corrupted random number generator state in checkpoint");
+          seed = seed * 6364136223846793005ULL + n_calls + 1;
+          n_calls = 0;
           gpuErrchk(curandSetPseudoRandomGeneratorSeed(gen, seed));
         }
 
@@ -119,6 +198,7 @@ namespace libcloudphxx
           const thrust_size_t n
         )
         {
+          ++n_calls;
           gpuErrchk(curandGenerateUniform(gen, thrust::raw_pointer_cast(v.data()), n)); // (0,1] range
           // shift into the expected [0,1) range
           namespace arg = thrust::placeholders;
@@ -130,6 +210,7 @@ namespace libcloudphxx
           const thrust_size_t n
         )
         {
+          ++n_calls;
           gpuErrchk(curandGenerateUniformDouble(gen, thrust::raw_pointer_cast(v.data()), n)); // (0,1] range
           // shift into the expected [0,1) range
           namespace arg = thrust::placeholders;
@@ -141,6 +222,7 @@ namespace libcloudphxx
           const thrust_size_t n
         )
         {
+          ++n_calls;
           gpuErrchk(curandGenerateNormal(gen, thrust::raw_pointer_cast(v.data()), n, float(0), float(1)));
         }
 
@@ -149,6 +231,7 @@ namespace libcloudphxx
           const thrust_size_t n
         )
         {
+          ++n_calls;
           gpuErrchk(curandGenerateNormalDouble(gen, thrust::raw_pointer_cast(v.data()), n, double(0), double(1)));
         }
 
@@ -157,8 +240,16 @@ namespace libcloudphxx
           const thrust_size_t n
         )
         {
+          ++n_calls;
           gpuErrchk(curandGenerate(gen, thrust::raw_pointer_cast(v.data()), n));
         }
+
+        // key of a new counter-based stream (see normal01_ctr)
+        unsigned long long stream_key()
+        {
+          ++n_calls;
+          return splitmix64(seed * 0x9e3779b97f4a7c15ULL + n_calls);
+        }
 #endif
       };
     };
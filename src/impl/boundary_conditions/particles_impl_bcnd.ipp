@@ -171,22 +171,18 @@ namespace libcloudphxx
               arg::_1 >= opts_init.x1
             ) - rgt_id.begin();
 
-            const int no_of_n_vctrs_copied(distmem_n_vctrs.size());
-            const int no_of_real_vctrs_copied(distmem_real_vctrs.size());
-
-            if(lft_count*no_of_n_vctrs_copied > in_n_bfr.size() || rgt_count*no_of_n_vctrs_copied  > in_n_bfr.size())
+            if(distmem_bfr_size(lft_count) > in_bfr_lft.size() || distmem_bfr_size(rgt_count) > in_bfr_lft.size())
             {
               n_t new_size = lft_count > rgt_count ?
                                1.1 * lft_count : 
                                1.1 * rgt_count;
 
-              std::cerr << "Overflow of the buffer, bfr size: " << in_n_bfr.size() << " to be copied left: " << lft_count << " right: " << rgt_count << "; resizing to: " << new_size << std::endl;
-
-              in_n_bfr.resize(no_of_n_vctrs_copied * new_size);    
-              out_n_bfr.resize(no_of_n_vctrs_copied * new_size);
+              std::cerr << "Overflow of the buffer, bfr size: " << in_bfr_lft.size() << " bytes, to be copied left: " << lft_count << " right: " << rgt_count << "; resizing to: " << new_size << std::endl;
 
-              in_real_bfr.resize(no_of_real_vctrs_copied * new_size);
-              out_real_bfr.resize(no_of_real_vctrs_copied * new_size);
+              in_bfr_lft.resize(distmem_bfr_size(new_size));
+              out_bfr_lft.resize(distmem_bfr_size(new_size));
+              in_bfr_rgt.resize(distmem_bfr_size(new_size));
+              out_bfr_rgt.resize(distmem_bfr_size(new_size));
             }
 
             // open boundary -> flag out of domain SDs for removal
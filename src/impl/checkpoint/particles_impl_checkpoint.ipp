@@ -0,0 +1,225 @@
+// vim:filetype=cpp
+/** @file
+  * @copyright University of Warsaw
+  * @section LICENSE
+  * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
+  */
+
+#include <fstream>
+#include <sstream>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // zero-fill the file up to offset
+      inline void checkpoint_pad(std::ofstream &f, const std::size_t &offset)
+      {
+        const std::size_t pos = f.tellp();
+        assert(pos <= offset);
+        const std::vector<char> zeros(offset - pos, 0);
+        f.write(zeros.data(), zeros.size());
+      }
+
+      template <class vec_t>
+      void checkpoint_write(std::ofstream &f, const checkpoint_blk_t &blk, const vec_t &vec)
+      {
+        assert(blk.size == vec.size() * sizeof(typename vec_t::value_type));
+        const thrust::host_vector<typename vec_t::value_type> tmp(vec.begin(), vec.end());
+        checkpoint_pad(f, blk.offset);
+        f.write(reinterpret_cast<const char*>(tmp.data()), blk.size);
+      }
+
+      template <class vec_t>
+      void checkpoint_read(std::ifstream &f, const checkpoint_blk_t &blk, vec_t &vec)
+      {
+        if(blk.size != vec.size() * sizeof(typename vec_t::value_type))
+          throw std::runtime_error("libcloudph++: size of a data block in the checkpoint does not match the simulation setup");
+        thrust::host_vector<typename vec_t::value_type> tmp(vec.size());
+        f.seekg(blk.offset);
+        f.read(reinterpret_cast<char*>(tmp.data()), blk.size);
+        thrust::copy(tmp.begin(), tmp.end(), vec.begin());
+      }
+    };
+
+    // each MPI process reads/writes its own file
+    template <typename real_t, backend_t device>
+    std::string particles_t<real_t, device>::impl::checkpoint_path(const std::string &path)
+    {
+      return mpi_size > 1 ? path + "." + std::to_string(mpi_rank) : path;
+    }
+
+    // real_t vectors stored in a checkpoint: SD attributes, chemistry and memory of per-cell substepping
+    template <typename real_t, backend_t device>
+    std::vector<thrust_device::vector<real_t>*> particles_t<real_t, device>::impl::checkpoint_real_vctrs()
+    {
+      std::vector<thrust_device::vector<real_t>*> vctrs(distmem_real_ordered);
+      if(opts_init.chem_switch)
+      {
+        vctrs.push_back(&chem_ante_rhs);
+        vctrs.push_back(&chem_rhs);
+        vctrs.push_back(&chem_post_rhs);
+        if(allow_sstp_chem)
+          for(auto vec : {&sstp_tmp_chem_0, &sstp_tmp_chem_1, &sstp_tmp_chem_2, &sstp_tmp_chem_3, &sstp_tmp_chem_4, &sstp_tmp_chem_5})
+            vctrs.push_back(vec);
+      }
+      // per-cell substepping remembers Eulerian fields from the previous step
+      if(allow_sstp_cond && !opts_init.exact_sstp_cond)
+        for(auto vec : {&sstp_tmp_rv, &sstp_tmp_th, &sstp_tmp_rh})
+          vctrs.push_back(vec);
+      return vctrs;
+    }
+
+    // file layout: header, block table, data blocks (aligned to detail::checkpoint_align):
+    // RNG state, output_puddle, distmem_n_ordered, checkpoint_real_vctrs()
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::save_state(const std::string &path)
+    {
+      // SDs copied with MPI in the last step_async have to be in place
+      mpi_exchange_finish();
+
+      std::ostringstream rng_state;
+      rng.save(rng_state);
+      const std::string rng_str = rng_state.str();
+
+      std::vector<real_t> puddle;
+      for(auto &pair : output_puddle)
+        puddle.push_back(pair.second);
+
+      const std::vector<thrust_device::vector<real_t>*> real_vctrs = checkpoint_real_vctrs();
+
+      detail::checkpoint_hdr_t hdr{};
+      detail::checkpoint_set_magic(hdr);
+      hdr.version = detail::checkpoint_version;
+      hdr.real_size = sizeof(real_t);
+      hdr.n_size = sizeof(n_t);
+      hdr.n_blk = 2 + distmem_n_vctrs.size() + real_vctrs.size();
+      hdr.layout = distmem_layout();
+      hdr.n_part = n_part;
+      hdr.n_cell = n_cell;
+      hdr.src_stp_ctr = src_stp_ctr;
+      hdr.rlx_stp_ctr = rlx_stp_ctr;
+      hdr.rebalance_stp_ctr = rebalance_stp_ctr;
+      hdr.sstp_cond = sstp_cond;
+      hdr.sstp_coal = sstp_coal;
+      hdr.sstp_chem = sstp_chem;
+      hdr.sstp_cond_act = sstp_cond_act;
+      hdr.nx = opts_init.nx;
+      hdr.nx_bfr = mpi_n_x_bfr;
+      hdr.dt = dt;
+
+      std::vector<detail::checkpoint_blk_t> blks;
+      std::size_t offset = detail::checkpoint_aligned(sizeof(hdr) + hdr.n_blk * sizeof(detail::checkpoint_blk_t));
+      auto add_blk = [&](const std::size_t &size)
+      {
+        blks.push_back({offset, size});
+        offset = detail::checkpoint_aligned(offset + size);
+      };
+      add_blk(rng_str.size());
+      add_blk(puddle.size() * sizeof(real_t));
+      for(auto vec : distmem_n_ordered)
+        add_blk(vec->size() * sizeof(n_t));
+      for(auto vec : real_vctrs)
+        add_blk(vec->size() * sizeof(real_t));
+      assert(blks.size() == hdr.n_blk);
+
+      std::ofstream f(checkpoint_path(path), std::ios::binary | std::ios::trunc);
+      if(!f) throw std::runtime_error("libcloudph++: cannot open " + checkpoint_path(path) + " for writing");
+
+      f.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+      f.write(reinterpret_cast<const char*>(blks.data()), blks.size() * sizeof(detail::checkpoint_blk_t));
+
+      auto blk = blks.begin();
+      detail::checkpoint_pad(f, blk->offset);
+      f.write(rng_str.data(), blk->size);
+      ++blk;
+      detail::checkpoint_write(f, *blk++, puddle);
+      for(auto vec : distmem_n_ordered)
+        detail::checkpoint_write(f, *blk++, *vec);
+      for(auto vec : real_vctrs)
+        detail::checkpoint_write(f, *blk++, *vec);
+
+      if(!f) throw std::runtime_error("libcloudph++: error writing " + checkpoint_path(path));
+    }
+
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::load_state(const std::string &path)
+    {
+      // do not let a pending copy add SDs to the restored state
+      mpi_exchange_finish();
+
+      std::ifstream f(checkpoint_path(path), std::ios::binary);
+      if(!f) throw std::runtime_error("libcloudph++: cannot open " + checkpoint_path(path) + " for reading");
+
+      detail::checkpoint_hdr_t hdr;
+      f.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+      if(!f || !detail::checkpoint_check_magic(hdr))
+        throw std::runtime_error("libcloudph++: " + checkpoint_path(path) + " is not a libcloudph++ checkpoint");
+      if(hdr.version != detail::checkpoint_version)
+        throw std::runtime_error(detail::formatter() << "libcloudph++: unsupported checkpoint version " << hdr.version << " (expected " << detail::checkpoint_version << ")");
+      if(hdr.real_size != sizeof(real_t) || hdr.n_size != sizeof(n_t))
+        throw std::runtime_error("libcloudph++: checkpoint was written with a different floating point type");
+      if(hdr.layout != distmem_layout() || hdr.n_cell != n_cell)
+        throw std::runtime_error("libcloudph++: checkpoint was written with different opts_init or a different version of the library");
+      // SD positions are stored relative to the x-slab of the process
+      if(hdr.nx != opts_init.nx || hdr.nx_bfr != mpi_n_x_bfr)
+        throw std::runtime_error(detail::formatter() << "libcloudph++: " << checkpoint_path(path) << " was written for columns "
+          << hdr.nx_bfr << "-" << hdr.nx_bfr + hdr.nx - 1 << ", but this process holds columns " << mpi_n_x_bfr << "-" << mpi_n_x_bfr + opts_init.nx - 1
+          << " (after rebalancing, restart with the decomposition reported by opts_init.rebalance_hook)");
+
+      std::vector<detail::checkpoint_blk_t> blks(hdr.n_blk);
+      f.read(reinterpret_cast<char*>(blks.data()), blks.size() * sizeof(detail::checkpoint_blk_t));
+
+      // scalars
+      src_stp_ctr = hdr.src_stp_ctr;
+      rlx_stp_ctr = hdr.rlx_stp_ctr;
+      rebalance_stp_ctr = hdr.rebalance_stp_ctr;
+      sstp_cond = hdr.sstp_cond;
+      sstp_coal = hdr.sstp_coal;
+      sstp_chem = hdr.sstp_chem;
+      sstp_cond_act = hdr.sstp_cond_act;
+      dt = hdr.dt;
+
+      // SD vectors
+      n_part = hdr.n_part;
+      hskpng_resize_npart();
+      if(opts_init.chem_switch)
+        init_chem(); // resizes chem vectors to the new n_part
+
+      const std::vector<thrust_device::vector<real_t>*> real_vctrs = checkpoint_real_vctrs();
+      if(hdr.n_blk != 2 + distmem_n_vctrs.size() + real_vctrs.size())
+        throw std::runtime_error("libcloudph++: checkpoint was written with different opts_init");
+
+      auto blk = blks.begin();
+      {
+        std::string rng_str(blk->size, '\0');
+        f.seekg(blk->offset);
+        f.read(&rng_str[0], blk->size);
+        std::istringstream rng_state(rng_str);
+        rng.load(rng_state);
+        ++blk;
+      }
+      {
+        std::vector<real_t> puddle(output_puddle.size());
+        detail::checkpoint_read(f, *blk++, puddle);
+        auto it = puddle.begin();
+        for(auto &pair : output_puddle)
+          pair.second = *it++;
+      }
+      for(auto vec : distmem_n_ordered)
+        detail::checkpoint_read(f, *blk++, *vec);
+      for(auto vec : real_vctrs)
+        detail::checkpoint_read(f, *blk++, *vec);
+
+      if(!f) throw std::runtime_error("libcloudph++: error reading " + checkpoint_path(path));
+
+      // housekeeping data derived from the attributes
+      n_filtered_gp.reset();
+      ++layout_epoch;
+      hskpng_ijk();
+      hskpng_count();
+    }
+  };
+};
@@ -48,11 +48,12 @@ namespace libcloudphxx
     {   
       if (opts_init.chem_switch == false) throw std::runtime_error("libcloudph++: all chemistry was switched off");
 
+      // only the flagged SDs gathered in chem_gather are altered by chemistry
       for (int i = 0; i < chem_all; ++i)
         thrust::transform(
-          chem_bgn[i], chem_end[i], // input
-          chem_bgn[i],              // output
-          detail::cleanup<real_t>() // op
+          chem_cmp_bgn[i], chem_cmp_end[i], // input
+          chem_cmp_bgn[i],                  // output
+          detail::cleanup<real_t>()         // op
         );
     }
 
@@ -60,6 +61,7 @@ namespace libcloudphxx
     void particles_t<real_t, device>::impl::chem_post_step()
     {   
       if (opts_init.chem_switch == false) throw std::runtime_error("libcloudph++: all chemistry was switched off");
+      chem_scatter();
       V_gp.reset(); // release temorary array used to store volume in chemistry
       chem_flag_gp.reset(); // release temorary array used to store chem flag
     }
@@ -0,0 +1,92 @@
+// vim:filetype=cpp
+/** @file
+  * @copyright University of Warsaw
+  * @section LICENSE
+  * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
+  */
+
+#include <thrust/copy.h>
+#include <thrust/gather.h>
+#include <thrust/scatter.h>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    // gathers the chem state of SDs flagged in chem_flag_ante (together with their V, T and rhod)
+    // into dense arrays so that Henry, dissociation and oxidation do not walk through all (mostly haze) SDs;
+    // the SDs are taken in the order of sorted_id, i.e. grouped by cell (needed in chem_henry)
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::chem_gather()
+    {
+      if (opts_init.chem_switch == false) throw std::runtime_error("libcloudph++: all chemistry was switched off");
+
+      thrust_device::vector<unsigned int> &chem_flag(chem_flag_gp->get());
+      const thrust_device::vector<real_t> &V = V_gp->get();
+
+      hskpng_sort();
+
+      // ids of the flagged SDs
+      chem_cmp_id.resize(n_part);
+      n_chem = thrust::copy_if(
+        sorted_id.begin(), sorted_id.end(),                                       // input
+        thrust::make_permutation_iterator(chem_flag.begin(), sorted_id.begin()), // stencil
+        chem_cmp_id.begin(),                                                      // output
+        thrust::identity<unsigned int>()                                          // condition
+      ) - chem_cmp_id.begin();
+      chem_cmp_id.resize(n_chem);
+
+      // their cell indices, volumes and ambient conditions
+      chem_cmp_ijk.resize(n_chem);
+      chem_cmp_V.resize(n_chem);
+      chem_cmp_T.resize(n_chem);
+      chem_cmp_rhod.resize(n_chem);
+
+      thrust::gather(chem_cmp_id.begin(),  chem_cmp_id.end(),  ijk.begin(),  chem_cmp_ijk.begin());
+      thrust::gather(chem_cmp_id.begin(),  chem_cmp_id.end(),  V.begin(),    chem_cmp_V.begin());
+      thrust::gather(chem_cmp_ijk.begin(), chem_cmp_ijk.end(), T.begin(),    chem_cmp_T.begin());
+      thrust::gather(chem_cmp_ijk.begin(), chem_cmp_ijk.end(), rhod.begin(), chem_cmp_rhod.begin());
+
+      // their chem state, laid out as chem_rhs (odeint state) and the remaining species
+      chem_cmp_rhs.resize(  (chem_rhs_fin - chem_rhs_beg) * n_chem);
+      chem_cmp_other.resize((chem_all - chem_rhs_fin + chem_rhs_beg) * n_chem);
+      if (opts_init.chem_solver == chem_solver_t::rk4)
+        chem_stepper.adjust_size(chem_cmp_rhs); // never_resizer
+
+      chem_cmp_bgn.resize(chem_all);
+      chem_cmp_end.resize(chem_all);
+      for (int i = 0; i < chem_all; ++i)
+      {
+        const bool rhs = i >= chem_rhs_beg && i < chem_rhs_fin;
+        const int offset =
+          i < chem_rhs_beg
+            ? 0
+            : i < chem_rhs_fin
+              ? chem_rhs_beg
+              : chem_rhs_fin - chem_rhs_beg;
+        chem_cmp_bgn[i] = (rhs ? chem_cmp_rhs : chem_cmp_other).begin() + (i   - offset) * n_chem;
+        chem_cmp_end[i] = (rhs ? chem_cmp_rhs : chem_cmp_other).begin() + (i+1 - offset) * n_chem;
+
+        thrust::gather(chem_cmp_id.begin(), chem_cmp_id.end(), chem_bgn[i], chem_cmp_bgn[i]);
+      }
+      assert(chem_cmp_end[chem_rhs_fin-1] == chem_cmp_rhs.end());
+      assert(chem_cmp_end[chem_all-1] == chem_cmp_other.end());
+
+      chem_dissoc_iter.resize(0); // filled in chem_dissoc (if called)
+    }
+
+    // writes the chem state of the flagged SDs back
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::chem_scatter()
+    {
+      if (opts_init.chem_switch == false) throw std::runtime_error("libcloudph++: all chemistry was switched off");
+
+      for (int i = 0; i < chem_all; ++i)
+        thrust::scatter(
+          chem_cmp_bgn[i], chem_cmp_end[i], // input
+          chem_cmp_id.begin(),              // map
+          chem_bgn[i]                       // output
+        );
+    }
+  };
+};
@@ -101,11 +101,23 @@ namespace libcloudphxx
       template <typename real_t>
       struct chem_electroneutral // TODO: does it have to be a struct/functor - perhaps ordinary function would suffice?
       { // uses toms748 scheme to solve for mass of H+ after dissociation
-        // that satisfies electroneutrality
+        // that satisfies electroneutrality; in the warm_start mode the search starts
+        // from a narrow bracket around the H+ mass from the previous call, widened only
+        // if it does not contain the root
+        const bool warm_start;
+
+        // ctor
+        chem_electroneutral(const bool &warm_start) : warm_start(warm_start) {}
+
+        template <class tpl_t>
         BOOST_GPU_ENABLED
-        real_t operator()(const thrust::tuple<real_t, real_t, real_t, real_t, real_t, real_t, real_t> &tpl) const
+        void operator()(tpl_t tpl) const
         {
           using namespace common::molar_mass;
+#if !defined(__NVCC__)
+          using std::min;
+          using std::max;
+#endif
 
           const quantity<si::mass, real_t>
             m_S_IV  = thrust::get<0>(tpl) * si::kilograms,
@@ -115,27 +127,57 @@ namespace libcloudphxx
             m_S_VI  = thrust::get<4>(tpl) * si::kilograms;
           const quantity<si::volume, real_t>  V       = thrust::get<5>(tpl) * si::cubic_metres;
           const quantity<si::temperature, real_t> T   = thrust::get<6>(tpl) * si::kelvins;
+          const real_t m_H_old = thrust::get<7>(tpl);
           
           // limits for search in toms748
-          real_t m_H_rht = ((real_t(1e1  * 1e3) * si::moles / si::cubic_metres) * V * M_H<real_t>()) / si::kilograms;
-          real_t m_H_lft = ((real_t(1e-8 * 1e3) * si::moles / si::cubic_metres) * V * M_H<real_t>()) / si::kilograms;
+          const real_t m_H_rht = ((real_t(1e1  * 1e3) * si::moles / si::cubic_metres) * V * M_H<real_t>()) / si::kilograms;
+          const real_t m_H_lft = ((real_t(1e-8 * 1e3) * si::moles / si::cubic_metres) * V * M_H<real_t>()) / si::kilograms;
 
-          uintmax_t max_iter = 100;
+          const detail::chem_minfun<real_t> f(m_S_IV, m_C_IV, m_N_V, m_N_III, m_S_VI, V, T);
 
-          real_t m_H = common::detail::toms748_solve(
-	    detail::chem_minfun<real_t>(m_S_IV, m_C_IV, m_N_V, m_N_III, m_S_VI, V, T),
-            m_H_lft,
-	    m_H_rht,
+          real_t a = m_H_lft, b = m_H_rht, fa, fb;
+          unsigned int n_eval = 0; // function evaluations needed to bracket the root
+
+          if (warm_start && m_H_old > m_H_lft && m_H_old < m_H_rht)
+          {
+            // relative half-width of the bracket, squared after each failed attempt
+            // (i.e. 2, 4, 16, 256, ...) until the limits above are reached
+            real_t w = 2;
+            while (true)
+            {
+              a = max(m_H_lft, m_H_old / w);
+              b = min(m_H_rht, m_H_old * w);
+              fa = f(a);
+              fb = f(b);
+              n_eval += 2;
+              if (fa == 0 || fb == 0 || (fa > 0) != (fb > 0)) break;
+              if (a == m_H_lft && b == m_H_rht) break; // no root within the limits - left for toms748 to complain
+              w *= w;
+            }
+          }
+          else
+          {
+            fa = f(a);
+            fb = f(b);
+            n_eval = 2;
+          }
+
+          uintmax_t max_iter = 100 - n_eval;
+
+          thrust::get<7>(tpl) = common::detail::toms748_solve(
+            f,
+            a, b,
+            fa, fb,
             common::detail::eps_tolerance<float>(sizeof(float) * 8), //TODO is it big enough?
             max_iter
-	  ); 
+          ); 
+          thrust::get<8>(tpl) = n_eval + max_iter; // total number of function evaluations
 /*
           real_t ph_helper = real_t(-1.) * log10(m_H / (M_H<real_t>() / si::kilograms * si::moles) 
                              / (V / si::cubic_metres) / real_t(1000.));
           std::cerr << "  " << m_H_lft << " ... " << m_H << " ... " << m_H_rht << " -> pH  = "<< ph_helper<< std::endl;
           // TODO: asserts for K = f(m_H, m_...)
 */
-          return m_H;
         }
       };
     };
@@ -145,15 +187,9 @@ namespace libcloudphxx
     {   
       using namespace common::molar_mass; // M-prefixed
 
-      thrust_device::vector<real_t> &V = V_gp->get();
-      thrust_device::vector<unsigned int> &chem_flag(chem_flag_gp->get());
-
       if (opts_init.chem_switch == false) throw std::runtime_error("libcloudph++: all chemistry was switched off");
 
-      typedef thrust::permutation_iterator<
-        typename thrust_device::vector<real_t>::iterator,
-        typename thrust_device::vector<thrust_size_t>::iterator
-      > pi_t;
+      if (n_chem == 0) return;
 
       { // calculate H+ ions after dissociation so that drops remain electroneutral
         typedef thrust::zip_iterator<
@@ -164,24 +200,31 @@ namespace libcloudphxx
             typename thrust_device::vector<real_t>::iterator, // N_III
             typename thrust_device::vector<real_t>::iterator, // S_VI
             typename thrust_device::vector<real_t>::iterator, // V
-            pi_t  // T
+            typename thrust_device::vector<real_t>::iterator, // T
+            typename thrust_device::vector<real_t>::iterator, // H (previous value in, new value out)
+            typename thrust_device::vector<unsigned int>::iterator // number of iterations
           >
         > zip_it_t;
 
-        thrust::transform_if(
+        chem_dissoc_iter.resize(n_chem);
+
+        // only for the flagged SDs gathered in chem_gather
+        thrust::for_each(
           zip_it_t(thrust::make_tuple(
-            chem_bgn[SO2], chem_bgn[CO2], chem_bgn[HNO3], chem_bgn[NH3], chem_bgn[S_VI], 
-            V.begin(),
-            thrust::make_permutation_iterator(T.begin(), ijk.begin()))),                   // input - begin
+            chem_cmp_bgn[SO2], chem_cmp_bgn[CO2], chem_cmp_bgn[HNO3], chem_cmp_bgn[NH3], chem_cmp_bgn[S_VI], 
+            chem_cmp_V.begin(),
+            chem_cmp_T.begin(),
+            chem_cmp_bgn[H],
+            chem_dissoc_iter.begin()
+          )),
           zip_it_t(thrust::make_tuple(
-            chem_end[SO2], chem_end[CO2], chem_end[HNO3], chem_end[NH3], chem_end[S_VI], 
-            V.end(),
-            thrust::make_permutation_iterator(T.end(), ijk.end()))),                       // input - end
-         chem_flag.begin(),                                                                // stencil
-         chem_bgn[H],                                                                      // output
-         detail::chem_electroneutral<real_t>(),                                            // op
-        //  cuda::std::identity()
-         thrust::identity<unsigned int>()
+            chem_cmp_end[SO2], chem_cmp_end[CO2], chem_cmp_end[HNO3], chem_cmp_end[NH3], chem_cmp_end[S_VI], 
+            chem_cmp_V.end(),
+            chem_cmp_T.end(),
+            chem_cmp_end[H],
+            chem_dissoc_iter.end()
+          )),
+          detail::chem_electroneutral<real_t>(opts_init.chem_dissoc_warm_start)
         );
       }
 
@@ -189,7 +232,7 @@ namespace libcloudphxx
       using boost::math::isfinite;
 #endif
       for (int i = 0; i < chem_gas_n; ++i){
-        assert(isfinite(*thrust::min_element(chem_bgn[i], chem_end[i])));
+        assert(isfinite(*thrust::min_element(chem_cmp_bgn[i], chem_cmp_end[i])));
       }
     }
   };  
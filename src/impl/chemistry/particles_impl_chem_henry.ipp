@@ -7,6 +7,7 @@
 #include <libcloudph++/common/molar_mass.hpp>
 #include <libcloudph++/common/henry.hpp>
 #include <libcloudph++/common/dissoc.hpp>
+#include <thrust/iterator/counting_iterator.h>
 
 namespace libcloudphxx
 {
@@ -14,17 +15,6 @@ namespace libcloudphxx
   {
     namespace detail
     {
-      template <typename real_t>
-      struct chem_summator
-      { // calculate the mass of chem compounds (multiplicity * mass)  
-        template <typename tup_t>
-        BOOST_GPU_ENABLED
-        real_t operator()(const tup_t &tpl) const
-        {
-          return thrust::get<0>(tpl) * thrust::get<1>(tpl);
-        }
-      };
-
       template <typename real_t>
       struct ambient_chem_calculator
       { // calculate the change in trace gases due to Henrys law
@@ -32,6 +22,7 @@ namespace libcloudphxx
         const real_t M_aq;  //quantity<common::mass_over_amount, real_t> 
  
         // ctor
+        BOOST_GPU_ENABLED
         ambient_chem_calculator(
           const real_t &M_aq,
           const real_t &M_gas
@@ -238,6 +229,123 @@ namespace libcloudphxx
           return mass_helper;// > 0 ? mass_helper : 0;
         }
       };
+
+      template <typename real_t>
+      struct chem_Henry_all
+      { // Henrys law for all trace gases in one pass over the flagged SDs;
+        // stores multiplicity * change in mass of each species (chem_gas_n blocks of n_chem values in dm)
+        real_t H[chem_gas_n], dHR[chem_gas_n], M_gas[chem_gas_n], M_aq[chem_gas_n], D[chem_gas_n], acc_coeff[chem_gas_n];
+        const real_t dt;
+        real_t *m[chem_gas_n];       // chem species in the flagged SDs
+        const real_t *c[chem_gas_n]; // ambient trace gas mixing ratios (per cell)
+        real_t *dm;
+        const thrust_size_t n_chem;
+
+        // ctor
+        chem_Henry_all(
+          const real_t H_[chem_gas_n],
+          const real_t dHR_[chem_gas_n],
+          const real_t M_gas_[chem_gas_n],
+          const real_t M_aq_[chem_gas_n],
+          const real_t D_[chem_gas_n],
+          const real_t ac_[chem_gas_n],
+          const real_t &dt,
+          real_t *const m_[chem_gas_n],
+          const real_t *const c_[chem_gas_n],
+          real_t *dm,
+          const thrust_size_t &n_chem
+        ) :
+          dt(dt), dm(dm), n_chem(n_chem)
+        {
+          for (int i = 0; i < chem_gas_n; ++i)
+          {
+            H[i] = H_[i]; dHR[i] = dHR_[i]; M_gas[i] = M_gas_[i]; M_aq[i] = M_aq_[i]; D[i] = D_[i]; acc_coeff[i] = ac_[i];
+            m[i] = m_[i]; c[i] = c_[i];
+          }
+        }
+
+        template <class tpl_t>
+        BOOST_GPU_ENABLED
+        void operator()(tpl_t tpl) const
+        {
+          const real_t V    = thrust::get<0>(tpl);
+          const real_t T    = thrust::get<1>(tpl);
+          const real_t rhod = thrust::get<2>(tpl);
+          const real_t m_H  = thrust::get<3>(tpl);
+          const real_t rw2  = thrust::get<4>(tpl);
+          const real_t p    = thrust::get<5>(tpl);
+          const real_t n    = thrust::get<6>(tpl);
+          const thrust_size_t ijk = thrust::get<7>(tpl);
+          const thrust_size_t k   = thrust::get<8>(tpl);
+
+          for (int i = 0; i < chem_gas_n; ++i)
+          {
+            const real_t m_old = m[i][k];
+            const real_t m_new = chem_Henry_fun<real_t>(i, H[i], dHR[i], M_gas[i], M_aq[i], D[i], acc_coeff[i], dt)(
+              V, thrust::make_tuple(p, T, c[i][ijk], m_old, rw2, rhod, m_H)
+            );
+            m[i][k] = m_new;
+            dm[i * n_chem + k] = n * (m_new - m_old);
+          }
+        }
+      };
+
+      template <typename real_t>
+      struct chem_dm_plus
+      { // sums the chem_gas_n changes of mass (in reduce_by_key)
+        typedef thrust::tuple<real_t, real_t, real_t, real_t, real_t, real_t> tpl_t;
+
+        BOOST_GPU_ENABLED
+        tpl_t operator()(const tpl_t &a, const tpl_t &b) const
+        {
+          return thrust::make_tuple(
+            thrust::get<0>(a) + thrust::get<0>(b),
+            thrust::get<1>(a) + thrust::get<1>(b),
+            thrust::get<2>(a) + thrust::get<2>(b),
+            thrust::get<3>(a) + thrust::get<3>(b),
+            thrust::get<4>(a) + thrust::get<4>(b),
+            thrust::get<5>(a) + thrust::get<5>(b)
+          );
+        }
+      };
+
+      template <typename real_t>
+      struct ambient_chem_henry_all
+      { // applies the per-cell changes of mass of all species in the droplets to the trace gases
+        real_t M_gas[chem_gas_n], M_aq[chem_gas_n];
+        real_t *c[chem_gas_n];        // ambient trace gas mixing ratios (per cell)
+        const real_t *dm[chem_gas_n]; // change in the mass in droplets (per cell with flagged SDs)
+
+        // ctor
+        ambient_chem_henry_all(
+          const real_t M_gas_[chem_gas_n],
+          const real_t M_aq_[chem_gas_n],
+          real_t *const c_[chem_gas_n],
+          const real_t *const dm_[chem_gas_n]
+        )
+        {
+          for (int i = 0; i < chem_gas_n; ++i)
+          {
+            M_gas[i] = M_gas_[i]; M_aq[i] = M_aq_[i];
+            c[i] = c_[i]; dm[i] = dm_[i];
+          }
+        }
+
+        template <class tpl_t>
+        BOOST_GPU_ENABLED
+        void operator()(tpl_t tpl) const
+        {
+          const thrust_size_t ijk = thrust::get<0>(tpl);
+          const real_t rhod = thrust::get<1>(tpl);
+          const real_t dv   = thrust::get<2>(tpl);
+          const thrust_size_t k = thrust::get<3>(tpl);
+
+          for (int i = 0; i < chem_gas_n; ++i)
+            c[i][ijk] = ambient_chem_calculator<real_t>(M_aq[i], M_gas[i])(
+              dm[i][k], thrust::make_tuple(real_t(0), rhod, dv, c[i][ijk])
+            );
+        }
+      };
     };
 
     template <typename real_t, backend_t device>
@@ -249,11 +357,10 @@ namespace libcloudphxx
       using namespace common::molar_mass; // M-prefixed
       using namespace common::dissoc;     // K-prefixed
 
-      thrust_device::vector<unsigned int> &chem_flag(chem_flag_gp->get());
-      const thrust_device::vector<real_t> &V = V_gp->get();
-
       if (opts_init.chem_switch == false) throw std::runtime_error("libcloudph++: all chemistry was switched off");
 
+      if (n_chem == 0) return; // no droplets to dissolve gases in
+
       // gas absorption
       assert(
         HNO3 == 0 && NH3  == 1 && CO2 == 2 &&
@@ -315,109 +422,107 @@ namespace libcloudphxx
         ac_O3<real_t>()
       };
 
-      // helpers for sorting out droplets
-      typedef thrust::permutation_iterator<
-        typename thrust_device::vector<n_t>::iterator,
-        typename thrust_device::vector<thrust_size_t>::iterator
-      > pi_n_t;
-      typedef thrust::permutation_iterator<
-        typename thrust_device::vector<real_t>::iterator,
-        typename thrust_device::vector<thrust_size_t>::iterator
-      > pi_chem_t;
-      typedef thrust::zip_iterator<thrust::tuple<pi_n_t, pi_chem_t> > zip_it_t;
-
       //closed chemical system - reduce mixing ratio due to Henrys law
-      hskpng_sort();
-
-      // temporarily needed to store old mass per cell 
-      auto mass_old_g = tmp_device_real_cell.get_guard();
-      auto mass_new_g = tmp_device_real_cell.get_guard();
-      thrust_device::vector<real_t> &mass_old(mass_old_g.get());
-      thrust_device::vector<real_t> &mass_new(mass_new_g.get());
+      // (one pass over the flagged SDs gathered in chem_gather, which are grouped by cell,
+      //  one reduction of the changes in mass for all species and one pass over the cells)
+      chem_cmp_dm.resize(chem_gas_n * n_chem);
 
+      real_t *m_[chem_gas_n];
+      real_t *c_[chem_gas_n];
       for (int i = 0; i < chem_gas_n; ++i)
       {
-        // store the total mass of chem species in cloud droplets per cell
-        thrust::reduce_by_key(
-          sorted_ijk.begin(), sorted_ijk.end(),
-          thrust::transform_iterator<             
-            detail::chem_summator<real_t>,
-            zip_it_t,
-            real_t
-          >(
-            zip_it_t(thrust::make_tuple(
-              pi_n_t(n.begin(), sorted_id.begin()),
-              pi_chem_t(chem_bgn[i], sorted_id.begin())
-            )),
-            detail::chem_summator<real_t>() 
-          ),
-          count_ijk.begin(),
-          mass_old.begin()
-        );
-
-        // apply Henrys law to the in-drop chemical compounds 
-        thrust::transform_if(
-          V.begin(), V.end(),                             // input - 1st arg
-          thrust::make_zip_iterator(thrust::make_tuple(   // input - 2nd arg
-            thrust::make_permutation_iterator(p.begin(), ijk.begin()),
-            thrust::make_permutation_iterator(T.begin(), ijk.begin()),
-            thrust::make_permutation_iterator(ambient_chem[(chem_species_t)i].begin(), ijk.begin()),
-            chem_bgn[i],
-            rw2.begin(),
-            thrust::make_permutation_iterator(rhod.begin(), ijk.begin()),
-            chem_bgn[H]
-          )),
-          chem_flag.begin(),                                                                         //stencil
-          chem_bgn[i],                                                                               // output
-          detail::chem_Henry_fun<real_t>(i, H_[i], dHR_[i], M_gas_[i], M_aq_[i], D_[i], ac_[i], dt), // op
-          thrust::identity<unsigned int>()
-          // cuda::std::identity()
-        );
+        m_[i] = thrust::raw_pointer_cast(&*chem_cmp_bgn[i]);
+        c_[i] = thrust::raw_pointer_cast(ambient_chem[(chem_species_t)i].data());
+      }
+
+      // apply Henrys law to the in-drop chemical compounds 
+      thrust::for_each(
+        thrust::make_zip_iterator(thrust::make_tuple(
+          chem_cmp_V.begin(),
+          chem_cmp_T.begin(),
+          chem_cmp_rhod.begin(),
+          chem_cmp_bgn[H],
+          thrust::make_permutation_iterator(rw2.begin(), chem_cmp_id.begin()),
+          thrust::make_permutation_iterator(p.begin(), chem_cmp_ijk.begin()),
+          thrust::make_permutation_iterator(n.begin(), chem_cmp_id.begin()),
+          chem_cmp_ijk.begin(),
+          thrust::make_counting_iterator<thrust_size_t>(0)
+        )),
+        thrust::make_zip_iterator(thrust::make_tuple(
+          chem_cmp_V.end(),
+          chem_cmp_T.end(),
+          chem_cmp_rhod.end(),
+          chem_cmp_end[H],
+          thrust::make_permutation_iterator(rw2.begin(), chem_cmp_id.end()),
+          thrust::make_permutation_iterator(p.begin(), chem_cmp_ijk.end()),
+          thrust::make_permutation_iterator(n.begin(), chem_cmp_id.end()),
+          chem_cmp_ijk.end(),
+          thrust::make_counting_iterator<thrust_size_t>(n_chem)
+        )),
+        detail::chem_Henry_all<real_t>(H_, dHR_, M_gas_, M_aq_, D_, ac_, dt, m_, c_, thrust::raw_pointer_cast(chem_cmp_dm.data()), n_chem)
+      );
 
 #if !defined(__NVCC__)
-        using boost::math::isfinite;
+      using boost::math::isfinite;
 #endif
-        //debug::print(chem_bgn[i], chem_end[i]);
-        assert(isfinite(*thrust::min_element(chem_bgn[i], chem_end[i])));
-        nancheck_range(chem_bgn[i], chem_end[i], "chem after Henrys law in chem_henry");
-
-        // store the total mass of chem species in cloud droplets per cell after Henry
-        thrust::pair<
-          typename thrust_device::vector<thrust_size_t>::iterator,
-          typename thrust_device::vector<real_t>::iterator
-        > it_pair =
-        thrust::reduce_by_key(
-          sorted_ijk.begin(), sorted_ijk.end(),
-          thrust::transform_iterator<             // input - values
-            detail::chem_summator<real_t>,
-            zip_it_t,
-            real_t
-          >(
-            zip_it_t(thrust::make_tuple(
-              pi_n_t(n.begin(), sorted_id.begin()),
-              pi_chem_t(chem_bgn[i], sorted_id.begin())
-            )),
-            detail::chem_summator<real_t>()      // op
-          ),
-          count_ijk.begin(),
-          mass_new.begin()
-        );
-        count_n = it_pair.first - count_ijk.begin();
-        assert(count_n > 0 && count_n <= n_cell);
-
-        // apply the change to the mixing ratios of trace gases
-        thrust::transform(
-          mass_new.begin(), mass_new.begin() + count_n,                              // input - 1st arg
-          thrust::make_zip_iterator(thrust::make_tuple(                              // input - 2nd arg
-            mass_old.begin(),
-            thrust::make_permutation_iterator(rhod.begin(), count_ijk.begin()), 
-            thrust::make_permutation_iterator(dv.begin(), count_ijk.begin()),
-            thrust::make_permutation_iterator(ambient_chem[(chem_species_t)i].begin(), count_ijk.begin())
-          )),
-          thrust::make_permutation_iterator(ambient_chem[(chem_species_t)i].begin(), count_ijk.begin()), // output 
-          detail::ambient_chem_calculator<real_t>(M_aq_[i], M_gas_[i])                                   // op
-        );
+      for (int i = 0; i < chem_gas_n; ++i)
+      {
+        //debug::print(chem_cmp_bgn[i], chem_cmp_end[i]);
+        assert(isfinite(*thrust::min_element(chem_cmp_bgn[i], chem_cmp_end[i])));
+        nancheck_range(chem_cmp_bgn[i], chem_cmp_end[i], "chem after Henrys law in chem_henry");
+      }
 
+      // total change in the mass of chem species in cloud droplets per cell
+      auto cell_g = tmp_device_size_cell.get_guard();
+      thrust_device::vector<thrust_size_t> &cell(cell_g.get());
+      chem_cell_dm.resize(chem_gas_n * n_cell);
+      typename thrust_device::vector<real_t>::iterator dm_cell[chem_gas_n];
+      for (int i = 0; i < chem_gas_n; ++i)
+        dm_cell[i] = chem_cell_dm.begin() + i * n_cell;
+
+      const thrust_size_t n_cell_chem = thrust::reduce_by_key(
+        chem_cmp_ijk.begin(), chem_cmp_ijk.end(),       // input - keys
+        thrust::make_zip_iterator(thrust::make_tuple(   // input - values
+          chem_cmp_dm.begin() + 0 * n_chem,
+          chem_cmp_dm.begin() + 1 * n_chem,
+          chem_cmp_dm.begin() + 2 * n_chem,
+          chem_cmp_dm.begin() + 3 * n_chem,
+          chem_cmp_dm.begin() + 4 * n_chem,
+          chem_cmp_dm.begin() + 5 * n_chem
+        )),
+        cell.begin(),                                   // output - keys
+        thrust::make_zip_iterator(thrust::make_tuple(   // output - values
+          dm_cell[0], dm_cell[1], dm_cell[2],
+          dm_cell[3], dm_cell[4], dm_cell[5]
+        )),
+        thrust::equal_to<thrust_size_t>(),              // key comparison
+        detail::chem_dm_plus<real_t>()                  // reduction type
+      ).first - cell.begin();
+      assert(n_cell_chem > 0 && n_cell_chem <= n_cell);
+
+      // apply the change to the mixing ratios of trace gases
+      const real_t *dm_[chem_gas_n];
+      for (int i = 0; i < chem_gas_n; ++i)
+        dm_[i] = thrust::raw_pointer_cast(&*dm_cell[i]);
+
+      thrust::for_each(
+        thrust::make_zip_iterator(thrust::make_tuple(
+          cell.begin(),
+          thrust::make_permutation_iterator(rhod.begin(), cell.begin()), 
+          thrust::make_permutation_iterator(dv.begin(), cell.begin()),
+          thrust::make_counting_iterator<thrust_size_t>(0)
+        )),
+        thrust::make_zip_iterator(thrust::make_tuple(
+          cell.begin() + n_cell_chem,
+          thrust::make_permutation_iterator(rhod.begin(), cell.begin() + n_cell_chem), 
+          thrust::make_permutation_iterator(dv.begin(), cell.begin() + n_cell_chem),
+          thrust::make_counting_iterator<thrust_size_t>(n_cell_chem)
+        )),
+        detail::ambient_chem_henry_all<real_t>(M_gas_, M_aq_, c_, dm_)
+      );
+
+      for (int i = 0; i < chem_gas_n; ++i)
+      {
         assert(*thrust::min_element(
           ambient_chem[(chem_species_t)i].begin(), ambient_chem[(chem_species_t)i].end()
         ) >= 0);
@@ -116,32 +116,187 @@ namespace libcloudphxx
         }
       };
 
+      // solution of a 3x3 linear system (Cramer's rule)
+      template <typename real_t>
+      BOOST_GPU_ENABLED
+      void solve3(const real_t A[3][3], const real_t b[3], real_t x[3])
+      {
+        const real_t det = 
+          A[0][0] * (A[1][1] * A[2][2] - A[1][2] * A[2][1]) -
+          A[0][1] * (A[1][0] * A[2][2] - A[1][2] * A[2][0]) +
+          A[0][2] * (A[1][0] * A[2][1] - A[1][1] * A[2][0]);
+        x[0] = (
+          b[0]    * (A[1][1] * A[2][2] - A[1][2] * A[2][1]) -
+          A[0][1] * (b[1]    * A[2][2] - A[1][2] * b[2]   ) +
+          A[0][2] * (b[1]    * A[2][1] - A[1][1] * b[2]   )
+        ) / det;
+        x[1] = (
+          A[0][0] * (b[1]    * A[2][2] - A[1][2] * b[2]   ) -
+          b[0]    * (A[1][0] * A[2][2] - A[1][2] * A[2][0]) +
+          A[0][2] * (A[1][0] * b[2]    - b[1]    * A[2][0])
+        ) / det;
+        x[2] = (
+          A[0][0] * (A[1][1] * b[2]    - b[1]    * A[2][1]) -
+          A[0][1] * (A[1][0] * b[2]    - b[1]    * A[2][0]) +
+          b[0]    * (A[1][0] * A[2][1] - A[1][1] * A[2][0])
+        ) / det;
+      }
+
+      template <typename real_t>
+      struct chem_react_ros2
+      { // integrates the oxidation of S(IV) by O3 and H2O2 over dt in each SD independently
+        // using the 2nd order Rosenbrock scheme (ROS2, Verwer et al. 1999) with an adaptive step;
+        // as in chem_rhs, the H+ mass is kept constant during the oxidation
+        const real_t dt, eps;
+
+        // ctor
+        chem_react_ros2(const real_t &dt, const real_t &eps) : 
+          dt(dt), eps(eps)
+        {}
+
+        // amounts y = {S_IV, O3, H2O2} [mol] react as dS_IV/dt = -(k_O3 O3 + k_H2O2 H2O2) S_IV, dO3/dt = -k_O3 O3 S_IV, dH2O2/dt = -k_H2O2 H2O2 S_IV
+        BOOST_GPU_ENABLED
+        void rhs(const real_t y[3], const real_t &k_O3, const real_t &k_H2O2, real_t f[3]) const
+        {
+          f[1] = -(k_O3   * y[0]) * y[1];
+          f[2] = -(k_H2O2 * y[0]) * y[2];
+          f[0] = f[1] + f[2];
+        }
+
+        // tpl: V, T, m_H (input), m_S_IV, m_S_VI, m_H2O2, m_O3 (input and output)
+        template <class tpl_t>
+        BOOST_GPU_ENABLED
+        void operator()(tpl_t tpl) const
+        {
+#if !defined(__NVCC__)
+          using std::min;
+          using std::max;
+          using std::abs;
+          using std::sqrt;
+#endif
+          using namespace common::molar_mass;
+          using namespace common::dissoc;
+          using namespace common::react;
+
+          const quantity<si::volume, real_t>      V = thrust::get<0>(tpl) * si::cubic_metres; 
+          const quantity<si::temperature, real_t> T = thrust::get<1>(tpl) * si::kelvins;
+
+          // helper for H+ concentration
+          quantity<common::amount_over_volume, real_t> conc_H;
+          conc_H = thrust::get<2>(tpl) * si::kilograms / M_H<real_t>() / V;
+
+          //helpers for dissociation (temperature dependance)
+          quantity<common::amount_over_volume, real_t> Kt_SO2, Kt_HSO3;
+          Kt_SO2  = K_temp(T, K_SO2<real_t>(),  dKR_SO2<real_t>());
+          Kt_HSO3 = K_temp(T, K_HSO3<real_t>(), dKR_HSO3<real_t>());
+
+          // helpers for reactions (temperature dependance)
+          quantity<common::volume_over_amount_over_time, real_t> R_O3_k0, R_O3_k1, R_O3_k2;
+          quantity<common::volume_square_over_amount_square_over_time, real_t> R_H2O2_k;
+          R_O3_k0  = R_temp_O3(T, R_S_O3_k0<real_t>(),  dER_O3_k0<real_t>());
+          R_O3_k1  = R_temp_O3(T, R_S_O3_k1<real_t>(),  dER_O3_k1<real_t>());
+          R_O3_k2  = R_temp_O3(T, R_S_O3_k2<real_t>(),  dER_O3_k2<real_t>());
+          R_H2O2_k = R_temp_H2O2(T, R_S_H2O2_k<real_t>(), dER_H2O2_k<real_t>()); 
+
+          const quantity<si::dimensionless, real_t> S_IV_frac = real_t(1) + Kt_SO2 / conc_H + Kt_SO2 * Kt_HSO3 / conc_H / conc_H;
+
+          // rate coefficients [1/mol/s], same as in chem_rhs_helper
+          const real_t
+            k_O3 = (R_O3_k0 + R_O3_k1 * Kt_SO2 / conc_H + R_O3_k2 * Kt_SO2 * Kt_HSO3 / conc_H / conc_H) 
+                   / S_IV_frac / V * si::moles * si::seconds,
+            k_H2O2 = R_H2O2_k * Kt_SO2 / S_IV_frac / (real_t(1) + R_S_H2O2_K<real_t>() * conc_H) 
+                   / V * si::moles * si::seconds;
+
+          // molar masses [kg/mol]
+          const real_t 
+            M_S_IV  = M_SO2_H2O<real_t>() * si::moles / si::kilograms,
+            M_S_VI  = M_H2SO4<real_t>()   * si::moles / si::kilograms,
+            M_H2O2_ = M_H2O2<real_t>()    * si::moles / si::kilograms,
+            M_O3_   = M_O3<real_t>()      * si::moles / si::kilograms;
+
+          real_t y[3] = {
+            thrust::get<3>(tpl) / M_S_IV,
+            thrust::get<6>(tpl) / M_O3_,
+            thrust::get<5>(tpl) / M_H2O2_
+          };
+          const real_t S_IV_0 = y[0];
+
+          // nothing to oxidise or no oxidants
+          if (!(y[0] > 0) || !(y[1] > 0 || y[2] > 0)) return;
+
+          // absolute tolerance for amounts approaching zero
+          const real_t y_min = eps * real_t(1e-6) * (y[0] + y[1] + y[2]);
+
+          const real_t gamma = real_t(1) + real_t(1) / sqrt(real_t(2));
+          const int max_steps = 1000;
+
+          real_t t = 0, h = dt;
+          for (int step = 0; step < max_steps && t < dt; ++step)
+          {
+            // the last allowed step goes to the end of the interval regardless of the error
+            const bool last = step == max_steps - 1;
+            h = last ? dt - t : min(h, dt - t);
+
+            real_t f0[3], f1[3], k1[3], k2[3], y1[3], r[3];
+
+            // W = I - gamma * h * J
+            const real_t W[3][3] = {
+              { real_t(1) + gamma * h * (k_O3 * y[1] + k_H2O2 * y[2]), gamma * h * k_O3 * y[0], gamma * h * k_H2O2 * y[0] },
+              { gamma * h * k_O3 * y[1],   real_t(1) + gamma * h * k_O3 * y[0],   real_t(0)                               },
+              { gamma * h * k_H2O2 * y[2], real_t(0),                             real_t(1) + gamma * h * k_H2O2 * y[0]   }
+            };
+
+            rhs(y, k_O3, k_H2O2, f0);
+            solve3(W, f0, k1);
+            for (int i = 0; i < 3; ++i) y1[i] = y[i] + h * k1[i];
+            rhs(y1, k_O3, k_H2O2, f1);
+            for (int i = 0; i < 3; ++i) r[i] = f1[i] - real_t(2) * k1[i];
+            solve3(W, r, k2);
+
+            // error estimated with the embedded 1st order solution y1
+            real_t err = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+              const real_t y_new = y[i] + h * (real_t(1.5) * k1[i] + real_t(.5) * k2[i]);
+              err = max(err, abs(real_t(.5) * h * (k1[i] + k2[i])) / (eps * max(abs(y[i]), abs(y_new)) + y_min));
+            }
+
+            if (err <= 1 || last)
+            {
+              for (int i = 0; i < 3; ++i) 
+                y[i] = max(real_t(0), y[i] + h * (real_t(1.5) * k1[i] + real_t(.5) * k2[i]));
+              t += h;
+            }
+
+            // step size control
+            h *= min(real_t(5), max(real_t(.2), real_t(.8) / sqrt(max(err, real_t(1e-10)))));
+          }
+
+          thrust::get<3>(tpl) = y[0] * M_S_IV;
+          thrust::get<4>(tpl) += (S_IV_0 - y[0]) * M_S_VI;
+          thrust::get<5>(tpl) = y[2] * M_H2O2_;
+          thrust::get<6>(tpl) = y[1] * M_O3_;
+        }
+      };
+
       // functor called by odeint
       template <typename real_t>
       struct chem_rhs
       { 
+        // operates on the dense arrays of SDs gathered in chem_gather
         const real_t dt;
-        const thrust_device::vector<real_t> &V;
-        const thrust_device::vector<unsigned int> &chem_flag;
- 
-        typedef thrust::permutation_iterator<
-          typename thrust_device::vector<real_t>::iterator,
-          typename thrust_device::vector<thrust_size_t>::iterator
-        > pi_t;
-        const pi_t &T;
-       
-        const typename thrust_device::vector<real_t>::const_iterator &m_H; 
+        const thrust_device::vector<real_t> &V, &T;
+        const typename thrust_device::vector<real_t>::const_iterator m_H; 
         const int n_part;
 
         // ctor
         chem_rhs(
           const real_t dt,
           const thrust_device::vector<real_t> &V,
-          const pi_t &T,
-          const typename thrust_device::vector<real_t>::const_iterator &m_H,
-          const thrust_device::vector<unsigned int> &chem_flag
+          const thrust_device::vector<real_t> &T,
+          const typename thrust_device::vector<real_t>::const_iterator &m_H
         ) :
-          dt(dt), V(V), T(T), m_H(m_H), n_part(V.size()), chem_flag(chem_flag)
+          dt(dt), V(V), T(T), m_H(m_H), n_part(V.size())
         {}
 
         void operator()(
@@ -155,7 +310,7 @@ namespace libcloudphxx
 
           typedef thrust::zip_iterator<
             thrust::tuple<
-              pi_t, // T
+              typename thrust_device::vector<real_t>::const_iterator, // T
               // those in psi...
               typename thrust_device::vector<real_t>::const_iterator, // S_IV
               typename thrust_device::vector<real_t>::const_iterator, // S_VI
@@ -174,32 +329,22 @@ namespace libcloudphxx
               case H2O2:
               case O3:
               case SO2:
-                thrust::transform_if(
+                thrust::transform(
                   // input - 1st arg
                   V.begin(), V.end(),                
                   // input - 2nd arg
 	          zip_it_t(thrust::make_tuple(
-                    T,
+                    T.begin(),
                     psi.begin() + (SO2  - chem_rhs_beg) * n_part, 
                     psi.begin() + (S_VI - chem_rhs_beg) * n_part, 
                     psi.begin() + (H2O2 - chem_rhs_beg) * n_part, 
                     psi.begin() + (O3   - chem_rhs_beg) * n_part,
                     m_H
                   )), 
-                  // chemical reactions are only done for selected droplets 
-                  // (with wet radius significantly bigger than dry radius)
-                  // to avoid problems in activation when dry radius (due to chemistry) 
-                  // is bigger than predicted wet radius in condensation
-                  // 
-                  // stencil 
-                  chem_flag.begin(),
                   // output
                   dot_psi.begin() + (chem_iter - chem_rhs_beg) * n_part, 
                   // op
-                  chem_rhs_helper<real_t>(chem_iter, dt),
-                  // condition
-                  // cuda::std::identity()
-                  thrust::identity<unsigned int>()
+                  chem_rhs_helper<real_t>(chem_iter, dt)
                 );
 
 #if !defined(__NVCC__)
@@ -260,66 +405,88 @@ namespace libcloudphxx
     {   
       using namespace common::molar_mass; // M-prefixed
 
-      thrust_device::vector<real_t> &V = V_gp->get();
-      thrust_device::vector<unsigned int> &chem_flag(chem_flag_gp->get());
-
       //non-equilibrium chemical reactions (oxidation)
       if (opts_init.chem_switch == false) throw std::runtime_error("libcloudph++: all chemistry was switched off");
 
+      // chemical reactions are only done for selected droplets (gathered in chem_gather)
+      // (with wet radius significantly bigger than dry radius)
+      // to avoid problems in activation when dry radius (due to chemistry) 
+      // is bigger than predicted wet radius in condensation
+      if (n_chem == 0) return;
+
       auto old_S_VI_g = tmp_device_real_part.get_guard();
       thrust_device::vector<real_t> &old_S_VI = old_S_VI_g.get();
 
       // copy old H2SO4 values to allow dry radii recalculation
       thrust::copy(
-        chem_bgn[S_VI], chem_end[S_VI], // from
-        old_S_VI.begin()                // to
+        chem_cmp_bgn[S_VI], chem_cmp_end[S_VI], // from
+        old_S_VI.begin()                        // to
       );
 
       // do chemical reactions
-      chem_stepper.do_step(
-        detail::chem_rhs<real_t>(
-          dt,
-          V,
-          thrust::make_permutation_iterator(T.begin(), ijk.begin()), 
-          chem_bgn[H], 
-          chem_flag
-        ), // TODO: make it an impl member field
-        chem_rhs, 
-        real_t(0),
-        dt
-      );
+      switch (opts_init.chem_solver)
+      {
+        case chem_solver_t::rk4:
+          chem_stepper.do_step(
+            detail::chem_rhs<real_t>(
+              dt,
+              chem_cmp_V,
+              chem_cmp_T,
+              chem_cmp_bgn[H]
+            ), // TODO: make it an impl member field
+            chem_cmp_rhs, 
+            real_t(0),
+            dt
+          );
+          break;
+        case chem_solver_t::ros2:
+          thrust::for_each(
+            thrust::make_zip_iterator(thrust::make_tuple(
+              chem_cmp_V.begin(), chem_cmp_T.begin(), chem_cmp_bgn[H],
+              chem_cmp_bgn[SO2], chem_cmp_bgn[S_VI], chem_cmp_bgn[H2O2], chem_cmp_bgn[O3]
+            )),
+            thrust::make_zip_iterator(thrust::make_tuple(
+              chem_cmp_V.end(), chem_cmp_T.end(), chem_cmp_end[H],
+              chem_cmp_end[SO2], chem_cmp_end[S_VI], chem_cmp_end[H2O2], chem_cmp_end[O3]
+            )),
+            detail::chem_react_ros2<real_t>(dt, opts_init.chem_ros2_eps)
+          );
+          break;
+        default:
+          assert(false);
+      }
 
       assert(opts_init.chem_rho != 0);
 
       // recompute dry radii
       // TODO: using namespace for S_VI
+      typedef thrust::permutation_iterator<
+        typename thrust_device::vector<real_t>::iterator,
+        typename thrust_device::vector<thrust_size_t>::iterator
+      > pi_t;
       typedef thrust::zip_iterator<
         thrust::tuple<
           typename thrust_device::vector<real_t>::iterator, // old S_VI 
           typename thrust_device::vector<real_t>::iterator, // new_S_VI
-          typename thrust_device::vector<real_t>::iterator  // rd3
+          pi_t                                              // rd3
         >
       > zip_it_t;
 
       zip_it_t 
-        arg_begin(thrust::make_tuple(old_S_VI.begin(), chem_bgn[S_VI], rd3.begin())),
-        arg_end(  thrust::make_tuple(old_S_VI.end(),   chem_end[S_VI], rd3.end()));
+        arg_begin(thrust::make_tuple(old_S_VI.begin(), chem_cmp_bgn[S_VI], pi_t(rd3.begin(), chem_cmp_id.begin())));
  
-      // do oxidation reaction only for droplets that are "big enough" (marked by chem_flag) 
-      thrust::transform_if(
-        arg_begin, arg_end,                                //input first arg 
-        chem_flag.begin(),                                 //stencil
-        rd3.begin(),                                       //output
-        detail::chem_new_rd3<real_t>(opts_init.chem_rho),  //op
-        // cuda::std::identity()                   //condition
-        thrust::identity<unsigned int>()
+      // do oxidation reaction only for droplets that are "big enough" (marked by chem_flag and gathered in chem_gather) 
+      thrust::transform(
+        arg_begin, arg_begin + n_chem,                     //input first arg 
+        pi_t(rd3.begin(), chem_cmp_id.begin()),            //output
+        detail::chem_new_rd3<real_t>(opts_init.chem_rho)   //op
       );
 
 #if !defined(__NVCC__)
       using boost::math::isfinite;
 #endif
       for (int i = 0; i < chem_gas_n; ++i){
-        assert(isfinite(*thrust::min_element(chem_bgn[i], chem_end[i])));
+        assert(isfinite(*thrust::min_element(chem_cmp_bgn[i], chem_cmp_end[i])));
       }
 
       assert(isfinite(*thrust::min_element(rd3.begin(), rd3.end())));
@@ -274,58 +274,65 @@ namespace libcloudphxx
     {   
       // prerequisites
       hskpng_shuffle_and_sort(); // to get random neighbours by default
-      hskpng_count();            // no. of super-droplets per cell 
-      
-      // placing scale_factors in count_mom (of size count_n!)
-      thrust::transform(
-        count_num.begin(), count_num.begin() + count_n, // input - 1st arg
-        count_mom.begin(),                              // output
-        detail::scale_factor<real_t, n_t>()
-      );
-      nancheck_range(count_mom.begin(), count_mom.begin() + count_n, "count_mom storing scale_factors");
 
-      // references to tmp data
-      auto scl_g = tmp_device_real_cell.get_guard(),
-           col_g = tmp_device_real_part.get_guard();
-      auto off_g = tmp_device_size_cell.get_guard();
+      thrust_device::vector<real_t> 
+        &scl(coal_scl); // scale factor for probablility
+      thrust_device::vector<thrust_size_t> 
+        &off(coal_off); // offset for getting index of particle within a cell
 
+      // scale factors and offsets depend only on the number of SDs per cell,
+      // they are reused in the following substeps (and steps) until the particle layout changes
+      if (coal_epoch != layout_epoch)
+      {
+        hskpng_count();            // no. of super-droplets per cell 
+        
+        // placing scale_factors in count_mom (of size count_n!)
+        thrust::transform(
+          count_num.begin(), count_num.begin() + count_n, // input - 1st arg
+          count_mom.begin(),                              // output
+          detail::scale_factor<real_t, n_t>()
+        );
+        nancheck_range(count_mom.begin(), count_mom.begin() + count_n, "count_mom storing scale_factors");
+
+        // laying out scale factor onto ijk grid
+        // fill with 0s if not all cells will be updated in the following copy
+        if(count_n!=n_cell)  thrust::fill(scl.begin(), scl.end(), real_t(0.));
+        
+        thrust::copy(
+          count_mom.begin(),                    // input - begin
+          count_mom.begin() + count_n,          // input - end
+          thrust::make_permutation_iterator(    // output
+            scl.begin(),                        // data
+            count_ijk.begin()                   // permutation
+          )
+        );  
+        nancheck(scl, "scl - scale factors");
+
+        // cumulative sum of count_num -> (i - cumsum(ijk(i))) gives droplet index in a given cell
+        // fill with 0s if not all cells will be updated in the following copy
+        if(count_n!=n_cell)  thrust::fill(off.begin(), off.end(), real_t(0.));
+        thrust::copy(
+          count_num.begin(), 
+          count_num.begin() + count_n, 
+          thrust::make_permutation_iterator(    // output
+            off.begin(),                        // data
+            count_ijk.begin()                   // permutation
+          )
+        );
+        thrust::exclusive_scan( 
+          off.begin(), off.end(),
+          off.begin()
+        );
+//        nancheck(off, "off - droplet index within a cell");
+
+        coal_epoch = layout_epoch;
+      }
+
+      // references to tmp data
+      auto col_g = tmp_device_real_part.get_guard();
       thrust_device::vector<real_t> 
-        &scl(scl_g.get()), // scale factor for probablility
         &col(col_g.get()); // number of collisions, used in chemistry,
                            // 1st one of a pair stores number of collisions, 2nd one stores info on which one has greater multiplicity
-      thrust_device::vector<thrust_size_t> 
-        &off(off_g.get()); // offset for getting index of particle within a cell
-
-      // laying out scale factor onto ijk grid
-      // fill with 0s if not all cells will be updated in the following copy
-      if(count_n!=n_cell)  thrust::fill(scl.begin(), scl.end(), real_t(0.));
-      
-      thrust::copy(
-        count_mom.begin(),                    // input - begin
-        count_mom.begin() + count_n,          // input - end
-        thrust::make_permutation_iterator(    // output
-          scl.begin(),                        // data
-          count_ijk.begin()                   // permutation
-        )
-      );  
-      nancheck(scl, "scl - scale factors");
-
-      // cumulative sum of count_num -> (i - cumsum(ijk(i))) gives droplet index in a given cell
-      // fill with 0s if not all cells will be updated in the following copy
-      if(count_n!=n_cell)  thrust::fill(off.begin(), off.end(), real_t(0.));
-      thrust::copy(
-        count_num.begin(), 
-        count_num.begin() + count_n, 
-        thrust::make_permutation_iterator(    // output
-          off.begin(),                        // data
-          count_ijk.begin()                   // permutation
-        )
-      );
-      thrust::exclusive_scan( 
-        off.begin(), off.end(),
-        off.begin()
-      );
-//      nancheck(off, "off - droplet index within a cell");
 
       // colliding
       typedef thrust::permutation_iterator<
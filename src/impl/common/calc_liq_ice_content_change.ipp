@@ -26,7 +26,7 @@ namespace libcloudphxx
         thrust::plus<real_t>()
       );
 
-      if(opts_init.ice_switch)
+      if(opts_init.ice_switch && !ice_absent()) // d_ice_mass stays zero without ice
       {
         thrust_device::vector<real_t> &d_ice_mass = d_ice_mass_gp->get();
 
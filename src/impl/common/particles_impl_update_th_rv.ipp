@@ -79,7 +79,7 @@ namespace libcloudphxx
     //  ) 
 // >>>>>>> 41c117de670b134d0632608d7e48fd9050a852bc:src/impl/particles_impl_update_th_rv.ipp
     {   
-      if(!sorted) throw std::runtime_error("libcloudph++: update_th_rv called on an unsorted set");
+      if(!sorted()) throw std::runtime_error("libcloudph++: update_th_rv called on an unsorted set");
 
       // thrust_device::vector<real_t> &drw_mom3 = drw_mom3_gp->get();
       // nancheck(drw_mom3, "update_th_rv: input drw_mom3");
@@ -188,6 +188,7 @@ namespace libcloudphxx
       drw_mom3_gp.reset(); // destroy guard to tmp array that stored change in 3rd moment of rw
       d_ice_mass_gp.reset(); // destroy guard to tmp array that stored change in 3rd moment of rw
       nancheck(th, "update_th_rv: th after update");
+      Tpr_dirty = true;
     }
 
     // update th for freezing
@@ -197,7 +198,7 @@ namespace libcloudphxx
       thrust_device::vector<real_t> &drw // change of specific 3rd moment of liquid per cell
     )
     {
-      if(!sorted) throw std::runtime_error("libcloudph++: update_th_freezing called on an unsorted set");
+      if(!sorted()) throw std::runtime_error("libcloudph++: update_th_freezing called on an unsorted set");
       nancheck(drw, "update_th_freezing: input drw");
 
       // Calculating the change of liquid mixing ratio per cell (multiplying specific 3rd mom by rho_w*4/3*pi)
@@ -235,6 +236,7 @@ namespace libcloudphxx
         );
       }
       nancheck(th, "update_th_freezing: th after update");
+      Tpr_dirty = true;
     }
 
     // update particle-specific cell state
@@ -245,7 +247,7 @@ namespace libcloudphxx
       thrust_device::vector<real_t> &pdstate // change in cell characteristic
     ) 
     {   
-      if(!sorted) throw std::runtime_error("libcloudph++: update_uh_rv called on an unsorted set");
+      if(!sorted()) throw std::runtime_error("libcloudph++: update_uh_rv called on an unsorted set");
 
       // cell-wise change in state
       auto dstate_g = tmp_device_real_cell.get_guard();
@@ -294,6 +296,7 @@ namespace libcloudphxx
        pstate.begin(), pstate.end(),
        thrust::make_permutation_iterator(state.begin(), ijk.begin())
      );   
+     Tpr_dirty = true;
 
     }
   };  
@@ -35,6 +35,13 @@ namespace libcloudphxx
         reset_guardp(d_ice_mass_gp, tmp_device_real_cell); 
         thrust_device::vector<real_t> &d_ice_mass = d_ice_mass_gp->get();
 
+        // no ice SDs, no ice mass
+        if (ice_absent())
+        {
+          thrust::fill(d_ice_mass.begin(), d_ice_mass.end(), real_t(0.));
+          return;
+        }
+
         moms_gt0(ice_a.begin()); // choose ice particles (ice_a>0)
         moms_calc(thrust::make_transform_iterator(
           thrust::make_zip_iterator(thrust::make_tuple(ice_a.begin(), ice_c.begin(), ice_rho.begin())),
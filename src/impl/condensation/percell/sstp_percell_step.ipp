@@ -12,6 +12,8 @@ namespace libcloudphxx
 
     namespace arg = thrust::placeholders;
 
+    Tpr_dirty = true;
+
     const int n = 3;
     thrust_device::vector<real_t>
         *scl[n] = { &rv,          &th,          &rhod        },
@@ -36,10 +36,33 @@ namespace libcloudphxx
       );
     }
 
+    // snapshot of the last diagnostic in the output queue; only the device-side copy is done here,
+    // copying to the host proceeds asynchronously (on CUDA) while the model is stepped
     template <typename real_t, backend_t device>
-    std::vector<real_t> particles_t<real_t, device>::impl::fill_attr_outbuf(const std::string &name)
+    unsigned long long particles_t<real_t, device>::impl::outbuf_enqueue()
     {
-      const std::set<std::string> attr_names = {"rw2", "rd3", "kappa", "rd2_insol", "T_freeze", "ice_a", "ice_c", "ice_rho", "x", "y", "z"}; // TODO implement "n" - it is n_t type and others are real_t
+      if (!outbuf_q)
+      {
+        if (opts_init.outbuf_queue_len < 1)
+          throw std::runtime_error("libcloudph++: opts_init.outbuf_queue_len has to be positive to use outbuf_enqueue()");
+        outbuf_q.reset(new detail::outbuf_queue<real_t, thrust_device::vector<real_t>>(opts_init.outbuf_queue_len));
+      }
+
+      auto &slot = outbuf_q->acquire(n_cell);
+      thrust::fill(slot.dev.begin(), slot.dev.end(), 0);
+      thrust::scatter(
+        count_mom.begin(), count_mom.begin() + count_n,
+        count_ijk.begin(),
+        slot.dev.begin()
+      );
+      return outbuf_q->push(slot);
+    }
+
+    // copies n_part values of an attribute to out ("n" is converted to real_t)
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::fill_attr_outbuf(const std::string &name, typename std::vector<real_t>::iterator out)
+    {
+      const std::set<std::string> attr_names = {"n", "rw2", "rd3", "kappa", "rd2_insol", "T_freeze", "ice_a", "ice_c", "ice_rho", "x", "y", "z"};
       if (std::find(std::begin(attr_names), std::end(attr_names), name) == std::end(attr_names))
         throw std::runtime_error("Unknown attribute name passed to get_attr.");
 
@@ -48,11 +71,24 @@ namespace libcloudphxx
       {
         throw std::runtime_error("Requested ice attribute '" + name + "' but ice_switch is off.");
       }
+
+      // SDs copied with MPI in the last step_async have to be in place
+      mpi_exchange_finish();
       if (opts_init.time_dep_ice_nucl && name == "T_freeze")
       {
         throw std::runtime_error("Requested T_freeze but singular ice nucleation is off.");
       }
 
+      if (name == "n")
+      {
+        // converted on the device, so that only real_t values are copied
+        auto n_real_g = tmp_device_real_part.get_guard();
+        thrust_device::vector<real_t> &n_real = n_real_g.get();
+        thrust::copy(n.begin(), n.end(), n_real.begin());
+        thrust::copy(n_real.begin(), n_real.begin() + n_part, out);
+        return;
+      }
+
       const thrust_device::vector<real_t> &dv(
         name == "rw2" ? rw2 : 
         name == "rd3" ? rd3 : 
@@ -68,11 +104,19 @@ namespace libcloudphxx
 
       // NOTE: for host backends (i.e. undefined __NVCC__) we could return the vector directly, without a copy;
       //       however, if output was done concurrently, values in the diagnosed vector might change after the call to fill_attr_outbuf.
-      std::vector<real_t> out(n_part);
       thrust::copy(
         dv.begin(), dv.end(),
-        out.begin()
+        out
       );
+    }
+
+    // attributes one after another, each n_part values
+    template <typename real_t, backend_t device>
+    std::vector<real_t> particles_t<real_t, device>::impl::fill_attr_outbuf(const std::vector<std::string> &names)
+    {
+      std::vector<real_t> out(names.size() * n_part);
+      for (std::size_t a = 0; a < names.size(); ++a)
+        fill_attr_outbuf(names[a], out.begin() + a * n_part);
       return out;
     }
   };
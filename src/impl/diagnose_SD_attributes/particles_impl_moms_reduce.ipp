@@ -0,0 +1,157 @@
+// vim:filetype=cpp
+/** @file
+  * @copyright University of Warsaw
+  * @section LICENSE
+  * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
+  */
+
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/inner_product.h>
+#include <thrust/scatter.h>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // i-th cell in the k-major order -> cell index (cells are stored with z varying fastest)
+      struct kmajor_cell
+      {
+        const thrust_size_t n_z, n_col;
+
+        kmajor_cell(const thrust_size_t &n_z, const thrust_size_t &n_col) : n_z(n_z), n_col(n_col) {}
+
+        BOOST_GPU_ENABLED
+        thrust_size_t operator()(const thrust_size_t &i) const
+        {
+          return (i % n_col) * n_z + i / n_col;
+        }
+      };
+
+      // i -> i / n (level index in the k-major order or column index)
+      struct idx_div
+      {
+        const thrust_size_t n;
+
+        idx_div(const thrust_size_t &n) : n(n) {}
+
+        BOOST_GPU_ENABLED
+        thrust_size_t operator()(const thrust_size_t &i) const
+        {
+          return i / n;
+        }
+      };
+    };
+
+    // result of the last moms_calc() as a dense field multiplied by rhod (and by dv if per_volume == false),
+    // i.e. moment per unit volume or per cell
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::moms_dense(
+      thrust_device::vector<real_t> &dense,
+      const bool per_volume
+    )
+    {
+      thrust::fill(dense.begin(), dense.end(), 0);
+      thrust::scatter(
+        count_mom.begin(), count_mom.begin() + count_n,
+        count_ijk.begin(),
+        dense.begin()
+      );
+      thrust::transform(dense.begin(), dense.end(), rhod.begin(), dense.begin(), thrust::multiplies<real_t>());
+      if (!per_volume)
+        thrust::transform(dense.begin(), dense.end(), dv.begin(), dense.begin(), thrust::multiplies<real_t>());
+    }
+
+    // air-mass-weighted horizontal mean of the last moms_calc() at each level
+    template <typename real_t, backend_t device>
+    std::vector<real_t> particles_t<real_t, device>::impl::moms_profile()
+    {
+      const thrust_size_t n_z = m1(opts_init.nz),
+                          n_col = n_cell / n_z;
+
+      auto dense_g = tmp_device_real_cell.get_guard();
+      thrust_device::vector<real_t> &dense = dense_g.get();
+      moms_dense(dense, false);
+
+      auto mass_g = tmp_device_real_cell.get_guard();
+      thrust_device::vector<real_t> &mass = mass_g.get();
+      thrust::transform(rhod.begin(), rhod.end(), dv.begin(), mass.begin(), thrust::multiplies<real_t>());
+
+      // sums over levels, keys are the level indices in the k-major order
+      thrust_device::vector<real_t> sum(2 * n_z);
+      auto key_bgn = thrust::make_transform_iterator(thrust::make_counting_iterator<thrust_size_t>(0), detail::idx_div(n_col));
+      auto perm_bgn = thrust::make_transform_iterator(thrust::make_counting_iterator<thrust_size_t>(0), detail::kmajor_cell(n_z, n_col));
+      thrust::reduce_by_key(
+        key_bgn, key_bgn + n_cell,
+        thrust::make_permutation_iterator(dense.begin(), perm_bgn),
+        thrust::make_discard_iterator(),
+        sum.begin()
+      );
+      thrust::reduce_by_key(
+        key_bgn, key_bgn + n_cell,
+        thrust::make_permutation_iterator(mass.begin(), perm_bgn),
+        thrust::make_discard_iterator(),
+        sum.begin() + n_z
+      );
+
+      std::vector<real_t> sum_h(sum.begin(), sum.end());
+#if defined(USE_MPI)
+      if (distmem_mpi())
+        MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, sum_h.data(), sum_h.size(), detail::get_mpi_type<real_t>(), MPI_SUM, detail::MPI_COMM_LIBCLOUD));
+#endif
+
+      std::vector<real_t> out(n_z);
+      for (thrust_size_t k = 0; k < n_z; ++k)
+        out[k] = sum_h[k] / sum_h[n_z + k];
+      return out;
+    }
+
+    // vertical integral of rhod times the last moms_calc() in each column (per unit area, e.g. LWP from the mixing ratio)
+    template <typename real_t, backend_t device>
+    std::vector<real_t> particles_t<real_t, device>::impl::moms_column()
+    {
+      const thrust_size_t n_z = m1(opts_init.nz),
+                          n_col = n_cell / n_z;
+
+      auto dense_g = tmp_device_real_cell.get_guard();
+      thrust_device::vector<real_t> &dense = dense_g.get();
+      moms_dense(dense, true);
+
+      // cells of a column are contiguous
+      thrust_device::vector<real_t> sum(n_col);
+      thrust::reduce_by_key(
+        thrust::make_transform_iterator(thrust::make_counting_iterator<thrust_size_t>(0), detail::idx_div(n_z)),
+        thrust::make_transform_iterator(thrust::make_counting_iterator<thrust_size_t>(n_cell), detail::idx_div(n_z)),
+        dense.begin(),
+        thrust::make_discard_iterator(),
+        sum.begin()
+      );
+
+      std::vector<real_t> out(sum.begin(), sum.end());
+      const real_t dz = opts_init.nz == 0 ? 1 : opts_init.dz;
+      for (auto &val : out) val *= dz;
+      return out;
+    }
+
+    // air-mass-weighted mean of the last moms_calc() over the whole domain
+    template <typename real_t, backend_t device>
+    real_t particles_t<real_t, device>::impl::moms_domain()
+    {
+      auto dense_g = tmp_device_real_cell.get_guard();
+      thrust_device::vector<real_t> &dense = dense_g.get();
+      moms_dense(dense, false);
+
+      real_t sum[2] = {
+        thrust::reduce(dense.begin(), dense.end()),
+        thrust::inner_product(rhod.begin(), rhod.end(), dv.begin(), real_t(0))
+      };
+#if defined(USE_MPI)
+      if (distmem_mpi())
+        MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, sum, 2, detail::get_mpi_type<real_t>(), MPI_SUM, detail::MPI_COMM_LIBCLOUD));
+#endif
+      return sum[0] / sum[1];
+    }
+  };
+};
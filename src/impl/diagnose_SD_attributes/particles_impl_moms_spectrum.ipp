@@ -0,0 +1,174 @@
+// vim:filetype=cpp
+/** @file
+  * @copyright University of Warsaw
+  * @section LICENSE
+  * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
+  */
+
+#include <thrust/sort.h>
+#include <thrust/reduce.h>
+#include <thrust/sequence.h>
+#include <algorithm>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // composite (bin, cell) key, bins are the slower-varying index;
+      // SDs outside of the spectrum get key n_bins * n_cell
+      template <typename real_t>
+      struct spectrum_key
+      {
+        const real_t *edges; // n_bins + 1 increasing bin edges
+        const thrust_size_t n_bins, n_cell;
+
+        spectrum_key(const real_t *edges, const thrust_size_t &n_bins, const thrust_size_t &n_cell) :
+          edges(edges), n_bins(n_bins), n_cell(n_cell)
+        {}
+
+        BOOST_GPU_ENABLED
+        thrust_size_t operator()(const thrust_size_t &ijk, const real_t &x) const
+        {
+          if (!(x >= edges[0] && x < edges[n_bins])) return n_bins * n_cell;
+
+          // bisection for edges[lo] <= x < edges[hi]
+          thrust_size_t lo = 0, hi = n_bins;
+          while (hi - lo > 1)
+          {
+            const thrust_size_t mid = (lo + hi) / 2;
+            if (x >= edges[mid]) lo = mid;
+            else                 hi = mid;
+          }
+          return lo * n_cell + ijk;
+        }
+      };
+
+      // n * x^xp
+      template <typename real_t, typename n_t>
+      struct spectrum_mom
+      {
+        const real_t xp;
+
+        spectrum_mom(const real_t &xp) : xp(xp) {}
+
+        BOOST_GPU_ENABLED
+        real_t operator()(const thrust::tuple<n_t, real_t> &tpl) const
+        {
+#if !defined(__NVCC__)
+          using std::pow;
+#endif
+          return real_t(thrust::get<0>(tpl)) * pow(thrust::get<1>(tpl), xp);
+        }
+      };
+
+      // cell index from the composite key
+      struct spectrum_cell
+      {
+        const thrust_size_t n_cell;
+
+        spectrum_cell(const thrust_size_t &n_cell) : n_cell(n_cell) {}
+
+        BOOST_GPU_ENABLED
+        thrust_size_t operator()(const thrust_size_t &key) const
+        {
+          return key % n_cell;
+        }
+      };
+    };
+
+    // moments of all SDs binned by vec in all cells at once: one composite (bin, cell) key per SD,
+    // one sort and one reduce_by_key instead of a moms_rng() + moms_calc() pair per bin;
+    // uses sorted_ijk and sorted_id as temporary storage, so they have to be sorted again afterwards
+    template <typename real_t, backend_t device>
+    std::vector<real_t> particles_t<real_t, device>::impl::moms_spectrum(
+      const std::vector<real_t> &edges, // bin edges in units of vec
+      const thrust_device::vector<real_t> &vec,
+      const real_t power
+    )
+    {
+      if (edges.size() < 2)
+        throw std::runtime_error("libcloudph++: at least two bin edges are needed for a spectrum");
+      if (!std::is_sorted(edges.begin(), edges.end()) || std::adjacent_find(edges.begin(), edges.end()) != edges.end())
+        throw std::runtime_error("libcloudph++: bin edges of a spectrum have to be increasing");
+
+      // SDs copied with MPI in the last step_async have to be accounted for
+      mpi_exchange_finish();
+
+      const thrust_size_t n_bins = edges.size() - 1,
+                          n_key = n_bins * n_cell + 1; // incl. the key of SDs outside of the spectrum
+
+      spec_edges.resize(edges.size());
+      thrust::copy(edges.begin(), edges.end(), spec_edges.begin());
+      if (spec_key.size() < n_key)
+      {
+        spec_key.resize(n_key);
+        spec_mom.resize(n_key);
+      }
+
+      // composite keys
+      thrust::transform(
+        ijk.begin(), ijk.begin() + n_part, // input - 1st arg
+        vec.begin(),                       // input - 2nd arg
+        sorted_ijk.begin(),                // output
+        detail::spectrum_key<real_t>(thrust::raw_pointer_cast(spec_edges.data()), n_bins, n_cell)
+      );
+      thrust::sequence(sorted_id.begin(), sorted_id.begin() + n_part);
+      thrust::sort_by_key(
+        sorted_ijk.begin(), sorted_ijk.begin() + n_part,
+        sorted_id.begin()
+      );
+      sorted_epoch = 0; // sorted_ijk no longer holds cell indices (the layout itself, and hence the per-cell counts, did not change)
+
+      thrust::pair<
+        thrust_device::vector<thrust_size_t>::iterator,
+        typename thrust_device::vector<real_t>::iterator
+      > it_pair = thrust::reduce_by_key(
+        // input - keys
+        sorted_ijk.begin(), sorted_ijk.begin() + n_part,
+        // input - values
+        thrust::make_transform_iterator(
+          thrust::make_zip_iterator(thrust::make_tuple(
+            thrust::make_permutation_iterator(n.begin(),   sorted_id.begin()),
+            thrust::make_permutation_iterator(vec.begin(), sorted_id.begin())
+          )),
+          detail::spectrum_mom<real_t, n_t>(power)
+        ),
+        // output - keys
+        spec_key.begin(),
+        // output - values
+        spec_mom.begin()
+      );
+      thrust_size_t n_out = it_pair.first - spec_key.begin();
+
+      // the last key holds SDs outside of the spectrum
+      if (n_out > 0 && spec_key[n_out - 1] == n_key - 1) --n_out;
+
+      // specific moments, as in moms_calc()
+      {
+        auto cell_bgn = thrust::make_transform_iterator(spec_key.begin(), detail::spectrum_cell(n_cell));
+        thrust::transform(
+          spec_mom.begin(), spec_mom.begin() + n_out,
+          thrust::make_permutation_iterator(dv.begin(), cell_bgn),
+          spec_mom.begin(),
+          thrust::divides<real_t>()
+        );
+        thrust::transform(
+          spec_mom.begin(), spec_mom.begin() + n_out,
+          thrust::make_permutation_iterator(rhod.begin(), cell_bgn),
+          spec_mom.begin(),
+          thrust::divides<real_t>()
+        );
+      }
+
+      // dense [n_bins x n_cell] output
+      thrust::host_vector<thrust_size_t> key_h(spec_key.begin(), spec_key.begin() + n_out);
+      thrust::host_vector<real_t> mom_h(spec_mom.begin(), spec_mom.begin() + n_out);
+      std::vector<real_t> out(n_bins * n_cell, 0);
+      for (thrust_size_t i = 0; i < n_out; ++i)
+        out[key_h[i]] = mom_h[i];
+      return out;
+    }
+  };
+};
@@ -26,84 +26,107 @@ namespace libcloudphxx
       };
     };
  
+    // size in bytes of a buffer with n_sd SDs
     template <typename real_t, backend_t device>
-    void particles_t<real_t, device>::impl::pack_n_lft()
+    std::size_t particles_t<real_t, device>::impl::distmem_bfr_size(const thrust_size_t &n_sd)
     {
-      assert(out_n_bfr.size() >= lft_count * distmem_n_vctrs.size());
-      assert(in_n_bfr.size() >= lft_count * distmem_n_vctrs.size());
+      return detail::distmem_bfr_size<n_t, real_t>(n_sd, distmem_n_vctrs.size(), distmem_real_vctrs.size());
+    }
 
-      thrust_device::vector<thrust_size_t> &lft_id(lft_id_gp->get()); 
+    // orders the SD attributes by fixed ids and computes the checksum of the ids present;
+    // ids must never be changed or reused, new attributes are appended at the end of the lists
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::distmem_order()
+    {
+      const std::vector<thrust_device::vector<n_t>*> n_ids = {&n};
+      const std::vector<thrust_device::vector<real_t>*> real_ids = {
+        &rd3, &rw2, &kpa, &vt, &x, &y, &z,
+        &sstp_tmp_rv, &sstp_tmp_th, &sstp_tmp_rh, &sstp_tmp_p,
+        &up, &vp, &wp, &ssp, &dot_ssp,
+        &incloud_time,
+        &rd2_insol, &ice_a, &ice_c, &ice_rho, &T_freeze,
+        &rc2
+      };
 
-      auto it = distmem_n_vctrs.begin();
-      while (it != distmem_n_vctrs.end())
+      distmem_layout_sum = 0;
+
+      distmem_n_ordered.clear();
+      for(std::size_t id = 0; id < n_ids.size(); ++id)
       {
-        thrust::copy(
-          thrust::make_permutation_iterator((*it)->begin(), lft_id.begin()),
-          thrust::make_permutation_iterator((*it)->begin(), lft_id.begin()) + lft_count,
-          out_n_bfr.begin() + std::distance(distmem_n_vctrs.begin(), it) * lft_count
-        );
-        it++;
+        if(distmem_n_vctrs.count(n_ids[id]) == 0) continue;
+        distmem_n_ordered.push_back(n_ids[id]);
+        distmem_layout_sum = distmem_layout_sum * 31 + id + 1;
       }
+
+      distmem_real_ordered.clear();
+      for(std::size_t id = 0; id < real_ids.size(); ++id)
+      {
+        if(std::find_if(distmem_real_vctrs.begin(), distmem_real_vctrs.end(),
+             [&](const std::pair<thrust_device::vector<real_t>*, real_t> &pair){return pair.first == real_ids[id];}
+           ) == distmem_real_vctrs.end()) continue;
+        distmem_real_ordered.push_back(real_ids[id]);
+        distmem_layout_sum = distmem_layout_sum * 31 + n_ids.size() + id + 1;
+      }
+
+      if(distmem_n_ordered.size() != distmem_n_vctrs.size() || distmem_real_ordered.size() != distmem_real_vctrs.size())
+        throw std::runtime_error("libcloudph++: an SD attribute copied between processes has no id in distmem_order()");
     }
 
+    // checksum of the attributes in the buffer, has to match on both ends
     template <typename real_t, backend_t device>
-    void particles_t<real_t, device>::impl::pack_n_rgt()
+    unsigned long long particles_t<real_t, device>::impl::distmem_layout()
     {
-      assert(out_n_bfr.size() >= rgt_count * distmem_n_vctrs.size());
-      assert(in_n_bfr.size() >= rgt_count * distmem_n_vctrs.size());
-      
-      thrust_device::vector<thrust_size_t> &rgt_id(rgt_id_gp->get()); 
+      return distmem_layout_sum;
+    }
+
+    // pack header and all attributes of count SDs with ids from id into bfr
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::pack(
+      thrust_device::vector<char> &bfr,
+      const thrust_device::vector<thrust_size_t> &id,
+      const thrust_size_t &count
+    )
+    {
+      assert(bfr.size() >= distmem_bfr_size(count));
 
-      auto it = distmem_n_vctrs.begin();
-      while (it != distmem_n_vctrs.end())
+      const detail::distmem_bfr_hdr_t hdr{count, distmem_n_vctrs.size(), distmem_real_vctrs.size(), distmem_layout()};
+      thrust::copy(
+        reinterpret_cast<const char*>(&hdr),
+        reinterpret_cast<const char*>(&hdr) + sizeof(hdr),
+        bfr.begin()
+      );
+
+      thrust_device::pointer<n_t> n_bgn(reinterpret_cast<n_t*>(bfr.data().get() + sizeof(hdr)));
+      for(std::size_t i = 0; i < distmem_n_ordered.size(); ++i)
       {
         thrust::copy(
-          thrust::make_permutation_iterator((*it)->begin(), rgt_id.begin()),
-          thrust::make_permutation_iterator((*it)->begin(), rgt_id.begin()) + rgt_count,
-          out_n_bfr.begin() + std::distance(distmem_n_vctrs.begin(), it) * rgt_count
+          thrust::make_permutation_iterator(distmem_n_ordered[i]->begin(), id.begin()),
+          thrust::make_permutation_iterator(distmem_n_ordered[i]->begin(), id.begin()) + count,
+          n_bgn + i * count
         );
-        it++;
       }
-    }
-
-    template <typename real_t, backend_t device>
-    void particles_t<real_t, device>::impl::pack_real_lft()
-    {
-      assert(out_real_bfr.size() >= lft_count * distmem_real_vctrs.size());
-      assert(in_real_bfr.size() >= lft_count * distmem_real_vctrs.size());
-      
-      thrust_device::vector<thrust_size_t> &lft_id(lft_id_gp->get()); 
 
-      auto it = distmem_real_vctrs.begin();
-      while (it != distmem_real_vctrs.end())
+      thrust_device::pointer<real_t> real_bgn(reinterpret_cast<real_t*>((n_bgn + distmem_n_vctrs.size() * count).get()));
+      for(std::size_t i = 0; i < distmem_real_ordered.size(); ++i)
       {
         thrust::copy(
-          thrust::make_permutation_iterator((*it).first->begin(), lft_id.begin()),
-          thrust::make_permutation_iterator((*it).first->begin(), lft_id.begin()) + lft_count,
-          out_real_bfr.begin() + std::distance(distmem_real_vctrs.begin(), it) * lft_count
+          thrust::make_permutation_iterator(distmem_real_ordered[i]->begin(), id.begin()),
+          thrust::make_permutation_iterator(distmem_real_ordered[i]->begin(), id.begin()) + count,
+          real_bgn + i * count
         );
-        it++;
       }
     }
 
     template <typename real_t, backend_t device>
-    void particles_t<real_t, device>::impl::pack_real_rgt()
+    void particles_t<real_t, device>::impl::pack_lft()
     {
-      assert(out_real_bfr.size() >= rgt_count * distmem_real_vctrs.size());
-      assert(in_real_bfr.size() >= rgt_count * distmem_real_vctrs.size());
-
-      thrust_device::vector<thrust_size_t> &rgt_id(rgt_id_gp->get()); 
+      pack(out_bfr_lft, lft_id_gp->get(), lft_count);
+    }
 
-      auto it = distmem_real_vctrs.begin();
-      while (it != distmem_real_vctrs.end())
-      {
-        thrust::copy(
-          thrust::make_permutation_iterator((*it).first->begin(), rgt_id.begin()),
-          thrust::make_permutation_iterator((*it).first->begin(), rgt_id.begin()) + rgt_count,
-          out_real_bfr.begin() + std::distance(distmem_real_vctrs.begin(), it) * rgt_count
-        );
-        it++;
-      }
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::pack_rgt()
+    {
+      pack(out_bfr_rgt, rgt_id_gp->get(), rgt_count);
     }
 
     template <typename real_t, backend_t device>
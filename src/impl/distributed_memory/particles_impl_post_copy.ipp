@@ -15,13 +15,13 @@ namespace libcloudphxx
     // if using more than 1 GPU
     // has to be done after copy 
     template <typename real_t, backend_t device>
-    void particles_t<real_t, device>::impl::post_copy(const opts_t<real_t> &opts)
+    void particles_t<real_t, device>::impl::post_copy(const bool rcyc)
     {
       // release temporary arrays
       lft_id_gp.reset();
       rgt_id_gp.reset();
       // recycling out-of-domain/invalidated particles 
-      if(opts.rcyc)
+      if(rcyc)
         rcyc();
       // if we do not recycle, we should remove them
       else
@@ -0,0 +1,210 @@
+// vim:filetype=cpp
+/** @file
+  * @copyright University of Warsaw
+  * @section LICENSE
+  * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
+  */
+
+#include <numeric>
+#include <limits>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    // move cell data from the old to the new decomposition;
+    // cells are stored x-major, so each column is a contiguous block of ny*nz values
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::rebalance_cell_vctr(
+      thrust_device::vector<real_t> &vec,
+      const std::vector<int> &old_bnds,
+      const std::vector<int> &new_bnds
+    )
+    {
+#if defined(USE_MPI)
+      const int n_col_cell = m1(opts_init.ny) * m1(opts_init.nz);
+
+      assert(vec.size() == (old_bnds[mpi_rank+1] - old_bnds[mpi_rank]) * n_col_cell);
+
+      std::vector<int> send_cnt(mpi_size), send_dsp(mpi_size),
+                       recv_cnt(mpi_size), recv_dsp(mpi_size);
+
+      for(int r = 0; r < mpi_size; ++r)
+      {
+        // columns of this process that go to process r
+        const int s0 = std::max(old_bnds[mpi_rank], new_bnds[r]),
+                  s1 = std::min(old_bnds[mpi_rank+1], new_bnds[r+1]);
+        send_cnt[r] = std::max(0, s1 - s0) * n_col_cell;
+        send_dsp[r] = send_cnt[r] > 0 ? (s0 - old_bnds[mpi_rank]) * n_col_cell : 0;
+
+        // columns of process r that come to this process
+        const int r0 = std::max(old_bnds[r], new_bnds[mpi_rank]),
+                  r1 = std::min(old_bnds[r+1], new_bnds[mpi_rank+1]);
+        recv_cnt[r] = std::max(0, r1 - r0) * n_col_cell;
+        recv_dsp[r] = recv_cnt[r] > 0 ? (r0 - new_bnds[mpi_rank]) * n_col_cell : 0;
+      }
+
+      thrust_device::vector<real_t> tmp((new_bnds[mpi_rank+1] - new_bnds[mpi_rank]) * n_col_cell);
+
+#if defined(__NVCC__)
+      gpuErrchk(cudaDeviceSynchronize());
+#endif
+
+      MPI_CHECK(MPI_Alltoallv(
+        vec.data().get(), send_cnt.data(), send_dsp.data(), detail::get_mpi_type<real_t>(),
+        tmp.data().get(), recv_cnt.data(), recv_dsp.data(), detail::get_mpi_type<real_t>(),
+        detail::MPI_COMM_LIBCLOUD
+      ));
+
+      vec.swap(tmp);
+#endif
+    }
+
+    // shift x-slab boundaries between processes to even out the number of SDs per process;
+    // done only if the most loaded process has more than config.rebalance_imbalance times the mean number of SDs
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::rebalance()
+    {
+#if defined(USE_MPI)
+      if(!distmem_mpi()) return;
+
+      namespace arg = thrust::placeholders;
+
+      // SDs copied in this step have to be in place and counted
+      mpi_exchange_finish();
+
+      const int n_col_cell = m1(opts_init.ny) * m1(opts_init.nz);
+
+      // current decomposition, old_bnds[r] = number of columns in processes to the left of process r
+      std::vector<int> old_bnds(mpi_size + 1, 0);
+      MPI_CHECK(MPI_Allgather(
+        &opts_init.nx, 1, MPI_INT,
+        old_bnds.data() + 1, 1, MPI_INT,
+        detail::MPI_COMM_LIBCLOUD
+      ));
+      std::partial_sum(old_bnds.begin(), old_bnds.end(), old_bnds.begin());
+
+      // number of SDs in each column of the whole domain (count_ijk and count_num are up to date after post_copy)
+      std::vector<double> col_n_sd(old_bnds.back(), 0);
+      {
+        thrust::host_vector<thrust_size_t> count_ijk_h(count_ijk.begin(), count_ijk.begin() + count_n);
+        thrust::host_vector<n_t> count_num_h(count_num.begin(), count_num.begin() + count_n);
+        for(thrust_size_t c = 0; c < count_n; ++c)
+          col_n_sd[old_bnds[mpi_rank] + count_ijk_h[c] / n_col_cell] += count_num_h[c];
+      }
+      MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, col_n_sd.data(), col_n_sd.size(), MPI_DOUBLE, MPI_SUM, detail::MPI_COMM_LIBCLOUD));
+
+      // is it worth it?
+      const double n_sd_tot = std::accumulate(col_n_sd.begin(), col_n_sd.end(), 0.);
+      if(n_sd_tot == 0) return;
+
+      double n_sd_max = 0;
+      for(int r = 0; r < mpi_size; ++r)
+        n_sd_max = std::max(n_sd_max, std::accumulate(col_n_sd.begin() + old_bnds[r], col_n_sd.begin() + old_bnds[r+1], 0.));
+      if(n_sd_max * mpi_size / n_sd_tot < config.rebalance_imbalance) return;
+
+      // new decomposition, each process keeps at least halo_size columns for the courant halo exchange
+      const std::vector<int> new_bnds = detail::balanced_x_bnds(col_n_sd, old_bnds, std::max(1, halo_size));
+      if(new_bnds == old_bnds) return;
+
+      const int old_bfr = old_bnds[mpi_rank],
+                new_bfr = new_bnds[mpi_rank],
+                new_nx  = new_bnds[mpi_rank+1] - new_bfr;
+      assert(old_bfr == mpi_n_x_bfr);
+
+      // cell data that is kept between steps
+      // (th, rv, rhod, diss_rate are overwritten in the next sync_in, but the user does not have to pass rhod nor p there)
+      rebalance_cell_vctr(th, old_bnds, new_bnds);
+      rebalance_cell_vctr(rv, old_bnds, new_bnds);
+      rebalance_cell_vctr(rhod, old_bnds, new_bnds);
+      rebalance_cell_vctr(p, old_bnds, new_bnds);
+      rebalance_cell_vctr(T, old_bnds, new_bnds);
+      rebalance_cell_vctr(RH, old_bnds, new_bnds);
+      rebalance_cell_vctr(eta, old_bnds, new_bnds);
+      if(opts_init.ice_switch)
+        rebalance_cell_vctr(RH_i, old_bnds, new_bnds);
+      if(opts_init.turb_cond_switch || opts_init.turb_adve_switch || opts_init.turb_coal_switch)
+        rebalance_cell_vctr(diss_rate, old_bnds, new_bnds);
+      if(allow_sstp_cond && !opts_init.exact_sstp_cond) // per-cell substepping
+      {
+        rebalance_cell_vctr(sstp_tmp_rv, old_bnds, new_bnds);
+        rebalance_cell_vctr(sstp_tmp_th, old_bnds, new_bnds);
+        rebalance_cell_vctr(sstp_tmp_rh, old_bnds, new_bnds);
+      }
+
+      // source box in global coordinates
+      real_t src_x[2] = {std::numeric_limits<real_t>::max(), std::numeric_limits<real_t>::max()}; // {x0, -x1}
+      if(opts_init.src_x1 > opts_init.src_x0)
+      {
+        src_x[0] =   opts_init.src_x0 + old_bfr * opts_init.dx;
+        src_x[1] = -(opts_init.src_x1 + old_bfr * opts_init.dx);
+      }
+      MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, src_x, 2, detail::get_mpi_type<real_t>(), MPI_MIN, detail::MPI_COMM_LIBCLOUD));
+
+      // new subdomain of this process
+      if(mpi_rank != mpi_size - 1) opts_init.x1 = new_nx * opts_init.dx;
+      else                         opts_init.x1 = opts_init.x1 + (old_bfr - new_bfr) * opts_init.dx;
+      if(mpi_rank != 0)            opts_init.x0 = 0.;
+      opts_init.nx = new_nx;
+      mpi_n_x_bfr = new_bfr;
+      n_cell = new_nx * n_col_cell;
+      n_x_tot = new_nx;
+
+      // local source box, same as in detail::distmem_opts
+      opts_init.src_x0 = 0;
+      opts_init.src_x1 = 0;
+      if(src_x[0] < std::numeric_limits<real_t>::max())
+      {
+        const real_t src_x0 =  src_x[0] - new_bfr * opts_init.dx,
+                     src_x1 = -src_x[1] - new_bfr * opts_init.dx;
+        if(!(src_x1 <= opts_init.x0 || src_x0 >= opts_init.x1))
+        {
+          opts_init.src_x0 = std::max(src_x0, opts_init.x0);
+          opts_init.src_x1 = std::min(src_x1, opts_init.x1);
+        }
+      }
+
+      // resize cell vectors and recalculate grid info
+      init_sync();
+      init_hskpng_ncell();
+      init_grid();
+      init_tmp_host_real_grid();
+      if(opts_init.rlx_switch && !opts_init.rlx_dry_distros.empty())
+        init_rlx_hor_dv();
+
+      // Eulerian arrays have a new shape, e2l maps are recalculated in the next sync_in
+      l2e.clear();
+
+      // tell neighbours about new x0/x1
+      xchng_domains();
+
+      // move SDs to the new coordinates and copy these that are now in the neighbouring processes
+      thrust::transform(
+        x.begin(), x.begin() + n_part,
+        x.begin(),
+        arg::_1 - real_t(new_bfr - old_bfr) * opts_init.dx
+      );
+
+      bcnd();
+
+      // buffers of the receiving process have to be large enough for all SDs sent to it
+      unsigned long long max_count = std::max(lft_count, rgt_count);
+      MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &max_count, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, detail::MPI_COMM_LIBCLOUD));
+      if(distmem_bfr_size(max_count) > in_bfr_lft.size())
+      {
+        in_bfr_lft.resize(distmem_bfr_size(max_count));
+        out_bfr_lft.resize(distmem_bfr_size(max_count));
+        in_bfr_rgt.resize(distmem_bfr_size(max_count));
+        out_bfr_rgt.resize(distmem_bfr_size(max_count));
+      }
+
+      // no recycling, SDs sent to other processes have to be removed
+      mpi_exchange_start(false);
+      mpi_exchange_finish();
+
+      if(opts_init.rebalance_hook)
+        opts_init.rebalance_hook(new_bfr, new_nx);
+#endif
+    }
+  };
+};
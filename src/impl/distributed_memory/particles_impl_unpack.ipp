@@ -46,9 +46,18 @@ namespace libcloudphxx
       };
     };
 
+    // append SDs from a buffer filled by pack() on another process/GPU
     template <typename real_t, backend_t device>
-    void particles_t<real_t, device>::impl::unpack_n(const int &n_copied)
+    void particles_t<real_t, device>::impl::unpack(const thrust_device::vector<char> &bfr)
     {
+      detail::distmem_bfr_hdr_t hdr;
+      thrust::copy(bfr.begin(), bfr.begin() + sizeof(hdr), reinterpret_cast<char*>(&hdr));
+
+      if(hdr.n_vctrs_n != distmem_n_vctrs.size() || hdr.n_vctrs_real != distmem_real_vctrs.size() || hdr.layout != distmem_layout())
+        throw std::runtime_error("libcloudph++: layout of the received SD buffer does not match the local one (different opts_init on different processes?)");
+
+      const thrust_size_t n_copied = hdr.n_sd;
+
       n_part_old = n_part;
       n_part += n_copied;
 
@@ -56,30 +65,20 @@ namespace libcloudphxx
         return;
 
       assert(opts_init.n_sd_max >= n_part);
+      assert(bfr.size() >= distmem_bfr_size(n_copied));
 
-      auto it = distmem_n_vctrs.begin();
-      while (it != distmem_n_vctrs.end())
+      thrust_device::pointer<const n_t> n_bgn(reinterpret_cast<const n_t*>(bfr.data().get() + sizeof(hdr)));
+      for(std::size_t i = 0; i < distmem_n_ordered.size(); ++i)
       {
-        (*it)->resize(n_part);
-        auto distance = std::distance(distmem_n_vctrs.begin(), it);
-        thrust::copy( in_n_bfr.begin() + distance * n_copied, in_n_bfr.begin() + (distance+1) * n_copied, (*it)->begin() + n_part_old);
-        it++;
+        distmem_n_ordered[i]->resize(n_part);
+        thrust::copy(n_bgn + i * n_copied, n_bgn + (i+1) * n_copied, distmem_n_ordered[i]->begin() + n_part_old);
       }
-    }
-
-    template <typename real_t, backend_t device>
-    void particles_t<real_t, device>::impl::unpack_real(const int &n_copied)
-    {
-      if(n_copied==0)
-        return;
 
-      auto it = distmem_real_vctrs.begin();
-      while (it != distmem_real_vctrs.end())
+      thrust_device::pointer<const real_t> real_bgn(reinterpret_cast<const real_t*>((n_bgn + distmem_n_vctrs.size() * n_copied).get()));
+      for(std::size_t i = 0; i < distmem_real_ordered.size(); ++i)
       {
-        (*it).first->resize(n_part);
-        auto distance = std::distance(distmem_real_vctrs.begin(), it);
-        thrust::copy( in_real_bfr.begin() + distance * n_copied, in_real_bfr.begin() + (distance+1) * n_copied, (*it).first->begin() + n_part_old);
-        it++;
+        distmem_real_ordered[i]->resize(n_part);
+        thrust::copy(real_bgn + i * n_copied, real_bgn + (i+1) * n_copied, distmem_real_ordered[i]->begin() + n_part_old);
       }
 
 #if !defined(NDEBUG)
@@ -218,6 +218,9 @@ namespace libcloudphxx
     template <typename real_t, backend_t device>
     void particles_t<real_t, device>::impl::hskpng_Tpr()
     {   
+      // nothing to do if th, rv, rhod and p did not change since the last call
+      if (!Tpr_dirty) return;
+
       if(opts_init.th_dry) // th is th_dry
       {
         // T  = common::theta_dry::T<real_t>(th, rhod), so th is assumed to be the dry-air potential temperature
@@ -302,6 +305,8 @@ namespace libcloudphxx
           real_t(1) / arg::_1
         );
       }
+
+      Tpr_dirty = false;
     }
   };  
 };
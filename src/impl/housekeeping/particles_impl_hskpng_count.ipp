@@ -5,6 +5,7 @@
   * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
   */
 
+#include <thrust/copy.h>
 #include <thrust/reduce.h>
 #include <thrust/iterator/constant_iterator.h>
 
@@ -17,6 +18,14 @@ namespace libcloudphxx
     {   
       hskpng_sort();
 
+      // the particle layout did not change since the last count, only count_ijk and count_n need to be restored
+      // (count_num is not touched by the moment-counting diagnostics)
+      if (counted_epoch == layout_epoch)
+      {
+        thrust::copy(hskpng_count_ijk.begin(), hskpng_count_ijk.begin() + hskpng_count_n, count_ijk.begin());
+        count_n = hskpng_count_n;
+        return;
+      }
 
       // computing count_* - number of particles per grid cell
       thrust::pair<
@@ -45,6 +54,10 @@ namespace libcloudphxx
       }
 #endif
       assert(count_n <= n_cell);
+
+      thrust::copy(count_ijk.begin(), count_ijk.begin() + count_n, hskpng_count_ijk.begin());
+      hskpng_count_n = count_n;
+      counted_epoch = layout_epoch;
     }   
   };  
 };
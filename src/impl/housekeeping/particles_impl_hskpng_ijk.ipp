@@ -195,8 +195,8 @@ namespace libcloudphxx
       // raveling i, j & k into ijk
       ravel_ijk();
       
-      // flagging that particles are no longer sorted 
-      sorted = false;
+      // flagging that the particle layout changed (particles are no longer sorted)
+      ++layout_epoch;
     }   
   };  
 };
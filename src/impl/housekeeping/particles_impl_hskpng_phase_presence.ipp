@@ -0,0 +1,81 @@
+// vim:filetype=cpp
+/** @file
+  * @copyright University of Warsaw
+  * @section LICENSE
+  * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
+  */
+
+// cheap summary of the presence of ice and of liquid that may freeze,
+// used to skip the ice microphysics stages that would do nothing
+
+#include <thrust/count.h>
+#include <thrust/extrema.h>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // liquid SD with freezing temperature not lower than T_min (singular freezing)
+      template <typename real_t>
+      struct may_freeze
+      {
+        const real_t T_min;
+
+        may_freeze(const real_t &T_min) : T_min(T_min) {}
+
+        BOOST_GPU_ENABLED
+        bool operator()(const thrust::tuple<real_t, real_t> &tpl) const // rw2, T_freeze
+        {
+          return thrust::get<0>(tpl) > real_t(0) && thrust::get<1>(tpl) >= T_min;
+        }
+      };
+    };
+
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::hskpng_phase_presence()
+    {
+      namespace arg = thrust::placeholders;
+
+      // extrema of the temperature in the domain
+      {
+        auto T_mm = thrust::minmax_element(T.begin(), T.end());
+        T_min = *T_mm.first;
+        T_max = *T_mm.second;
+      }
+
+      // ice SDs
+      n_ice_sd = thrust::count_if(ice_a.begin(), ice_a.end(), arg::_1 > real_t(0));
+
+      // liquid SDs that may freeze somewhere in the domain
+      if (opts_init.time_dep_ice_nucl)
+      {
+        // droplets frozen above 0C would be melted right away in ice_nucl_melt
+        n_frz_sd = T_min > real_t(273.15)
+          ? 0
+          : thrust::count_if(rw2.begin(), rw2.end(), arg::_1 > real_t(0));
+      }
+      else
+      {
+        n_frz_sd = thrust::count_if(
+          thrust::make_zip_iterator(thrust::make_tuple(rw2.begin(), T_freeze.begin())),
+          thrust::make_zip_iterator(thrust::make_tuple(rw2.end(),   T_freeze.end())),
+          detail::may_freeze<real_t>(T_min)
+        );
+      }
+
+      phase_epoch = layout_epoch;
+    }
+
+    // true if there are no ice SDs; the summary is recomputed if the particle layout changed
+    // (ice SDs can appear only with new SDs or in ice_nucl_melt, which keeps n_ice_sd up to date)
+    template <typename real_t, backend_t device>
+    bool particles_t<real_t, device>::impl::ice_absent()
+    {
+      if (phase_epoch != layout_epoch)
+        hskpng_phase_presence();
+      return n_ice_sd == 0;
+    }
+  };
+};
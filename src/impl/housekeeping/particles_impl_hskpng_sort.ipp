@@ -53,13 +53,14 @@ namespace libcloudphxx
       );
 
       // flagging that particles are now sorted
-      sorted = true;
+      sorted_epoch = layout_epoch;
     }   
 
     template <typename real_t, backend_t device>
     void particles_t<real_t, device>::impl::hskpng_sort()
     {   
-      if (sorted) return; // e.g. after shuffling
+      mpi_exchange_finish(); // SDs still in flight would not be accounted for
+      if (sorted()) return; // e.g. after shuffling
       hskpng_sort_helper(false);
     }
 
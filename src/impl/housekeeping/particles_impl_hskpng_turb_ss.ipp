@@ -40,18 +40,17 @@ namespace libcloudphxx
       };
     };
 
-    // calc the SGS turbulent supersaturation
+    // calc the relaxation time of the SGS turbulent supersaturation
+    // (only in cells that contain any SDs), used in hskpng_turb_vel
     template <typename real_t, backend_t device>
-    void particles_t<real_t, device>::impl::hskpng_turb_dot_ss()
+    void particles_t<real_t, device>::impl::hskpng_turb_tau_rlx(thrust_device::vector<real_t> &tau_rlx)
     {   
-      auto tau_rlx_g = tmp_device_real_cell.get_guard();
-      thrust_device::vector<real_t> &tau_rlx = tau_rlx_g.get();
 #if !defined(NDEBUG)
       // fill with a dummy value for debugging
       thrust::fill(tau_rlx.begin(), tau_rlx.end(), -44);
 #endif
 
-      // calc relaxation times (only in cells that contain any SDs) stored in count_mom
+      // calc relaxation times stored in count_mom
       moms_all();
       moms_calc(rw2.begin(), real_t(1./2), false);
       n_filtered_gp.reset(); // n_filtered not needed anymore
@@ -76,22 +75,6 @@ namespace libcloudphxx
           count_ijk.begin()
         )
       );
-
-      // calc ss perturb for each SD
-      thrust::transform(
-        thrust::make_zip_iterator(thrust::make_tuple(
-          ssp.begin(),
-          wp.begin(),
-          thrust::make_permutation_iterator(tau_rlx.begin(), ijk.begin())
-        )),
-        thrust::make_zip_iterator(thrust::make_tuple(
-          ssp.begin(),
-          wp.begin(),
-          thrust::make_permutation_iterator(tau_rlx.begin(), ijk.begin())
-        )) + n_part,
-        dot_ssp.begin(),
-        detail::common__turbulence__turb_dot_ss<real_t>()
-      );
     }
   };
 };
@@ -46,10 +46,57 @@ namespace libcloudphxx
           ) / si::metres * si::seconds;
         }
       };
+
+      // updates the turbulent velocity perturbations of an SD with normal variates generated inline
+      // and, if dot_ssp != nullptr, the time derivative of its supersaturation perturbation
+      template<class real_t>
+      struct turb_vel_fused
+      {
+        real_t * const vel[3];   // up, wp, vp; nullptr if not updated
+        const real_t * const wp; // needed only for dot_ssp
+        const real_t * const ssp;
+        real_t * const dot_ssp;
+        const real_t * const tau, * const tke, * const tau_rlx; // per-cell
+        const normal01_ctr<real_t> r_normal;
+        common__turbulence__update_turb_vel<real_t> update_turb_vel;
+        common__turbulence__turb_dot_ss<real_t> turb_dot_ss;
+
+        turb_vel_fused(
+          real_t *up, real_t *wp_upd, real_t *vp,
+          const real_t *wp, const real_t *ssp, real_t *dot_ssp,
+          const real_t *tau, const real_t *tke, const real_t *tau_rlx,
+          const unsigned long long &key, const real_t &dt
+        ) :
+          vel{up, wp_upd, vp}, wp(wp), ssp(ssp), dot_ssp(dot_ssp),
+          tau(tau), tke(tke), tau_rlx(tau_rlx),
+          r_normal(key), update_turb_vel(dt)
+        {}
+
+        BOOST_GPU_ENABLED
+        void operator()(const thrust::tuple<thrust_size_t, thrust_size_t> &tpl) // SD id, cell id
+        {
+          const thrust_size_t id = thrust::get<0>(tpl), ijk = thrust::get<1>(tpl);
+
+          for(int i = 0; i < 3; ++i)
+          {
+            if(vel[i] == nullptr) continue;
+            vel[i][id] = update_turb_vel(thrust::make_tuple(
+              vel[i][id], tau[ijk], tke[ijk], r_normal(3 * id + i)
+            ));
+          }
+
+          if(dot_ssp != nullptr)
+            dot_ssp[id] = turb_dot_ss(thrust::make_tuple(
+              ssp[id], wp[id], tau_rlx[ijk]
+            ));
+        }
+      };
     };
-    // calc the SGS turbulent velocity component
+
+    // calc the SGS turbulent velocity component and, if turb_cond, the time derivative
+    // of the turbulent supersaturation perturbation, in a single pass over SDs
     template <typename real_t, backend_t device>
-    void particles_t<real_t, device>::impl::hskpng_turb_vel(const real_t &dt, const bool only_vertical)
+    void particles_t<real_t, device>::impl::hskpng_turb_vel(const real_t &dt, const bool only_vertical, const bool turb_cond)
     {   
       namespace arg = thrust::placeholders;
 
@@ -68,29 +115,37 @@ namespace libcloudphxx
         detail::common__turbulence__tau<real_t>()
       );
 
-      auto r_normal_g = tmp_device_real_part.get_guard();
-      thrust_device::vector<real_t> &r_normal = r_normal_g.get();
+      auto tau_rlx_g = tmp_device_real_cell.get_guard();
+      thrust_device::vector<real_t> &tau_rlx = tau_rlx_g.get();
+      if(turb_cond) hskpng_turb_tau_rlx(tau_rlx);
+
+      // velocity components to update
+      real_t * vel_turbs_ptrs_a[] = {nullptr, nullptr, nullptr};
       thrust_device::vector<real_t> * vel_turbs_vctrs_a[] = {&up, &wp, &vp};
       for(int i = (only_vertical ? 1 : 0); i < (only_vertical ? 2 : n_dims); ++i)
-      {
-        rng.generate_normal_n(r_normal, n_part); // generate a random number for wach particle with a normal distribution with mean 0 and std dev 1
-        thrust::transform(
-          thrust::make_zip_iterator(thrust::make_tuple(
-            vel_turbs_vctrs_a[i]->begin(),
-            thrust::make_permutation_iterator(tau.begin(), ijk.begin()),
-            thrust::make_permutation_iterator(tke.begin(), ijk.begin()),
-            r_normal.begin()
-          )),
-          thrust::make_zip_iterator(thrust::make_tuple(
-            vel_turbs_vctrs_a[i]->begin(),
-            thrust::make_permutation_iterator(tau.begin(), ijk.begin()),
-            thrust::make_permutation_iterator(tke.begin(), ijk.begin()),
-            r_normal.begin()
-          )) + n_part,
-          vel_turbs_vctrs_a[i]->begin(),
-          detail::common__turbulence__update_turb_vel<real_t>(dt)
-        );
-      }
+        vel_turbs_ptrs_a[i] = thrust::raw_pointer_cast(vel_turbs_vctrs_a[i]->data());
+
+      thrust::for_each(
+        thrust::make_zip_iterator(thrust::make_tuple(
+          thrust::make_counting_iterator<thrust_size_t>(0),
+          ijk.begin()
+        )),
+        thrust::make_zip_iterator(thrust::make_tuple(
+          thrust::make_counting_iterator<thrust_size_t>(0),
+          ijk.begin()
+        )) + n_part,
+        detail::turb_vel_fused<real_t>(
+          vel_turbs_ptrs_a[0], vel_turbs_ptrs_a[1], vel_turbs_ptrs_a[2],
+          turb_cond ? thrust::raw_pointer_cast(wp.data())      : nullptr,
+          turb_cond ? thrust::raw_pointer_cast(ssp.data())     : nullptr,
+          turb_cond ? thrust::raw_pointer_cast(dot_ssp.data()) : nullptr,
+          thrust::raw_pointer_cast(tau.data()),
+          thrust::raw_pointer_cast(tke.data()),
+          thrust::raw_pointer_cast(tau_rlx.data()),
+          rng.stream_key(), // new stream every call
+          dt
+        )
+      );
     }
   };
 };
@@ -63,7 +63,7 @@ namespace libcloudphxx
       // -> on the other end: those that will be splitted
 
       // using sorted_id and sorted_ijk as temporary space - anyhow, after recycling these are not valid anymore!
-      sorted = false;
+      ++layout_epoch;
       thrust::sequence(sorted_id.begin(), sorted_id.end()); 
       {
 #if defined(__NVCC__) 
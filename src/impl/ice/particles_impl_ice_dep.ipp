@@ -19,6 +19,16 @@ namespace libcloudphxx
 
       namespace arg = thrust::placeholders;
 
+      // no ice SDs (none can appear during condensation substeps): no change in ice mass
+      if (ice_absent())
+      {
+        if(step > 0) // d_ice_mass released in update_th_rv
+          reset_guardp(d_ice_mass_gp, tmp_device_real_cell);
+        thrust_device::vector<real_t> &d_ice_mass = d_ice_mass_gp->get();
+        thrust::fill(d_ice_mass.begin(), d_ice_mass.end(), real_t(0.));
+        return;
+      }
+
       thrust_device::vector<real_t> &lambda_D(lambda_D_gp->get());
       thrust_device::vector<real_t> &lambda_K(lambda_K_gp->get());
 
@@ -116,6 +116,13 @@ namespace libcloudphxx
     template <typename real_t, backend_t device>
     void particles_t<real_t, device>::impl::ice_nucl_melt(const real_t &dt) {
 
+      // skipping the whole stage if there is nothing to freeze and nothing to melt
+      hskpng_phase_presence();
+      const bool
+        freeze = n_frz_sd > 0,
+        melt = n_ice_sd > 0 && T_max > real_t(273.15);
+      if (!freeze && !melt) return;
+
       hskpng_sort();
 
       // A vector to store liquid 3rd moments
@@ -137,34 +144,66 @@ namespace libcloudphxx
 
       // Change liquid droplets to ice under the freezing condition
 
-      if (opts_init.time_dep_ice_nucl) // time dependent freezing based on Arabas et al., 2025
+      if (freeze)
       {
-        auto u01g = tmp_device_real_part.get_guard();
-        thrust_device::vector<real_t> &u01 = u01g.get();
-        rand_u01(u01, n_part); // random numbers between [0,1] for each particle
-        thrust::for_each(
-          thrust::make_zip_iterator(thrust::make_tuple(
-            rw2.begin(),
-            ice_a.begin(),
-            ice_c.begin(),
-            ice_rho.begin(),
-            rd2_insol.begin(),
-            u01.begin(),
-            thrust::make_permutation_iterator(T.begin(), ijk.begin())
-          )),
-          thrust::make_zip_iterator(thrust::make_tuple(
-            rw2.begin(),
-            ice_a.begin(),
-            ice_c.begin(),
-            ice_rho.begin(),
-            rd2_insol.begin(),
-            u01.begin(),
-            thrust::make_permutation_iterator(T.begin(), ijk.begin())
-          )) + n_part,
-            detail::time_dep_freeze<real_t>(dt, opts_init.inp_type)  // functor for updating (rw2, a, c, rho_i) if freezing condition satisfied
-        );
+        if (opts_init.time_dep_ice_nucl) // time dependent freezing based on Arabas et al., 2025
+        {
+          auto u01g = tmp_device_real_part.get_guard();
+          thrust_device::vector<real_t> &u01 = u01g.get();
+          rand_u01(u01, n_part); // random numbers between [0,1] for each particle
+          thrust::for_each(
+            thrust::make_zip_iterator(thrust::make_tuple(
+              rw2.begin(),
+              ice_a.begin(),
+              ice_c.begin(),
+              ice_rho.begin(),
+              rd2_insol.begin(),
+              u01.begin(),
+              thrust::make_permutation_iterator(T.begin(), ijk.begin())
+            )),
+            thrust::make_zip_iterator(thrust::make_tuple(
+              rw2.begin(),
+              ice_a.begin(),
+              ice_c.begin(),
+              ice_rho.begin(),
+              rd2_insol.begin(),
+              u01.begin(),
+              thrust::make_permutation_iterator(T.begin(), ijk.begin())
+            )) + n_part,
+              detail::time_dep_freeze<real_t>(dt, opts_init.inp_type)  // functor for updating (rw2, a, c, rho_i) if freezing condition satisfied
+          );
+        }
+        else  // singular freezing based on Shima et al., 2020
+        {
+          thrust::for_each(
+            thrust::make_zip_iterator(thrust::make_tuple(
+              rw2.begin(),
+              ice_a.begin(),
+              ice_c.begin(),
+              ice_rho.begin(),
+              T_freeze.begin(),
+              thrust::make_permutation_iterator(T.begin(), ijk.begin()),
+              thrust::make_permutation_iterator(RH.begin(), ijk.begin())
+            )),
+            thrust::make_zip_iterator(thrust::make_tuple(
+              rw2.begin(),
+              ice_a.begin(),
+              ice_c.begin(),
+              ice_rho.begin(),
+              T_freeze.begin(),
+              thrust::make_permutation_iterator(T.begin(), ijk.begin()),
+              thrust::make_permutation_iterator(RH.begin(), ijk.begin())
+            )) + n_part,
+              detail::singular_freeze<real_t>()  // functor for updating (rw2, a, c, rho_i) if freezing condition satisfied
+          );
+        }
       }
-      else  // singular freezing based on Shima et al., 2020
+
+      // at most n_frz_sd new ice SDs (melted ones are not subtracted, n_ice_sd stays an upper bound)
+      n_ice_sd += n_frz_sd;
+
+      // Change ice to liquid droplets under the melting condition
+      if (melt)
       {
         thrust::for_each(
           thrust::make_zip_iterator(thrust::make_tuple(
@@ -172,42 +211,19 @@ namespace libcloudphxx
             ice_a.begin(),
             ice_c.begin(),
             ice_rho.begin(),
-            T_freeze.begin(),
-            thrust::make_permutation_iterator(T.begin(), ijk.begin()),
-            thrust::make_permutation_iterator(RH.begin(), ijk.begin())
+            thrust::make_permutation_iterator(T.begin(), ijk.begin())
           )),
           thrust::make_zip_iterator(thrust::make_tuple(
             rw2.begin(),
             ice_a.begin(),
             ice_c.begin(),
             ice_rho.begin(),
-            T_freeze.begin(),
-            thrust::make_permutation_iterator(T.begin(), ijk.begin()),
-            thrust::make_permutation_iterator(RH.begin(), ijk.begin())
+            thrust::make_permutation_iterator(T.begin(), ijk.begin())
           )) + n_part,
-            detail::singular_freeze<real_t>()  // functor for updating (rw2, a, c, rho_i) if freezing condition satisfied
+            detail::melt<real_t>()  // functor for updating (rw2, a, c, rho_i) if melting condition satisfied
         );
       }
 
-      // Change ice to liquid droplets under the melting condition
-      thrust::for_each(
-        thrust::make_zip_iterator(thrust::make_tuple(
-          rw2.begin(),
-          ice_a.begin(),
-          ice_c.begin(),
-          ice_rho.begin(),
-          thrust::make_permutation_iterator(T.begin(), ijk.begin())
-        )),
-        thrust::make_zip_iterator(thrust::make_tuple(
-          rw2.begin(),
-          ice_a.begin(),
-          ice_c.begin(),
-          ice_rho.begin(),
-          thrust::make_permutation_iterator(T.begin(), ijk.begin())
-        )) + n_part,
-          detail::melt<real_t>()  // functor for updating (rw2, a, c, rho_i) if melting condition satisfied
-      );
-
       // Compute per-cell 3rd moment of liquid droplets after freezing/melting. It is stored in count_mom
       moms_eq0(ice_a.begin()); // choose liquid particles (ice_a=0)
       moms_calc(rw2.begin(), real_t(1.5));
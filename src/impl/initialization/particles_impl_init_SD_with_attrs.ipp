@@ -0,0 +1,247 @@
+// vim:filetype=cpp
+/** @file
+  * @copyright University of Warsaw
+  * @section LICENSE
+  * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
+  * @brief initialisation routine for super droplets
+  */
+
+#include <algorithm>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // copy selected elements of a user array to the end of an SD vector
+      template <typename src_t, class vec_t>
+      void import_attr(
+        const src_t *src,
+        const std::vector<std::size_t> &ids,
+        vec_t &vec,
+        const thrust_size_t &n_part_old,
+        const src_t shift = 0
+      )
+      {
+        thrust::host_vector<typename vec_t::value_type> tmp(ids.size());
+        for(std::size_t i = 0; i < ids.size(); ++i)
+          tmp[i] = src[ids[i]] - shift;
+        thrust::copy(tmp.begin(), tmp.end(), vec.begin() + n_part_old);
+      }
+
+#if defined(USE_MPI)
+      // send selected elements of a user array on process 0 to the other processes,
+      // ids are grouped by the destination process (cnt and dsp are used only on process 0)
+      template <typename T>
+      void scatter_attr(
+        const T *src,
+        const std::vector<std::size_t> &ids,
+        const std::vector<int> &cnt,
+        const std::vector<int> &dsp,
+        std::vector<T> &dst,
+        const int &rank
+      )
+      {
+        std::vector<T> tmp(rank == 0 ? ids.size() : 0);
+        for(std::size_t i = 0; i < tmp.size(); ++i)
+          tmp[i] = src[ids[i]];
+        MPI_CHECK(MPI_Scatterv(
+          tmp.data(), cnt.data(), dsp.data(), get_mpi_type<T>(),
+          dst.data(), dst.size(), get_mpi_type<T>(),
+          0, MPI_COMM_LIBCLOUD
+        ));
+      }
+#endif
+    };
+
+    // initialize SD parameters with pre-generated attributes (without analysis of size distributions);
+    // each GPU takes the SDs from its part of the domain, with MPI the SDs passed to process 0
+    // are sent to the processes that own them
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::init_SD_with_attrs(const sd_attrs_t<real_t> &user_attrs)
+    {
+      // x of the left edge of this subdomain in the coordinates of the whole domain
+      const real_t x_bfr = (n_x_bfr + mpi_n_x_bfr) * opts_init.dx;
+
+      const sd_attrs_t<real_t> *attrs_ptr = &user_attrs;
+#if defined(USE_MPI)
+      // SDs of this process received from process 0
+      sd_attrs_t<real_t> mpi_attrs;
+      std::vector<unsigned long long> mpi_n;
+      std::vector<real_t> mpi_rd3, mpi_kappa, mpi_x, mpi_y, mpi_z, mpi_rw2, mpi_rd2_insol;
+
+      if(distmem_mpi())
+      {
+        // x-ranges of all processes in the coordinates of the whole domain, increasing with rank
+        std::vector<real_t> x_lo(mpi_size), x_hi(mpi_size);
+        {
+          const real_t lo = opts_init.x0 + x_bfr,
+                       hi = opts_init.x1 + x_bfr;
+          MPI_CHECK(MPI_Allgather(&lo, 1, detail::get_mpi_type<real_t>(), x_lo.data(), 1, detail::get_mpi_type<real_t>(), detail::MPI_COMM_LIBCLOUD));
+          MPI_CHECK(MPI_Allgather(&hi, 1, detail::get_mpi_type<real_t>(), x_hi.data(), 1, detail::get_mpi_type<real_t>(), detail::MPI_COMM_LIBCLOUD));
+        }
+
+        // on process 0: ids of the SDs grouped by the owning process and sanity checks,
+        // info = {1 + id of the first SD outside of the domain in y or z (0 if none), no. of SDs with x outside of the domain, rw2 given, rd2_insol given}
+        std::vector<std::size_t> ids;
+        std::vector<int> cnt, dsp;
+        unsigned long long info[4] = {0, 0, 0, 0};
+        if(mpi_rank == 0)
+        {
+          std::vector<std::vector<std::size_t>> rank_ids(mpi_size);
+          for(std::size_t id = 0; id < user_attrs.n_sd; ++id)
+          {
+            const int r = int(std::upper_bound(x_lo.begin(), x_lo.end(), user_attrs.x[id]) - x_lo.begin()) - 1;
+            if(r < 0 || !(user_attrs.x[id] < x_hi[r]))
+            {
+              ++info[1];
+              continue;
+            }
+            if(info[0] == 0 && (
+              (opts_init.ny != 0 && !(user_attrs.y[id] >= opts_init.y0 && user_attrs.y[id] < opts_init.y1)) ||
+              (opts_init.nz != 0 && !(user_attrs.z[id] >= opts_init.z0 && user_attrs.z[id] < opts_init.z1))
+            ))
+              info[0] = id + 1;
+            rank_ids[r].push_back(id);
+          }
+          info[2] = user_attrs.rw2 != NULL;
+          info[3] = user_attrs.rd2_insol != NULL;
+
+          cnt.resize(mpi_size);
+          dsp.resize(mpi_size);
+          for(int r = 0; r < mpi_size; ++r)
+          {
+            cnt[r] = rank_ids[r].size();
+            dsp[r] = ids.size();
+            ids.insert(ids.end(), rank_ids[r].begin(), rank_ids[r].end());
+          }
+        }
+
+        // the same error on all processes
+        MPI_CHECK(MPI_Bcast(info, 4, MPI_UNSIGNED_LONG_LONG, 0, detail::MPI_COMM_LIBCLOUD));
+        if(info[0] != 0)
+          throw std::runtime_error(detail::formatter() << "libcloudph++: imported SD no. " << info[0] - 1 << " is outside of the domain");
+        if(info[1] != 0)
+          throw std::runtime_error(detail::formatter() << "libcloudph++: " << info[1] << " of the imported SDs have x outside of the domain");
+
+        int n_sd_loc;
+        MPI_CHECK(MPI_Scatter(cnt.data(), 1, MPI_INT, &n_sd_loc, 1, MPI_INT, 0, detail::MPI_COMM_LIBCLOUD));
+        mpi_attrs.n_sd = n_sd_loc;
+
+        mpi_n.resize(n_sd_loc);
+        detail::scatter_attr(user_attrs.n, ids, cnt, dsp, mpi_n, mpi_rank);
+        mpi_attrs.n = mpi_n.data();
+
+        mpi_rd3.resize(n_sd_loc);
+        detail::scatter_attr(user_attrs.rd3, ids, cnt, dsp, mpi_rd3, mpi_rank);
+        mpi_attrs.rd3 = mpi_rd3.data();
+
+        mpi_kappa.resize(n_sd_loc);
+        detail::scatter_attr(user_attrs.kappa, ids, cnt, dsp, mpi_kappa, mpi_rank);
+        mpi_attrs.kappa = mpi_kappa.data();
+
+        mpi_x.resize(n_sd_loc);
+        detail::scatter_attr(user_attrs.x, ids, cnt, dsp, mpi_x, mpi_rank);
+        mpi_attrs.x = mpi_x.data();
+
+        if(opts_init.ny != 0)
+        {
+          mpi_y.resize(n_sd_loc);
+          detail::scatter_attr(user_attrs.y, ids, cnt, dsp, mpi_y, mpi_rank);
+          mpi_attrs.y = mpi_y.data();
+        }
+
+        if(opts_init.nz != 0)
+        {
+          mpi_z.resize(n_sd_loc);
+          detail::scatter_attr(user_attrs.z, ids, cnt, dsp, mpi_z, mpi_rank);
+          mpi_attrs.z = mpi_z.data();
+        }
+
+        if(info[2])
+        {
+          mpi_rw2.resize(n_sd_loc);
+          detail::scatter_attr(user_attrs.rw2, ids, cnt, dsp, mpi_rw2, mpi_rank);
+          mpi_attrs.rw2 = mpi_rw2.data();
+        }
+
+        if(info[3] && opts_init.ice_switch)
+        {
+          mpi_rd2_insol.resize(n_sd_loc);
+          detail::scatter_attr(user_attrs.rd2_insol, ids, cnt, dsp, mpi_rd2_insol, mpi_rank);
+          mpi_attrs.rd2_insol = mpi_rd2_insol.data();
+        }
+
+        attrs_ptr = &mpi_attrs;
+      }
+#endif
+      const sd_attrs_t<real_t> &attrs = *attrs_ptr;
+
+      // SDs that belong to this subdomain
+      std::vector<std::size_t> ids;
+      for(std::size_t id = 0; id < attrs.n_sd; ++id)
+      {
+        if(opts_init.nx != 0 && !(attrs.x[id] >= opts_init.x0 + x_bfr && attrs.x[id] < opts_init.x1 + x_bfr))
+          continue;
+        if(
+          (opts_init.ny != 0 && !(attrs.y[id] >= opts_init.y0 && attrs.y[id] < opts_init.y1)) ||
+          (opts_init.nz != 0 && !(attrs.z[id] >= opts_init.z0 && attrs.z[id] < opts_init.z1))
+        )
+          throw std::runtime_error(detail::formatter() << "libcloudph++: imported SD no. " << id << " is outside of the domain");
+        ids.push_back(id);
+      }
+
+      // each SD inside the whole domain is taken by exactly one GPU, hence the SDs
+      // not taken anywhere have x outside of the whole domain
+      // (in multi_CUDA the sum over GPUs is checked in particles_t<real_t, multi_CUDA>::init_from_attrs,
+      // with MPI all the SDs received from process 0 are in this subdomain)
+      init_attrs_n_taken = ids.size();
+      if(!distmem_cuda() && init_attrs_n_taken != attrs.n_sd)
+        throw std::runtime_error(detail::formatter() << "libcloudph++: " << attrs.n_sd - init_attrs_n_taken << " of the imported SDs have x outside of the domain");
+
+      // update no of particles
+      n_part_old = n_part;
+      n_part_to_init = ids.size();
+      n_part += n_part_to_init;
+      hskpng_resize_npart();
+
+      detail::import_attr(attrs.n,     ids, n,     n_part_old);
+      detail::import_attr(attrs.rd3,   ids, rd3,   n_part_old);
+      detail::import_attr(attrs.kappa, ids, kpa,   n_part_old);
+      if (opts_init.nx != 0) detail::import_attr(attrs.x, ids, x, n_part_old, x_bfr);
+      if (opts_init.ny != 0) detail::import_attr(attrs.y, ids, y, n_part_old);
+      if (opts_init.nz != 0) detail::import_attr(attrs.z, ids, z, n_part_old);
+
+      // cell indices from positions (init_wet needs ijk)
+      hskpng_ijk();
+
+      if (opts_init.ice_switch)
+      {
+        if (attrs.rd2_insol != NULL)
+          detail::import_attr(attrs.rd2_insol, ids, rd2_insol, n_part_old);
+        else
+          init_insol_dry_sizes(0);
+        init_a_c_rho_ice();
+        if (! opts_init.time_dep_ice_nucl)
+        {
+          init_T_freeze();
+        }
+      }
+
+      // initialising wet radii
+      if (attrs.rw2 != NULL)
+        detail::import_attr(attrs.rw2, ids, rw2, n_part_old);
+      else
+        init_wet();
+
+      // chemistry, as in init_SD_with_sizes
+      if(opts_init.chem_switch){
+        init_chem();
+        init_chem_aq();
+        init_percell_sstp_chem();
+        chem_vol_ante();
+      }
+    }
+  };
+};
@@ -146,7 +146,6 @@ namespace libcloudphxx
       chem_rhs.resize(     (chem_rhs_fin - chem_rhs_beg) * n_part);
       chem_ante_rhs.resize((chem_rhs_beg - 0           ) * n_part);
       chem_post_rhs.resize((chem_all     - chem_rhs_fin) * n_part);
-      chem_stepper.adjust_size(chem_rhs);
 
       // helper iterators
       for (int i = 0; i < chem_all; ++i)
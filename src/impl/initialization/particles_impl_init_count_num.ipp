@@ -32,6 +32,7 @@ namespace libcloudphxx
     void particles_t<real_t, device>::impl::init_count_num_sd_conc(const real_t &ratio)
     {
       thrust::fill(count_num.begin(), count_num.end(), ratio * opts_init.sd_conc);
+      counted_epoch = 0;
     }
 
     // calculate number of droplets in a cell from concentration [1/m^3], taking into account cell volume and air density
@@ -88,6 +89,7 @@ namespace libcloudphxx
         count_num.begin(),
         arg::_1 / const_multi + real_t(0.5)
       );
+      counted_epoch = 0;
     }
 
     template <typename real_t, backend_t device>
@@ -95,6 +97,7 @@ namespace libcloudphxx
     {
       thrust::fill(count_num.begin(), count_num.end(), conc_count.second);
       //init_count_num_hlpr(conc_multi.first, conc_multi.second);
+      counted_epoch = 0;
     }
 
     template <typename real_t, backend_t device>
@@ -121,6 +124,7 @@ namespace libcloudphxx
     {
       // init count_num to number, but only in cells within the source area
       namespace arg = thrust::placeholders;
+      counted_epoch = 0;
 
       // indices of cells on edges of the box in which aerosol is created
       thrust_size_t i0 = opts_init.src_x0 / opts_init.dx + 0.5;
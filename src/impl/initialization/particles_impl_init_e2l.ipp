@@ -53,7 +53,18 @@ namespace libcloudphxx
       {
         namespace arg = thrust::placeholders;
         case 0:  
-          l2e[key][0] = 0;  
+          if (l2e[key].size() == 1)
+            l2e[key][0] = 0;  
+          else // ensemble of parcels, one element per parcel
+            thrust::transform(
+              // input
+              thrust::make_counting_iterator<int>(0),
+              thrust::make_counting_iterator<int>(0) + l2e[key].size(), 
+              // output
+              l2e[key].begin(), 
+              // op
+              arr.strides[0] * arg::_1
+            );
           break;
         case 1:
           assert(arr.strides[0] == 1);
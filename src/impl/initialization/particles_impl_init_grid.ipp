@@ -155,5 +155,37 @@ namespace libcloudphxx
 	default: assert(false && "TODO");
       }
     }
+
+    // size of the host buffer for copying Eulerian arrays (incl. Courant numbers with halos)
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::init_tmp_host_real_grid()
+    {
+      thrust_size_t n_grid;
+      switch (n_dims) // TODO: document that 3D is xyz, 2D is xz, 1D is x
+      {
+        case 3:
+          n_grid = std::max(std::max(
+            (opts_init.nx+2*halo_size+1) * (opts_init.ny+0) * (opts_init.nz+0), 
+            (opts_init.nx+2*halo_size) * (opts_init.ny+1) * (opts_init.nz+0)),
+            (opts_init.nx+2*halo_size) * (opts_init.ny+0) * (opts_init.nz+1)
+          );
+          break;
+        case 2:
+          n_grid = std::max(
+            (opts_init.nx+2*halo_size+1) * (opts_init.nz+0), 
+            (opts_init.nx+2*halo_size) * (opts_init.nz+1)
+          );
+          break;
+        case 1:
+          n_grid = opts_init.nx+2*halo_size+1;
+          break;
+        case 0:
+          n_grid = n_cell; // one per parcel of an ensemble
+          break;
+        default: assert(false); 
+      }
+      if (n_dims != 0) assert(n_grid > n_cell);
+      tmp_host_real_grid.resize(n_grid);
+    }
   };
 };
@@ -23,6 +23,14 @@ namespace libcloudphxx
       count_num.resize(n_cell);
       count_mom.resize(n_cell);
       count_n = 0;
+      hskpng_count_ijk.resize(n_cell);
+      counted_epoch = 0;
+      if (opts_init.coal_switch)
+      {
+        coal_scl.resize(n_cell);
+        coal_off.resize(n_cell);
+        coal_epoch = 0;
+      }
 
       // initialising device temporary arrays
       tmp_device_real_cell.resize(n_cell);
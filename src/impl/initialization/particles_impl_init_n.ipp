@@ -128,6 +128,24 @@ namespace libcloudphxx
             arg::_1 * arg::_2 / real_t(opts_init.dx * opts_init.dy * opts_init.dz)
           );
         }
+        // ensemble of parcels: multiplier was computed for dv of the first parcel
+        else if(n_cell > 1)
+        {
+          thrust::copy(
+            dv.begin(), dv.end(), // from
+            tmp_rhod.begin()          // to
+          );
+
+          thrust::transform(
+            tmp_real.begin(), tmp_real.begin() + n_part_to_init, 
+            thrust::make_permutation_iterator( // input - 2nd arg
+              tmp_rhod.begin(), 
+              tmp_ijk.begin()
+            ),
+            tmp_real.begin(),                       // output
+            arg::_1 * arg::_2 / real_t(tmp_rhod[0])
+          );
+        }
 
       // host -> device (includes casting from real_t to uint! and rounding)
       thrust::copy(
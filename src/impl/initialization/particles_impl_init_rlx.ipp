@@ -0,0 +1,119 @@
+// vim:filetype=cpp
+/** @file
+  * @copyright University of Warsaw
+  * @section LICENSE
+  * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
+  */
+#include <numeric>
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // domain volume at this height level
+      template <typename real_t>
+      struct hor_dv_eval
+      {
+        // note: having a copy of opts_init here causes CUDA crashes (alignment problems?)
+        const real_t
+          dz,
+          x0, y0, z0,
+          x1, y1, z1;
+
+        hor_dv_eval(const opts_init_t<real_t> &o) :
+          dz(o.dz),
+          x0(o.x0), y0(o.y0), z0(o.z0),
+          x1(o.x1), y1(o.y1), z1(o.z1)
+        {}
+
+        BOOST_GPU_ENABLED
+        real_t operator()(const int &k)
+        {
+#if !defined(__NVCC__)
+          using std::min;
+          using std::max;
+#endif
+          return
+            max(real_t(0),
+              (x1 - x0) *
+              (y1 - y0) * // NOTE: size in y is taken into account even in 2D!
+              (min((k + 1) * dz, z1) - max(k * dz, z0))
+            );
+        }
+      };
+    };
+
+    // analysis of the relaxation distributions (done once, the distributions do not change in time)
+    // and allocation of the vertical profiles used in rlx_dry_distros
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::init_rlx()
+    {
+      if(!opts_init.rlx_switch || opts_init.rlx_dry_distros.empty()) return;
+
+      rlx_distros.clear();
+
+      // ln(rd) ranges of all relax distributions
+      real_t tot_lnrd_rng = 0.;
+      for (typename opts_init_t<real_t>::rlx_dry_distros_t::const_iterator ddi = opts_init.rlx_dry_distros.begin(); ddi != opts_init.rlx_dry_distros.end(); ++ddi)
+      {
+        init_dist_analysis_sd_conc(
+          *(std::get<0>(ddi->second)),
+          opts_init.rlx_bins
+        );
+        rlx_distro_t rd;
+        rd.log_rd_min = log_rd_min;
+        rd.lnrd_bin_size = log_rd_max - log_rd_min; // divided by the number of bins below
+        assert(rd.lnrd_bin_size > 0);
+        tot_lnrd_rng += rd.lnrd_bin_size;
+        rlx_distros.push_back(rd);
+      }
+
+      // bins of each distribution (number of bins proportional to its ln(rd) range)
+      typename std::vector<rlx_distro_t>::iterator rd = rlx_distros.begin();
+      for (typename opts_init_t<real_t>::rlx_dry_distros_t::const_iterator ddi = opts_init.rlx_dry_distros.begin(); ddi != opts_init.rlx_dry_distros.end(); ++ddi, ++rd)
+      {
+        const auto &n_of_lnrd_stp(*(std::get<0>(ddi->second)));
+
+        const real_t lnrd_rng = rd->lnrd_bin_size;
+        const int n_bins = opts_init.rlx_bins * lnrd_rng / tot_lnrd_rng;
+        assert(n_bins>0);
+        rd->lnrd_bin_size = lnrd_rng / n_bins;
+        assert(rd->lnrd_bin_size > 0);
+
+        // bin edges (in rd3), on CPU because of small number of edges
+        rd->bin_rd3_left_edges.resize(n_bins+1);
+        std::iota(rd->bin_rd3_left_edges.begin(), rd->bin_rd3_left_edges.end(), 0); // fill with a 0,1,2,... sequence
+        std::transform(rd->bin_rd3_left_edges.begin(), rd->bin_rd3_left_edges.end(), rd->bin_rd3_left_edges.begin(), [log_rd_min_val=rd->log_rd_min, lnrd_bin_size=rd->lnrd_bin_size] (real_t bin_number) { return std::exp( 3 * (log_rd_min_val + bin_number * lnrd_bin_size)) ; }); // calculate left edges
+
+        // expected STP concentration in each bin
+        rd->expected_STP_conc.resize(n_bins);
+        for(int bin_number=0; bin_number<n_bins; ++bin_number)
+        {
+          const real_t bin_lnrd_center = rd->log_rd_min + (bin_number + 0.5) * rd->lnrd_bin_size;
+          rd->expected_STP_conc[bin_number] = n_of_lnrd_stp(bin_lnrd_center) * rd->lnrd_bin_size;
+          assert(rd->expected_STP_conc[bin_number] >= 0);
+        }
+      }
+
+      // vectors of size nz used in calculation of horizontal averages
+      rlx_hor_dv.resize(opts_init.nz);
+      rlx_hor_sum.resize(opts_init.nz);
+      rlx_hor_sum_count.resize(opts_init.nz);
+      rlx_hor_missing.resize(opts_init.nz);
+      rlx_hor_sum_k.resize(opts_init.nz);
+      rlx_expected_hor_sum.resize(opts_init.nz);
+      rlx_n_SD_to_create.resize(opts_init.nz);
+
+      init_rlx_hor_dv();
+    }
+
+    // volume of the domain at each level, recalculated when the x-slab changes in rebalance()
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::init_rlx_hor_dv()
+    {
+      thrust::transform(zero, zero + opts_init.nz, rlx_hor_dv.begin(), detail::hor_dv_eval<real_t>(opts_init));
+    }
+  };
+};
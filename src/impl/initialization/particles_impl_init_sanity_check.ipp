@@ -57,7 +57,7 @@ namespace libcloudphxx
       if (opts_init.chem_switch && opts_init.src_type!=src_t::off)
         throw std::runtime_error("libcloudph++: chemistry and aerosol source are not compatible");
 
-      if (opts_init.src_type==src_t::matching && opts_init.dry_distros.size() > 1)
+      if ((opts_init.src_type==src_t::matching || opts_init.src_type==src_t::matching_indexed) && opts_init.dry_distros.size() > 1)
         throw std::runtime_error("libcloudph++: For 'matching' CCN source, the initial aerosol distribution can only have one kappa value (na kappa matching done).");
 
       if (opts_init.src_type!=src_t::off && n_dims<2)
@@ -66,7 +66,7 @@ namespace libcloudphxx
       if(opts_init.dry_distros.size() > 1 && opts_init.chem_switch)
         throw std::runtime_error("libcloudph++: chemistry and multiple kappa distributions are not compatible");
 
-      if(opts_init.dry_distros.size() == 0 && opts_init.dry_sizes.size() == 0)
+      if(opts_init.dry_distros.size() == 0 && opts_init.dry_sizes.size() == 0 && init_attrs == NULL)
         throw std::runtime_error("libcloudph++: Both dry_distros and dry_sizes are undefined");
 
       if(opts_init.sd_conc_large_tail && opts_init.sd_conc == 0)
@@ -92,9 +92,21 @@ namespace libcloudphxx
           throw std::runtime_error("libcloudph++: !(z1 > z0 & z1 <= min(1,nz)*dz)");
       }
 
+      if (init_attrs != NULL)
+      {
+        if (init_attrs->n_sd > 0 && (init_attrs->n == NULL || init_attrs->rd3 == NULL || init_attrs->kappa == NULL))
+          throw std::runtime_error("libcloudph++: n, rd3 and kappa of the imported SDs are mandatory");
+        if (init_attrs->n_sd > 0 && (
+          (opts_init.nx > 0 && init_attrs->x == NULL) ||
+          (opts_init.ny > 0 && init_attrs->y == NULL) ||
+          (opts_init.nz > 0 && init_attrs->z == NULL)
+        ))
+          throw std::runtime_error("libcloudph++: positions of the imported SDs are mandatory in each dimension of the setup");
+      }
+
       if (opts_init.dt == 0) throw std::runtime_error("libcloudph++: please specify opts_init.dt");
       if (opts_init.sd_conc * opts_init.sd_const_multi != 0) throw std::runtime_error("libcloudph++: specify either opts_init.sd_conc or opts_init.sd_const_multi, not both");
-      if (opts_init.sd_conc == 0 && opts_init.sd_const_multi == 0 && opts_init.dry_sizes.size() == 0) throw std::runtime_error("libcloudph++: please specify opts_init.sd_conc, opts_init.sd_const_multi or opts_init.dry_sizes");
+      if (opts_init.sd_conc == 0 && opts_init.sd_const_multi == 0 && opts_init.dry_sizes.size() == 0 && init_attrs == NULL) throw std::runtime_error("libcloudph++: please specify opts_init.sd_conc, opts_init.sd_const_multi or opts_init.dry_sizes");
       if (opts_init.coal_switch)
       {
         if(opts_init.terminal_velocity == vt_t::undefined) throw std::runtime_error("libcloudph++: please specify opts_init.terminal_velocity or turn off opts_init.coal_switch");
@@ -166,13 +178,33 @@ namespace libcloudphxx
           throw std::runtime_error("libcloudph++: coalescence does not work with ice (turn off ice_switch or coal_switch).");
         if(opts_init.rlx_switch) // because we dont account for ice/water when matching and initializing aerosols from relaxation
           throw std::runtime_error("libcloudph++: relaxation does not work with ice.");
-        if(opts_init.src_type==src_t::matching) // because we dont account for ice/water when matching and initializing aerosols from this type of source
+        if(opts_init.src_type==src_t::matching || opts_init.src_type==src_t::matching_indexed) // because we dont account for ice/water when matching and initializing aerosols from this type of source
           throw std::runtime_error("libcloudph++: 'matching' source type does not work with ice.");
         if(opts_init.turb_cond_switch) // because we dont want to add SGS RH to RH_i
           throw std::runtime_error("libcloudph++: SGS condensation does not work with ice.");
         if(opts_init.exact_sstp_cond)
           throw std::runtime_error("libcloudph++: deposition works only with per-cell substepping");
       }
+
+      if(opts_init.n_ens < 1)
+        throw std::runtime_error("libcloudph++: opts_init.n_ens has to be positive");
+      if(opts_init.n_ens > 1)
+      {
+        if(n_dims > 0)
+          throw std::runtime_error("libcloudph++: ensemble of parcels (opts_init.n_ens > 1) works in 0D setup only");
+        if(distmem())
+          throw std::runtime_error("libcloudph++: ensemble of parcels (opts_init.n_ens > 1) does not work with distributed memory");
+      }
+
+      if(opts_init.rebalance_freq < 0)
+        throw std::runtime_error("libcloudph++: opts_init.rebalance_freq has to be non-negative");
+      if(opts_init.rebalance_freq > 0)
+      {
+        if(n_dims == 0)
+          throw std::runtime_error("libcloudph++: rebalancing of the MPI decomposition (opts_init.rebalance_freq) does not work in 0D setup");
+        if(opts_init.chem_switch) // because chem vectors are not copied between processes
+          throw std::runtime_error("libcloudph++: rebalancing of the MPI decomposition (opts_init.rebalance_freq) does not work with chemistry");
+      }
     }
   };
 };
@@ -83,14 +83,12 @@ namespace libcloudphxx
       // done using resize, because _bfr.end() is never used and we want to assert that buffer is large enough using the .size() function
       if(distmem())
       {
-        const int no_of_n_vctrs_copied(distmem_n_vctrs.size());
-        const int no_of_real_vctrs_copied(distmem_real_vctrs.size());
+        const std::size_t bfr_size = distmem_bfr_size(opts_init.n_sd_max / opts_init.nx / config.bfr_fraction); // for n rd3 rw2 kpa vt x y z  sstp_tmp_th/rv/rh/p, etc.
 
-        in_n_bfr.resize(no_of_n_vctrs_copied * opts_init.n_sd_max / opts_init.nx / config.bfr_fraction);     // for n
-        out_n_bfr.resize(no_of_n_vctrs_copied * opts_init.n_sd_max / opts_init.nx / config.bfr_fraction);
-
-        in_real_bfr.resize(no_of_real_vctrs_copied * opts_init.n_sd_max / opts_init.nx / config.bfr_fraction);     // for rd3 rw2 kpa vt x y z  sstp_tmp_th/rv/rh/p, etc.
-        out_real_bfr.resize(no_of_real_vctrs_copied * opts_init.n_sd_max / opts_init.nx / config.bfr_fraction);
+        in_bfr_lft.resize(bfr_size);
+        out_bfr_lft.resize(bfr_size);
+        in_bfr_rgt.resize(bfr_size);
+        out_bfr_rgt.resize(bfr_size);
       }
 
     // -------- inits done here before resize and reserve were separated. Left for debugging reasons. -----------
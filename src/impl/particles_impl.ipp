@@ -13,6 +13,7 @@
 #include <boost/numeric/odeint.hpp>
 #include <boost/numeric/odeint/external/thrust/thrust.hpp>
 
+#include <array>
 #include <map>
 #include <set>
 
@@ -34,10 +35,14 @@ namespace libcloudphxx
       // did density vary in this step
       bool var_rho;
 
+      // pre-generated SDs, set only during init_from_attrs()
+      const sd_attrs_t<real_t> *init_attrs;
+      unsigned long long init_attrs_n_taken; // number of the imported SDs taken by this process/GPU
+
       // member fields
       opts_init_t<real_t> opts_init; // a copy
       const int n_dims;
-      const thrust_size_t n_cell; 
+      thrust_size_t n_cell; // not const, because it changes if the MPI decomposition is rebalanced
       thrust_size_t n_part,            // total number of SDs
                     n_part_old,        // total number of SDs before source
                     n_part_to_init;    // number of SDs to be initialized by source
@@ -103,6 +108,19 @@ namespace libcloudphxx
              log_rd_max, // logarithm of the upper bound of the distr
              multiplier; // multiplier calculated for the above values
 
+      // analysis of each of the opts_init.rlx_dry_distros (in the order of the map), see init_rlx
+      struct rlx_distro_t
+      {
+        real_t log_rd_min, lnrd_bin_size;
+        std::vector<real_t> bin_rd3_left_edges, // n_bins + 1 edges
+                            expected_STP_conc;  // concentration in each bin at STP
+      };
+      std::vector<rlx_distro_t> rlx_distros;
+
+      // vertical profiles used in rlx_dry_distros (allocated in init_rlx)
+      thrust_device::vector<real_t> rlx_hor_dv, rlx_hor_sum, rlx_hor_sum_count, rlx_hor_missing, rlx_expected_hor_sum;
+      thrust_device::vector<thrust_size_t> rlx_hor_sum_k, rlx_n_SD_to_create; // n_SD_to_create could be bool, but then thrust::reduce does not add bools as expected
+
       // housekeeping data (per particle)
       thrust_device::vector<thrust_size_t> 
         ijk, // Eulerian grid cell indices (always zero for 0D); i, j and k use temporary vectors from tmp_device_size_part via i_gp, j_gp and k_gp; TODO: make ijk, sorted_id and sorted_ijk also use such temporary vectors?
@@ -118,6 +136,26 @@ namespace libcloudphxx
         count_mom; // statistical moment // TODO (perhaps tmp_device_real_cell could be referenced?)
       thrust_size_t count_n;
 
+      // copy of the count_ijk and count_n computed in hskpng_count (count_ijk and count_n are overwritten
+      // by the moment-counting diagnostics), valid as long as counted_epoch == layout_epoch
+      thrust_device::vector<thrust_size_t> hskpng_count_ijk;
+      thrust_size_t hskpng_count_n;
+
+      // per-cell coalescence scale factors and offsets of the first SD of a cell in sorted_id,
+      // valid as long as coal_epoch == layout_epoch (allocated only if coal_switch)
+      thrust_device::vector<real_t> coal_scl;
+      thrust_device::vector<thrust_size_t> coal_off;
+
+      // queue of diagnostic results, created at the first outbuf_enqueue()
+      std::unique_ptr<detail::outbuf_queue<real_t, thrust_device::vector<real_t>>> outbuf_q;
+
+      // spectrum diagnostics (kept between calls to avoid reallocation)
+      thrust_device::vector<real_t>
+        spec_edges, // bin edges
+        spec_mom;   // moments per (bin, cell) key
+      thrust_device::vector<thrust_size_t>
+        spec_key;   // (bin, cell) keys
+
       // Eulerian-Lagrangian interface vars
       thrust_device::vector<real_t> 
         rhod,    // dry air density
@@ -149,8 +187,22 @@ namespace libcloudphxx
       real_t dt;
       int sstp_cond, sstp_coal, sstp_chem, sstp_cond_act;
 
-      // sorting needed only for diagnostics and coalescence
-      bool sorted;
+      // particle layout epoch, incremented after any change of ijk or n_part (hskpng_ijk, recycling, sources,
+      // relaxation, copies between devices/processes); sorting (needed only for diagnostics and coalescence),
+      // per-cell SD counts and coalescence helpers store the epoch they were computed at and are reused
+      // until the layout changes (0 marks data that is not valid at all)
+      unsigned long long layout_epoch, sorted_epoch, counted_epoch, coal_epoch;
+      bool sorted() const { return sorted_epoch == layout_epoch; }
+
+      // phase-presence summary used to skip ice microphysics (see hskpng_phase_presence): extrema of T,
+      // number of ice SDs (an upper bound) and of liquid SDs that may freeze, layout_epoch of the last count
+      real_t T_min, T_max;
+      thrust_size_t n_ice_sd, n_frz_sd;
+      unsigned long long phase_epoch;
+
+      // dirty flag of the thermodynamic housekeeping, set whenever th, rv, rhod or p change
+      // (T, p, RH, RH_i, eta and dv are then recomputed in the next hskpng_Tpr)
+      bool Tpr_dirty;
 
       // true if coalescence timestep has to be reduced, accesible from both device and host code
       bool *increase_sstp_coal;
@@ -164,7 +216,10 @@ namespace libcloudphxx
       bool sstp_cond_exact_nomix_adaptive; // whether per-particle substepping with no mixing and adaptive substepping is used
 
       // timestep counter
-      n_t src_stp_ctr, rlx_stp_ctr;
+      n_t src_stp_ctr, rlx_stp_ctr, rebalance_stp_ctr;
+
+      // (cell, size bin) -> lowest id of an SD in it, one slot per new SD (see src_dry_distros_matching_indexed)
+      thrust_device::vector<thrust_size_t> src_slot;
 
       // maps linear Lagrangian component indices into Eulerian component linear indices
       // the map key is the address of the Thrust vector
@@ -184,6 +239,7 @@ namespace libcloudphxx
         > ... I think, the best steppers for stiff systems and thrust are the
         > runge_kutta_fehlberg78 or the bulirsch_stoer with a very high order. But
         > should benchmark both steppers and choose the faster one.
+        NOTE: a per-SD Rosenbrock scheme not using odeint is available with opts_init.chem_solver == chem_solver_t::ros2
       */
       boost::numeric::odeint::runge_kutta4<
         thrust_device::vector<real_t>, // state_type
@@ -195,6 +251,18 @@ namespace libcloudphxx
         boost::numeric::odeint::never_resizer
       > chem_stepper;
 
+      // chem state of SDs flagged in chem_flag_ante gathered into dense arrays for all the chemistry substeps of a step
+      thrust_size_t n_chem; // number of flagged SDs
+      thrust_device::vector<thrust_size_t> chem_cmp_id, chem_cmp_ijk; // their ids (grouped by cell) and cell indices
+      thrust_device::vector<real_t> 
+        chem_cmp_rhs, chem_cmp_other, // chem species (odeint state and the remaining ones)
+        chem_cmp_V, chem_cmp_T, chem_cmp_rhod,
+        chem_cmp_dm,  // multiplicity * change in mass of each trace gas species in chem_henry
+        chem_cell_dm; // its sum in each cell (chem_gas_n blocks of n_cell values)
+      std::vector<typename thrust_device::vector<real_t>::iterator >
+        chem_cmp_bgn, chem_cmp_end; // indexed with enum chem_species_t
+      thrust_device::vector<unsigned int> chem_dissoc_iter; // minfun evaluations in the last chem_dissoc (see diag_chem_dissoc_iter)
+
       // temporary data
       tmp_vector_pool<thrust::host_vector<real_t>>
         tmp_host_real_part,
@@ -274,6 +342,10 @@ namespace libcloudphxx
       // number of cells in devices to the left of this one
       thrust_size_t n_cell_bfr;
 
+      // nx in MPI processes to the left of this one (global x index of the first column of this process),
+      // set in the ctor and updated in rebalance()
+      int mpi_n_x_bfr;
+
       const int halo_size, // NOTE:  halo_size = 0 means that both x courant numbers in edge cells are known, what is equivalent to halo = 1 in libmpdata++
                            // NOTE2: halo means that some values of the Eulerian courant array are pointed to by more than one e2l, what could lead to race conditions if we wanted to sync out courants
                 halo_x, // number of cells in the halo for courant_x before first "real" cell, halo only in x
@@ -287,10 +359,20 @@ namespace libcloudphxx
       // x1 of the process to the left
       real_t lft_x1;
 
-      // in/out buffers for SDs copied from other GPUs
-      thrust_device::vector<n_t> in_n_bfr, out_n_bfr;
-      // TODO: real buffers could be replaced with tmp_device_real_part1/2 if sstp_cond>1
-      thrust_device::vector<real_t> in_real_bfr, out_real_bfr;
+      // in/out byte buffers for SDs copied from other GPUs/processes, one per direction,
+      // so that copies in both directions can be in flight at the same time;
+      // *_lft hold SDs going left, *_rgt SDs going right (layout: see detail::distmem_bfr_hdr_t)
+      thrust_device::vector<char> in_bfr_lft, out_bfr_lft, in_bfr_rgt, out_bfr_rgt;
+
+      // MPI copy of SDs started at the end of step_async, but not yet completed
+      bool mpi_exchange_pending;
+      // value of opts.rcyc to be used in post_copy done after a pending MPI copy is completed
+      bool post_copy_rcyc;
+
+#if defined(USE_MPI)
+      // requests of the pending MPI copy, indexed with the detail::tag_* message tags
+      std::array<MPI_Request, 2> req_send, req_recv;
+#endif
 
       // ids of sds to be copied with distmem
       // thrust_device::vector<thrust_size_t> &lft_id, &rgt_id;
@@ -302,6 +384,11 @@ namespace libcloudphxx
       // vectors copied between distributed memories (MPI, multi_CUDA), these are SD attributes
       std::set<std::pair<thrust_device::vector<real_t>*, real_t>>         distmem_real_vctrs; // pair of vector and its initial value
       std::set<thrust_device::vector<n_t>*>                               distmem_n_vctrs;
+      // the same vectors ordered by fixed attribute ids (see distmem_order()), this is their order in
+      // distmem buffers and in checkpoints; distmem_layout_sum is the checksum of the ids
+      std::vector<thrust_device::vector<real_t>*>                         distmem_real_ordered;
+      std::vector<thrust_device::vector<n_t>*>                            distmem_n_ordered;
+      unsigned long long                                                  distmem_layout_sum;
 //      std::set<thrust_device::vector<thrust_size_t>*>  distmem_size_vctrs; // no size vectors copied?
 //
       // vetors that are not in distmem_real_vctrs that need to be resized when the number of SDs changes, these are helper variables
@@ -330,6 +417,8 @@ namespace libcloudphxx
         selected_before_counting(false),
         should_now_run_cond(false),
         var_rho(false),
+        init_attrs(NULL),
+        init_attrs_n_taken(0),
         opts_init(_opts_init),
         n_dims( // 0, 1, 2 or 3
           _opts_init.nx/m1(_opts_init.nx) + 
@@ -339,22 +428,32 @@ namespace libcloudphxx
         n_cell(
           m1(_opts_init.nx) * 
           m1(_opts_init.ny) *
-          m1(_opts_init.nz)
+          m1(_opts_init.nz) *
+          std::max(1, _opts_init.n_ens) // ensemble of parcels
         ),
         zero(0),
         n_part(0),
-        sorted(false),
+        layout_epoch(1),
+        sorted_epoch(0),
+        counted_epoch(0),
+        coal_epoch(0),
+        phase_epoch(0),
+        Tpr_dirty(true),
         n_user_params(_opts_init.kernel_parameters.size()),
         rng(_opts_init.rng_seed),
         src_stp_ctr(0),
         rlx_stp_ctr(0),
+        rebalance_stp_ctr(0),
 	      bcond(bcond),
         n_x_bfr(0),
         n_cell_bfr(0),
+        mpi_n_x_bfr(0),
         mpi_rank(mpi_rank),
         mpi_size(mpi_size),
         lft_x1(-1),  // default to no
         rgt_x0(-1),  // MPI boudanry
+        mpi_exchange_pending(false),
+        post_copy_rcyc(false),
         // lft_id(i),   // note: reuses i vector
         // rgt_id(tmp_device_size_part),
         n_x_tot(n_x_tot),
@@ -408,34 +507,7 @@ namespace libcloudphxx
         *increase_sstp_coal = false;
 
         // initialising host temporary arrays
-        {
-          thrust_size_t n_grid;
-          switch (n_dims) // TODO: document that 3D is xyz, 2D is xz, 1D is x
-          {
-            case 3:
-              n_grid = std::max(std::max(
-                (opts_init.nx+2*halo_size+1) * (opts_init.ny+0) * (opts_init.nz+0), 
-                (opts_init.nx+2*halo_size) * (opts_init.ny+1) * (opts_init.nz+0)),
-                (opts_init.nx+2*halo_size) * (opts_init.ny+0) * (opts_init.nz+1)
-              );
-              break;
-            case 2:
-              n_grid = std::max(
-                (opts_init.nx+2*halo_size+1) * (opts_init.nz+0), 
-                (opts_init.nx+2*halo_size) * (opts_init.nz+1)
-              );
-              break;
-            case 1:
-              n_grid = opts_init.nx+2*halo_size+1;
-              break;
-            case 0:
-              n_grid = 1;
-              break;
-            default: assert(false); 
-          }
-          if (n_dims != 0) assert(n_grid > n_cell);
-          tmp_host_real_grid.resize(n_grid);
-        }
+        init_tmp_host_real_grid();
 
         // initializing distmem_real_vctrs - list of real_t vectors with properties of SDs that have to be copied/removed/recycled when a SD is copied/removed/recycled
         // NOTE: this does not include chemical stuff due to the way chem vctrs are organized! multi_CUDA / MPI does not work with chemistry as of now
@@ -493,6 +565,8 @@ namespace libcloudphxx
         // initializing distmem_n_vctrs - list of n_t vectors with properties of SDs that have to be copied/removed/recycled when a SD is copied/removed/recycled
         distmem_n_vctrs.insert(&n);
 
+        distmem_order();
+
         // number of required temporary real vectors of size npart
         int tmp_drp_no = 1;
         if(n_dims == 2) 
@@ -550,6 +624,7 @@ namespace libcloudphxx
       void init_SD_with_distros_const_multi(const common::unary_function<real_t> &);
       void init_SD_with_distros_finalize(const kappa_rd_insol_t<real_t> &, const bool unravel_ijk = true);
       void init_SD_with_sizes();
+      void init_SD_with_attrs(const sd_attrs_t<real_t> &);
       void init_sanity_check(
         const arrinfo_t<real_t>, const arrinfo_t<real_t>, const arrinfo_t<real_t>,
         const arrinfo_t<real_t>, const arrinfo_t<real_t>,
@@ -598,16 +673,22 @@ namespace libcloudphxx
       void init_sync();
       void init_grid();
       void init_hskpng_ncell();
+      void init_tmp_host_real_grid();
       void init_chem();
       void init_chem_aq();
       void init_perparticle_sstp();
       void init_percell_sstp_chem();
       void init_kernel();
       void init_vterm();
+      void init_rlx();
+      void init_rlx_hor_dv();
 
       void fill_outbuf(thrust::host_vector<real_t>&);
-      std::vector<real_t> fill_attr_outbuf(const std::string&);
-      void mpi_exchange();
+      unsigned long long outbuf_enqueue();
+      void fill_attr_outbuf(const std::string&, typename std::vector<real_t>::iterator);
+      std::vector<real_t> fill_attr_outbuf(const std::vector<std::string>&);
+      void mpi_exchange_start(const bool rcyc);
+      void mpi_exchange_finish();
 
            // rename hskpng_ -> step_?
       void hskpng_sort_helper(bool);
@@ -619,13 +700,15 @@ namespace libcloudphxx
       void hskpng_ijk();
       void hskpng_Tpr();
       void hskpng_mfp();
+      void hskpng_phase_presence();
+      bool ice_absent();
 
       void hskpng_vterm_all();
       void hskpng_vterm_invalid();
       void hskpng_approximate_rc2_invalid();
       void hskpng_tke();
-      void hskpng_turb_vel(const real_t &dt, const bool only_vertical = false);
-      void hskpng_turb_dot_ss();
+      void hskpng_turb_vel(const real_t &dt, const bool only_vertical = false, const bool turb_cond = false);
+      void hskpng_turb_tau_rlx(thrust_device::vector<real_t> &);
       void hskpng_remove_n0();
       void hskpng_resize_npart();
 
@@ -670,6 +753,15 @@ namespace libcloudphxx
         const real_t power,
         const bool specific = true
       );
+      std::vector<real_t> moms_spectrum(
+        const std::vector<real_t> &edges,
+        const thrust_device::vector<real_t> &vec,
+        const real_t power
+      );
+      void moms_dense(thrust_device::vector<real_t> &, const bool);
+      std::vector<real_t> moms_profile();
+      std::vector<real_t> moms_column();
+      real_t moms_domain();
 
       void mass_dens_estim(
         const typename thrust_device::vector<real_t>::iterator &vec_bgn,
@@ -731,6 +823,8 @@ namespace libcloudphxx
 
       void chem_vol_ante();
       void chem_flag_ante();
+      void chem_gather();
+      void chem_scatter();
       void chem_henry(const real_t &dt);
       void chem_dissoc();
       void chem_react(const real_t &dt);
@@ -743,6 +837,7 @@ namespace libcloudphxx
       void src(const src_dry_distros_t<real_t> &, const src_dry_sizes_t<real_t> &);
       void src_dry_distros_simple(const src_dry_distros_t<real_t> &);
       void src_dry_distros_matching(const src_dry_distros_t<real_t> &);
+      void src_dry_distros_matching_indexed(const src_dry_distros_t<real_t> &);
       void src_dry_distros(const src_dry_distros_t<real_t> &);
       void src_dry_sizes( const src_dry_sizes_t<real_t> &);
 
@@ -761,7 +856,7 @@ namespace libcloudphxx
       void sstp_percell_step_chem(const int &step);
       void sstp_save_chem();
 
-      void post_copy(const opts_t<real_t>&);
+      void post_copy(const bool rcyc);
 
       // two functions for calculating changes in rv and th due to condensation on SDs initialized during simulation, e.g. via source or relaxation
       // NOTE: curently not used, because of small sizes of these droplets
@@ -774,16 +869,25 @@ namespace libcloudphxx
       bool distmem_mpi();
       bool distmem_cuda();
       bool distmem();
-      void pack_n_lft();
-      void pack_n_rgt();
-      void pack_real_lft();
-      void pack_real_rgt();
-      void unpack_n(const int &);
-      void unpack_real(const int &);
+      std::size_t distmem_bfr_size(const thrust_size_t &);
+      void distmem_order();
+      unsigned long long distmem_layout();
+      void pack(thrust_device::vector<char> &, const thrust_device::vector<thrust_size_t> &, const thrust_size_t &);
+      void pack_lft();
+      void pack_rgt();
+      void unpack(const thrust_device::vector<char> &);
       void flag_lft();
       void flag_rgt();
       void bcnd_remote_lft(const real_t &, const real_t &);
       void bcnd_remote_rgt(const real_t &, const real_t &);
+      void rebalance();
+      void rebalance_cell_vctr(thrust_device::vector<real_t> &, const std::vector<int> &, const std::vector<int> &);
+
+      // checkpointing
+      std::string checkpoint_path(const std::string &);
+      std::vector<thrust_device::vector<real_t>*> checkpoint_real_vctrs();
+      void save_state(const std::string &);
+      void load_state(const std::string &);
     };
   };
 };
@@ -21,6 +21,9 @@ namespace libcloudphxx
 
       assert(to.size() >= l2e[&to].size());
 
+      if (&to == &th || &to == &rv || &to == &rhod || &to == &p)
+        Tpr_dirty = true;
+
       auto host_consec_g = tmp_host_real_grid.get_guard();
       thrust::host_vector<real_t> &host_consec = host_consec_g.get();
 
@@ -13,7 +13,7 @@ namespace libcloudphxx
     void particles_t<real_t, device>::impl::post_adding_SD()
     {   
       // --- after source particles are no longer sorted ---
-      sorted = false;
+      ++layout_epoch;
 
       // --- calc liquid water content after src ---
       calc_liq_ice_content_change();
@@ -7,7 +7,6 @@
 // #include <limits>
 #include <thrust/unique.h>
 #include <thrust/binary_search.h>
-#include <numeric>
 
 
 namespace libcloudphxx
@@ -49,38 +48,6 @@ namespace libcloudphxx
           : 0;
         }
       };
-
-      // domain volume at this height level
-      template <typename real_t>
-      struct hor_dv_eval
-      {
-        // note: having a copy of opts_init here causes CUDA crashes (alignment problems?)
-        const real_t
-          dz,
-          x0, y0, z0,
-          x1, y1, z1;
-
-        hor_dv_eval(const opts_init_t<real_t> &o) :
-          dz(o.dz),
-          x0(o.x0), y0(o.y0), z0(o.z0),
-          x1(o.x1), y1(o.y1), z1(o.z1)
-        {}
-
-        BOOST_GPU_ENABLED
-        real_t operator()(const int &k)
-        {
-#if !defined(__NVCC__)
-          using std::min;
-          using std::max;
-#endif
-          return
-            max(real_t(0),
-              (x1 - x0) *
-              (y1 - y0) * // NOTE: size in y is taken into account even in 2D!
-              (min((k + 1) * dz, z1) - max(k * dz, z0))
-            );
-        }
-      };
     };
 
     // create new aerosol particles to relax towards a size distribution
@@ -89,53 +56,27 @@ namespace libcloudphxx
     {   
       namespace arg = thrust::placeholders;
 
-      // vectors of size nz used in calculation of horizontal averages, TODO: allocate them at init
-      thrust_device::vector<real_t> hor_sum(opts_init.nz);
-      thrust_device::vector<real_t> hor_sum_count(opts_init.nz);
-      thrust_device::vector<real_t> hor_missing(opts_init.nz);
-      thrust_device::vector<thrust_size_t> hor_sum_k(opts_init.nz);
-      thrust_device::vector<real_t> expected_hor_sum(opts_init.nz);
-      thrust_device::vector<thrust_size_t> n_SD_to_create(opts_init.nz); // could be bool, but then thrust::reduce does not add bools as expected
-
-      // calc sum of ln(rd) ranges of all relax distributions
-      real_t tot_lnrd_rng = 0.;
-      for (typename opts_init_t<real_t>::rlx_dry_distros_t::const_iterator ddi = opts_init.rlx_dry_distros.begin(); ddi != opts_init.rlx_dry_distros.end(); ++ddi)
-      {
-        init_dist_analysis_sd_conc(
-          *(std::get<0>(ddi->second)),
-          opts_init.rlx_bins
-        );
-        tot_lnrd_rng += log_rd_max - log_rd_min;
-      }
+      // vectors of size nz used in calculation of horizontal averages, allocated in init_rlx
+      thrust_device::vector<real_t> &hor_sum(rlx_hor_sum);
+      thrust_device::vector<real_t> &hor_sum_count(rlx_hor_sum_count);
+      thrust_device::vector<real_t> &hor_missing(rlx_hor_missing);
+      thrust_device::vector<thrust_size_t> &hor_sum_k(rlx_hor_sum_k);
+      thrust_device::vector<real_t> &expected_hor_sum(rlx_expected_hor_sum);
+      thrust_device::vector<thrust_size_t> &n_SD_to_create(rlx_n_SD_to_create);
+      assert(hor_sum.size() == opts_init.nz && rlx_distros.size() == opts_init.rlx_dry_distros.size());
 
       const auto n_part_pre_relax = n_part;
 
       // initialize SDs of each kappa-type
-      for (typename opts_init_t<real_t>::rlx_dry_distros_t::const_iterator ddi = opts_init.rlx_dry_distros.begin(); ddi != opts_init.rlx_dry_distros.end(); ++ddi)
+      typename std::vector<rlx_distro_t>::const_iterator rd = rlx_distros.begin();
+      for (typename opts_init_t<real_t>::rlx_dry_distros_t::const_iterator ddi = opts_init.rlx_dry_distros.begin(); ddi != opts_init.rlx_dry_distros.end(); ++ddi, ++rd)
       {
         const auto &kappa(ddi->first);
         assert(kappa >= 0);
-        const auto &n_of_lnrd_stp(*(std::get<0>(ddi->second)));
-
-        // analyze distribution to get rd_min and max needed for bin sizes
-        // TODO: this was done a moment ago!
-        // TODO2: this could be done once at the start of the simulation!
-        init_dist_analysis_sd_conc(
-          n_of_lnrd_stp,
-          opts_init.rlx_bins
-        );
-        const real_t lnrd_rng = log_rd_max - log_rd_min;
-        assert(lnrd_rng > 0);
-
-        // calculate bin edges (in rd3)
-        // tmp vector with bin edges, probably could be allocated once in init
-        const int n_bins = opts_init.rlx_bins * lnrd_rng / tot_lnrd_rng;
-        assert(n_bins>0);
-        const real_t lnrd_bin_size = lnrd_rng / n_bins;
-        assert(lnrd_bin_size > 0);
-        std::vector<real_t> bin_rd3_left_edges(n_bins+1); // on CPU because of small number of edges
-        std::iota(bin_rd3_left_edges.begin(), bin_rd3_left_edges.end(), 0); // fill with a 0,1,2,... sequence
-        std::transform(bin_rd3_left_edges.begin(), bin_rd3_left_edges.end(), bin_rd3_left_edges.begin(), [log_rd_min_val=log_rd_min, lnrd_bin_size] (real_t bin_number) { return std::exp( 3 * (log_rd_min_val + bin_number * lnrd_bin_size)) ; }); // calculate left edges
+
+        // bin edges (in rd3) and expected concentrations from the analysis of the distribution in init_rlx
+        const std::vector<real_t> &bin_rd3_left_edges(rd->bin_rd3_left_edges);
+        const real_t lnrd_bin_size = rd->lnrd_bin_size;
 
         // minimum and maximum cell indices
         const int z_min_index = (std::get<2>(ddi->second)).first  / opts_init.dz,
@@ -147,8 +88,6 @@ namespace libcloudphxx
 
         const auto n_part_pre_bins_loop = n_part;
 
-        real_t expected_STP_concentration_tot = 0;
-
         // loop over the bins
         for(int bin_number=0; bin_number<bin_rd3_left_edges.size()-1; ++bin_number)
         {
@@ -183,12 +122,8 @@ namespace libcloudphxx
 //          thrust::transform(hor_sum.begin(), hor_sum.end(), hor_sum.begin(), arg::_1 / (opts_init.nx * m1(opts_init.ny)));
           
           // calculate expected CCN number
-          const real_t bin_lnrd_center = log_rd_min + (bin_number + 0.5) * lnrd_bin_size;
-          const real_t expected_STP_concentration = n_of_lnrd_stp(bin_lnrd_center) * lnrd_bin_size;
-          assert(expected_STP_concentration >= 0);
-          expected_STP_concentration_tot += expected_STP_concentration;
-          thrust::transform(zero, zero + opts_init.nz, expected_hor_sum.begin(), detail::hor_dv_eval<real_t>(opts_init)); // fill with volume of the domain at this level
-          thrust::transform(expected_hor_sum.begin(), expected_hor_sum.end(), expected_hor_sum.begin(), expected_STP_concentration * arg::_1); // multiply by the expected concentration
+          const real_t expected_STP_concentration = rd->expected_STP_conc.at(bin_number);
+          thrust::transform(rlx_hor_dv.begin(), rlx_hor_dv.end(), expected_hor_sum.begin(), expected_STP_concentration * arg::_1); // volume of the domain at this level times the expected concentration
 
           // TODO: check for overflows?
  
@@ -308,7 +243,7 @@ namespace libcloudphxx
 
         // TODO: asserts of newly added SD parameters? e.g. how many SD, how big is multiplicity etc.
       } // end of the distros loop
-      sorted = false;
+      ++layout_epoch;
     }
   };  
 };
@@ -19,11 +19,13 @@ namespace libcloudphxx
       if (sdd.size() > 1)
         throw std::runtime_error("libcloudph++: src_dry_distros can only have a single kappa value.");
 
-      if (opts_init.src_type == src_t::matching && !sdd.empty() && sdd.begin()->first.kappa != opts_init.dry_distros.begin()->first.kappa)
+      if ((opts_init.src_type == src_t::matching || opts_init.src_type == src_t::matching_indexed) && !sdd.empty() && sdd.begin()->first.kappa != opts_init.dry_distros.begin()->first.kappa)
         throw std::runtime_error("libcloudph++: For 'matching' CCN source, kappa of the source has to be the same as that of the initial profile (no kappa matching done)");
 
       if(opts_init.src_type == src_t::matching)
         src_dry_distros_matching(sdd);
+      if(opts_init.src_type == src_t::matching_indexed)
+        src_dry_distros_matching_indexed(sdd);
       if(opts_init.src_type == src_t::simple)
         src_dry_distros_simple(sdd);
     }
@@ -272,6 +272,7 @@ namespace libcloudphxx
             tmp_bin_no.begin() + count_bins,
             thrust::make_permutation_iterator(count_num.begin(), sorted_ijk.begin())
           );
+          counted_epoch = 0;
           // sorted_ijk no longer valid
         }
 
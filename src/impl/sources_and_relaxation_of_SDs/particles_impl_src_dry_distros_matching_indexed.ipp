@@ -0,0 +1,193 @@
+// vim:filetype=cpp
+/** @file
+  * @copyright University of Warsaw
+  * @section LICENSE
+  * GPLv3+ (see the COPYING file or http://www.gnu.org/licenses/)
+  */
+
+namespace libcloudphxx
+{
+  namespace lgrngn
+  {
+    namespace detail
+    {
+      // *addr = min(*addr, val), safe if called concurrently for the same addr
+      BOOST_GPU_ENABLED
+      inline void atomic_min(thrust_size_t *addr, const thrust_size_t &val)
+      {
+#if defined(__CUDA_ARCH__)
+        static_assert(sizeof(thrust_size_t) == sizeof(unsigned long long), "atomicMin on 64-bit integers expected");
+        atomicMin(reinterpret_cast<unsigned long long*>(addr), (unsigned long long)val);
+#else
+        thrust_size_t old = __atomic_load_n(addr, __ATOMIC_RELAXED);
+        while (val < old && !__atomic_compare_exchange_n(addr, &old, val, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+#endif
+      }
+
+      // stores the id of an SD in the (cell, size bin) slot it falls into;
+      // slots exist only in cells with new SDs (ptr: number of slots in cells up to this one);
+      // if many SDs fall into one slot, the one with the lowest id is kept
+      template<typename real_t, typename n_t, n_t out_of_bins>
+      struct src_slot_fill
+      {
+        thrust_size_t *slot;
+        const real_t log_rd_min, log_rd_max;
+
+        src_slot_fill(thrust_size_t *slot, const real_t &log_rd_min, const real_t &log_rd_max) :
+          slot(slot), log_rd_min(log_rd_min), log_rd_max(log_rd_max)
+        {}
+
+        template <class tpl_t>
+        BOOST_GPU_ENABLED
+        void operator()(const tpl_t &tpl) const
+        {
+          const thrust_size_t bin = get_bin_no<real_t, n_t, thrust_size_t, out_of_bins>(log_rd_min, log_rd_max)(thrust::get<1>(tpl), thrust::get<3>(tpl)); // rd3, count_num
+          if (bin != out_of_bins)
+            atomic_min(slot + thrust::get<2>(tpl) + bin, thrust::get<0>(tpl)); // ptr, id
+        }
+      };
+
+      // adds multiplicity of the new SD to the matched one
+      template <typename n_t>
+      struct src_add_to_match
+      {
+        n_t *n;
+        const thrust_size_t no_match;
+
+        src_add_to_match(n_t *n, const thrust_size_t &no_match) : n(n), no_match(no_match) {}
+
+        template <class tpl_t>
+        BOOST_GPU_ENABLED
+        void operator()(const tpl_t &tpl) const
+        {
+          if (thrust::get<0>(tpl) != no_match)
+            n[thrust::get<0>(tpl)] += thrust::get<1>(tpl);
+        }
+      };
+    };
+
+    // same as src_dry_distros_matching, but the SDs to be matched are found with a (cell, size bin) -> SD id
+    // lookup table filled in one pass over the existing SDs, instead of sorting them by cell and dry radius;
+    // the new SDs in each cell are one per size bin, sorted by bin (see init_dry_sd_conc) and placed cell by cell
+    // (see init_ijk), so the table has one slot per new SD, in the same order, and each existing SD is matched at most once
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::impl::src_dry_distros_matching_indexed(const src_dry_distros_t<real_t> &sdd)
+    {   
+      namespace arg = thrust::placeholders;
+
+      auto p_sdd = sdd.cbegin();
+
+      // add the source only once every number of steps
+      assert(get<2>(p_sdd->second) > 0);
+      if(src_stp_ctr % get<2>(p_sdd->second) != 0) return;
+
+      const real_t sup_dt = get<2>(p_sdd->second) * opts_init.dt;
+      const thrust_size_t n_bins = get<1>(p_sdd->second); // number of size bins = number of new SDs in a cell within the source area
+
+      // set number of SDs to init; use count_num as storage
+      init_count_num_src(n_bins);
+
+      // analyze distribution to get rd_min and max needed for bin sizes
+      init_dist_analysis_sd_conc(
+        *get<0>(p_sdd->second),
+        n_bins,
+        sup_dt
+      ); 
+
+      const thrust_size_t out_of_bins = 4444444444; // would cause an error for src_sd_conc > out_of_bins
+      const thrust_size_t no_match = thrust_size_t(-1);
+
+      // --- fill the (cell, bin) table with the existing SDs ---
+      n_part_to_init = thrust::reduce(count_num.begin(), count_num.end());
+      src_slot.resize(n_part_to_init);
+      thrust::fill(src_slot.begin(), src_slot.end(), no_match);
+      {
+        auto ptr_g = tmp_device_size_cell.get_guard();
+        thrust_device::vector<thrust_size_t> &ptr(ptr_g.get());
+        thrust::exclusive_scan(count_num.begin(), count_num.end(), ptr.begin()); // number of SDs to init in cells up to (i-1)
+
+        thrust::for_each(
+          thrust::make_zip_iterator(thrust::make_tuple(
+            zero,
+            rd3.begin(),
+            thrust::make_permutation_iterator(ptr.begin(), ijk.begin()),
+            thrust::make_permutation_iterator(count_num.begin(), ijk.begin())
+          )),
+          thrust::make_zip_iterator(thrust::make_tuple(
+            zero,
+            rd3.begin(),
+            thrust::make_permutation_iterator(ptr.begin(), ijk.begin()),
+            thrust::make_permutation_iterator(count_num.begin(), ijk.begin())
+          )) + n_part,
+          detail::src_slot_fill<real_t, n_t, out_of_bins>(thrust::raw_pointer_cast(src_slot.data()), log_rd_min, log_rd_max)
+        );
+      }
+
+      // --- init ijk, rd3 and n of new SDs ---
+      n_part_old = n_part;
+      n_part = n_part_old + n_part_to_init;
+      hskpng_resize_npart();
+
+      init_ijk();
+      init_dry_sd_conc(); 
+      init_n_sd_conc(
+        *get<0>(p_sdd->second)
+      ); // TODO: document that n_of_lnrd_stp is expected!
+
+      // --- increase multiplicity of the matched SDs (src_slot[i] is the match of the i-th new SD) ---
+      thrust::for_each(
+        thrust::make_zip_iterator(thrust::make_tuple(
+          src_slot.begin(),
+          n.begin() + n_part_old
+        )),
+        thrust::make_zip_iterator(thrust::make_tuple(
+          src_slot.end(),
+          n.end()
+        )),
+        detail::src_add_to_match<n_t>(thrust::raw_pointer_cast(n.data()), no_match)
+      );
+      // TODO: check for overflows of na after addition
+
+      // --- remove new SDs that have a match ---
+      const thrust_size_t n_unmatched = thrust::count(src_slot.begin(), src_slot.end(), no_match);
+      thrust::remove_if(
+        thrust::make_zip_iterator(thrust::make_tuple(
+          rd3.begin() + n_part_old,
+          ijk.begin() + n_part_old,
+          n.begin() + n_part_old
+        )),
+        thrust::make_zip_iterator(thrust::make_tuple(
+          rd3.begin() + n_part_old,
+          ijk.begin() + n_part_old,
+          n.begin() + n_part_old
+        )) + n_part_to_init,
+        src_slot.begin(),
+        arg::_1 != no_match
+      );
+      n_part = n_part_old + n_unmatched;
+      n_part_to_init = n_unmatched;
+      hskpng_resize_npart();
+
+      // --- init other properties of SDs that didnt have a match ---
+      init_kappa(
+        p_sdd->first.kappa
+      );
+
+      if(opts_init.diag_incloud_time)
+        init_incloud_time();
+
+      // init rw
+      init_wet();
+  
+      // ijk -> i, j, k
+      unravel_ijk(n_part_old);
+
+      // init x, y, z, i, j, k
+      init_xyz();
+
+      // TODO: init chem
+
+      ++layout_epoch;
+    }
+  };  
+};
@@ -47,7 +47,10 @@ namespace libcloudphxx
   
         if(glob_opts_init.nx == 0)
           throw std::runtime_error("libcloudph++: multi_CUDA doesn't work for 0D setup.");
-  
+
+        if(glob_opts_init.rebalance_freq > 0)
+          throw std::runtime_error("libcloudph++: multi_CUDA is not compatible with rebalancing of the MPI decomposition. Use other backend or set opts_init.rebalance_freq to 0.");
+
         if (!(glob_opts_init.x1 > glob_opts_init.x0 && glob_opts_init.x1 <= glob_opts_init.nx * glob_opts_init.dx))
           throw std::runtime_error("libcloudph++: !(x1 > x0 & x1 <= min(1,nx)*dx)");
   
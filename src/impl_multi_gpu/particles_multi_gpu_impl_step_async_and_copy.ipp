@@ -42,20 +42,13 @@ namespace libcloudphxx
       if((opts.adve || opts.turb_adve) && glob_opts_init.dev_count>1)
       {
         namespace arg = thrust::placeholders;
-        typedef unsigned long long n_t; // TODO: same typedef is in impl struct !! particles::impl::n_t ? 
 
         // helper aliases
-        const thrust_size_t &lft_count(particles[dev_id]->pimpl->lft_count);
-        const thrust_size_t &rgt_count(particles[dev_id]->pimpl->rgt_count);
-        auto &n_part(particles[dev_id]->pimpl->n_part);
-        auto &n_part_old(particles[dev_id]->pimpl->n_part_old);
-      	const int &distmem_real_vctrs_count(particles[dev_id]->pimpl->distmem_real_vctrs.size());
-        thrust_device::vector<real_t> &out_real_bfr(particles[dev_id]->pimpl->out_real_bfr);
-        thrust_device::vector<real_t> &in_real_bfr(particles[dev_id]->pimpl->in_real_bfr);
-        thrust_device::vector<real_t> &x(particles[dev_id]->pimpl->x);
-        thrust_device::vector<n_t> &out_n_bfr(particles[dev_id]->pimpl->out_n_bfr);
-        thrust_device::vector<n_t> &in_n_bfr(particles[dev_id]->pimpl->in_n_bfr);
-        std::pair<detail::bcond_t, detail::bcond_t> &bcond(particles[dev_id]->pimpl->bcond);
+        auto &pimpl(particles[dev_id]->pimpl);
+        auto &n_part(pimpl->n_part);
+        auto &n_part_old(pimpl->n_part_old);
+        thrust_device::vector<real_t> &x(pimpl->x);
+        std::pair<detail::bcond_t, detail::bcond_t> &bcond(pimpl->bcond);
 
         // IDs of devices to the left/right, periodic_ext boundary in x
         const int lft_dev = dev_id > 0 ? dev_id - 1 : glob_opts_init.dev_count - 1,
@@ -65,136 +58,71 @@ namespace libcloudphxx
         gpuErrchk(cudaStreamCreate(&streams[dev_id]));
         gpuErrchk(cudaEventCreateWithFlags(&events[dev_id], cudaEventDisableTiming ));
 
-        // prepare buffer with n_t to be copied left
+        // pack SDs to be copied left and start async copy of the buffer to the left device
         if(bcond.first == detail::distmem_cuda)
         {
-          // prepare buffer with n_t to be copied left
-          // TODO: serialize n_t and real_t with boost serialize
-          particles[dev_id]->pimpl->pack_n_lft();
+          // adjust x of prtcls to be sent left to match new device's domain
+          pimpl->bcnd_remote_lft(particles[dev_id]->opts_init->x0, particles[lft_dev]->opts_init->x1);
+          pimpl->pack_lft();
 
-          // start async copy of n buffer to the left
           gpuErrchk(cudaMemcpyPeerAsync(
-            particles[lft_dev]->pimpl->in_n_bfr.data().get(), lft_dev,  //dst
-            out_n_bfr.data().get(), dev_id,                             //src 
-            lft_count * sizeof(n_t),                                    //no of bytes
-            streams[dev_id]                                             //best performance if stream belongs to src
+            particles[lft_dev]->pimpl->in_bfr_lft.data().get(), lft_dev,  //dst
+            pimpl->out_bfr_lft.data().get(), dev_id,                      //src 
+            pimpl->distmem_bfr_size(pimpl->lft_count),                    //no of bytes
+            streams[dev_id]                                               //best performance if stream belongs to src
           ));
-          // record beginning of copying
-          gpuErrchk(cudaEventRecord(events[dev_id], streams[dev_id]));
-        }
-
-        // barrier to make sure that all devices started copying
-        barrier.wait();
-
-        // adjust x of prtcls to be sent left to match new device's domain
-        if(bcond.first == detail::distmem_cuda)
-        {
-          // adjust x of prtcls to be sent left to match new device's domain
-          particles[dev_id]->pimpl->bcnd_remote_lft(particles[dev_id]->opts_init->x0, particles[lft_dev]->opts_init->x1);
-
-          // prepare the real_t buffer for copy left
-          particles[dev_id]->pimpl->pack_real_lft();
         }
 
+        // same to the right; same stream, so both copies are done when the event is reached
         if(bcond.second == detail::distmem_cuda)
         {
-          // wait for the copy of n from right into current device to finish
-          gpuErrchk(cudaEventSynchronize(events[rgt_dev]));
-          // unpack the n buffer sent to this device from right
-          particles[dev_id]->pimpl->unpack_n(particles[rgt_dev]->pimpl->lft_count); // also sets n_part_old and n_part
-        }
+          // adjust x of prtcls to be sent right to match new device's domain
+          pimpl->bcnd_remote_rgt(particles[dev_id]->opts_init->x1, particles[rgt_dev]->opts_init->x0);
+          pimpl->pack_rgt();
 
-        // start async copy of real buffer to the left; same stream as n_bfr - will start only if previous copy finished
-        if(bcond.first == detail::distmem_cuda)
-        {
           gpuErrchk(cudaMemcpyPeerAsync(
-            particles[lft_dev]->pimpl->in_real_bfr.data().get(), lft_dev,  //dst
-            out_real_bfr.data().get(), dev_id,                             //src 
-            distmem_real_vctrs_count * lft_count * sizeof(real_t),                 //no of bytes
-            streams[dev_id]                                                //best performance if stream belongs to src
+            particles[rgt_dev]->pimpl->in_bfr_rgt.data().get(), rgt_dev,  //dst
+            pimpl->out_bfr_rgt.data().get(), dev_id,                      //src 
+            pimpl->distmem_bfr_size(pimpl->rgt_count),                    //no of bytes
+            streams[dev_id]                                               //best performance if stream belongs to src
           ));
-          // record beginning of copying
-          gpuErrchk(cudaEventRecord(events[dev_id], streams[dev_id]));
         }
+        // record the end of copying
+        gpuErrchk(cudaEventRecord(events[dev_id], streams[dev_id]));
+
         // barrier to make sure that all devices started copying
         barrier.wait();
 
+        // flag SDs sent left/right for removal
+        if(bcond.first == detail::distmem_cuda)
+          pimpl->flag_lft(); 
         if(bcond.second == detail::distmem_cuda)
-        {
-          // prepare buffer with n_t to be copied right
-          particles[dev_id]->pimpl->pack_n_rgt();
+          pimpl->flag_rgt(); 
 
-          // adjust x of prtcls to be sent right to match new device's domain
-          particles[dev_id]->pimpl->bcnd_remote_rgt(particles[dev_id]->opts_init->x1, particles[rgt_dev]->opts_init->x0);
-
-          // wait for the copy of real from right into current device to finish
+        if(bcond.second == detail::distmem_cuda)
+        {
+          // wait for the copy from right into current device to finish
           gpuErrchk(cudaEventSynchronize(events[rgt_dev]));
-
-          // unpack the real buffer sent to this device from right
-          particles[dev_id]->pimpl->unpack_real(particles[rgt_dev]->pimpl->lft_count);
+          // unpack the buffer sent to this device from right, also sets n_part_old and n_part
+          pimpl->unpack(pimpl->in_bfr_lft);
 
           // sanitize x==x1 that could happen due to errors in copying?
           thrust::transform_if(x.begin() + n_part_old, x.begin() + n_part, x.begin() + n_part_old, detail::nextafter_fctr<real_t>(0.), arg::_1 == particles[dev_id]->opts_init->x1);
-
-          // start async copy of n buffer to the right
-          gpuErrchk(cudaMemcpyPeerAsync(
-            particles[rgt_dev]->pimpl->in_n_bfr.data().get(), rgt_dev,  //dst
-            out_n_bfr.data().get(), dev_id,                             //src 
-            rgt_count * sizeof(n_t),                                    //no of bytes
-            streams[dev_id]                                             //best performance if stream belongs to src
-          ));
-          // record beginning of copying
-          gpuErrchk(cudaEventRecord(events[dev_id], streams[dev_id]));
-          // barrier to make sure that all devices started copying
-        }
-        barrier.wait();
-
-        // prepare the real_t buffer for copy to the right
-        if(bcond.second == detail::distmem_cuda)
-           particles[dev_id]->pimpl->pack_real_rgt();
-
-        if(bcond.first == detail::distmem_cuda)
-        {
-          // wait for the copy of n from left into current device to finish
-          gpuErrchk(cudaEventSynchronize(events[lft_dev]));
-          // unpack the n buffer sent to this device from left
-          particles[dev_id]->pimpl->unpack_n(particles[lft_dev]->pimpl->rgt_count); // also sets n_part etc..
         }
 
-        if(bcond.second == detail::distmem_cuda)
-        {
-          // start async copy of real buffer to the right
-          gpuErrchk(cudaMemcpyPeerAsync(
-            particles[rgt_dev]->pimpl->in_real_bfr.data().get(), rgt_dev,  //dst
-            out_real_bfr.data().get(), dev_id,                             //src 
-            distmem_real_vctrs_count * rgt_count * sizeof(real_t),                 //no of bytes
-            streams[dev_id]                                                //best performance if stream belongs to src
-          ));
-          // record beginning of copying
-          gpuErrchk(cudaEventRecord(events[dev_id], streams[dev_id]));
-        }
-
-        // barrier to make sure that all devices started copying
-        barrier.wait();
-        if(bcond.first == detail::distmem_cuda)
-          particles[dev_id]->pimpl->flag_lft(); 
-        if(bcond.second == detail::distmem_cuda)
-          particles[dev_id]->pimpl->flag_rgt(); 
-        
         if(bcond.first == detail::distmem_cuda)
         {
-          // wait for the copy of real from left into current device to finish
+          // wait for the copy from left into current device to finish
           gpuErrchk(cudaEventSynchronize(events[lft_dev]));
-
-          // unpack the real buffer sent to this device from left
-          particles[dev_id]->pimpl->unpack_real(particles[lft_dev]->pimpl->rgt_count);
+          // unpack the buffer sent to this device from left
+          pimpl->unpack(pimpl->in_bfr_rgt);
         }
 
         // resize all vectors of size n_part
-        particles[dev_id]->pimpl->hskpng_resize_npart();
+        pimpl->hskpng_resize_npart();
 
-        // particles are not sorted now
-        particles[dev_id]->pimpl->sorted = false;          
+        // particle layout changed, particles are not sorted now
+        ++pimpl->layout_epoch;          
 
         // clean streams and events
         barrier.wait();
@@ -202,7 +130,7 @@ namespace libcloudphxx
         gpuErrchk(cudaEventDestroy(events[dev_id]));
       }
       // finalize async
-      particles[dev_id]->pimpl->post_copy(opts);
+      particles[dev_id]->pimpl->post_copy(opts.rcyc);
     }
   };
 };
@@ -29,6 +29,10 @@
 #include "detail/functors_host.hpp"
 #include "detail/ran_with_mpi.hpp"
 #include "detail/tmp_vector_pool.hpp"
+#include "detail/distmem_bfr.hpp"
+#include "detail/rebalance.hpp"
+#include "detail/checkpoint.hpp"
+#include "detail/outbuf_queue.hpp"
 
 //kernel definitions
 #include "detail/kernel_definitions/hall_efficiencies.hpp"
@@ -64,6 +68,7 @@
 #include "impl/initialization/particles_impl_init_SD_with_distros_const_multi.ipp"
 #include "impl/initialization/particles_impl_init_SD_with_distros.ipp"
 #include "impl/initialization/particles_impl_init_SD_with_sizes.ipp"
+#include "impl/initialization/particles_impl_init_SD_with_attrs.ipp"
 #include "impl/initialization/particles_impl_init_dry_sd_conc.ipp"
 #include "impl/initialization/particles_impl_init_dry_const_multi.ipp"
 #include "impl/initialization/particles_impl_init_dry_dry_sizes.ipp"
@@ -81,6 +86,7 @@
 #include "impl/initialization/particles_impl_init_chem.ipp"
 #include "impl/initialization/particles_impl_init_kernel.ipp"
 #include "impl/initialization/particles_impl_init_vterm.ipp"
+#include "impl/initialization/particles_impl_init_rlx.ipp"
 #include "impl/initialization/particles_impl_init_sanity_check.ipp"
 #include "impl/initialization/particles_impl_init_insol_dry_sizes.ipp"
 #include "impl/initialization/particles_impl_init_T_freeze.ipp"
@@ -93,13 +99,15 @@
 #include "impl/distributed_memory/particles_impl_unpack.ipp"
 #include "impl/distributed_memory/particles_impl_mpi_exchange.ipp"
 #include "impl/distributed_memory/particles_impl_post_copy.ipp"
+#include "impl/distributed_memory/particles_impl_rebalance.ipp"
 
 #include "impl/housekeeping/particles_impl_hskpng_ijk.ipp"
 #include "impl/housekeeping/particles_impl_hskpng_Tpr.ipp"
 #include "impl/housekeeping/particles_impl_hskpng_mfp.ipp"
+#include "impl/housekeeping/particles_impl_hskpng_phase_presence.ipp"
 #include "impl/housekeeping/particles_impl_hskpng_vterm.ipp"
-#include "impl/housekeeping/particles_impl_hskpng_turb_vel.ipp"
 #include "impl/housekeeping/particles_impl_hskpng_turb_ss.ipp"
+#include "impl/housekeeping/particles_impl_hskpng_turb_vel.ipp"
 #include "impl/housekeeping/particles_impl_hskpng_tke.ipp"
 #include "impl/housekeeping/particles_impl_hskpng_sort.ipp"
 #include "impl/housekeeping/particles_impl_hskpng_count.ipp"
@@ -109,6 +117,8 @@
 #include "impl/housekeeping/particles_impl_rcyc.ipp"
 
 #include "impl/diagnose_SD_attributes/particles_impl_moms.ipp"
+#include "impl/diagnose_SD_attributes/particles_impl_moms_spectrum.ipp"
+#include "impl/diagnose_SD_attributes/particles_impl_moms_reduce.ipp"
 #include "impl/diagnose_SD_attributes/particles_impl_mass_dens.ipp"
 #include "impl/diagnose_SD_attributes/particles_impl_fill_outbuf.ipp"
 #include "impl/diagnose_SD_attributes/particles_impl_update_incloud_time.ipp"
@@ -147,6 +157,7 @@
 #include "impl/coalescence/particles_impl_coal.ipp"
 
 #include "impl/chemistry/particles_impl_chem_ante.ipp"
+#include "impl/chemistry/particles_impl_chem_compact.ipp"
 #include "impl/chemistry/particles_impl_chem_henry.ipp"
 #include "impl/chemistry/particles_impl_chem_dissoc.ipp"
 #include "impl/chemistry/particles_impl_chem_strength.ipp"
@@ -158,6 +169,7 @@
 #include "impl/sources_and_relaxation_of_SDs/particles_impl_src.ipp"
 #include "impl/sources_and_relaxation_of_SDs/particles_impl_src_dry_distros_simple.ipp"
 #include "impl/sources_and_relaxation_of_SDs/particles_impl_src_dry_distros_matching.ipp"
+#include "impl/sources_and_relaxation_of_SDs/particles_impl_src_dry_distros_matching_indexed.ipp"
 #include "impl/sources_and_relaxation_of_SDs/particles_impl_src_dry_distros.ipp"
 #include "impl/sources_and_relaxation_of_SDs/particles_impl_src_dry_sizes.ipp"
 #include "impl/sources_and_relaxation_of_SDs/particles_impl_rlx.ipp"
@@ -166,4 +178,6 @@
 #include "impl/ice/particles_impl_ice_dep.ipp"
 #include "impl/ice/particles_impl_ice_nucl_melt.ipp"
 
+#include "impl/checkpoint/particles_impl_checkpoint.ipp"
+
 
@@ -69,6 +69,15 @@ namespace libcloudphxx
       this->opts_init = &pimpl->opts_init;
       pimpl->sanity_checks();
 
+#if defined(USE_MPI)
+      // columns in processes to the left (not used with multi_CUDA)
+      if(size > 1 && opts_init.dev_count < 2)
+      {
+        MPI_CHECK(MPI_Exscan(&opts_init.nx, &pimpl->mpi_n_x_bfr, 1, MPI_INT, MPI_SUM, detail::MPI_COMM_LIBCLOUD));
+        if(rank == 0) pimpl->mpi_n_x_bfr = 0; // result of Exscan is undefined on the first process
+      }
+#endif
+
       // init output map to 0
       for(int i=0; i < common::output_names.size(); ++i)
         pimpl->output_puddle[static_cast<common::output_t>(i)] = 0.;
@@ -91,10 +100,84 @@ namespace libcloudphxx
       return &(*(outbuf.begin()));
     }
 
+    template <typename real_t, backend_t device>
+    unsigned long long particles_t<real_t, device>::outbuf_enqueue() 
+    {
+      const unsigned long long seq = pimpl->outbuf_enqueue();
+      // restore the count_num and count_ijk arrays
+      pimpl->hskpng_count();
+      return seq;
+    }
+
+    template <typename real_t, backend_t device>
+    const real_t *particles_t<real_t, device>::outbuf_front(unsigned long long &seq) 
+    {
+      if (!pimpl->outbuf_q) return NULL;
+      return pimpl->outbuf_q->front(seq);
+    }
+
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::outbuf_pop() 
+    {
+      if (!pimpl->outbuf_q)
+        throw std::runtime_error("libcloudph++: outbuf_pop() called with no queued output");
+      pimpl->outbuf_q->pop();
+    }
+
+    template <typename real_t, backend_t device>
+    std::vector<real_t> particles_t<real_t, device>::outbuf_profile() 
+    {
+      std::vector<real_t> out(pimpl->moms_profile());
+      pimpl->hskpng_count();
+      return out;
+    }
+
+    template <typename real_t, backend_t device>
+    std::vector<real_t> particles_t<real_t, device>::outbuf_column() 
+    {
+      std::vector<real_t> out(pimpl->moms_column());
+      pimpl->hskpng_count();
+      return out;
+    }
+
+    template <typename real_t, backend_t device>
+    real_t particles_t<real_t, device>::outbuf_domain() 
+    {
+      const real_t out = pimpl->moms_domain();
+      pimpl->hskpng_count();
+      return out;
+    }
+
     template <typename real_t, backend_t device>
     std::vector<real_t> particles_t<real_t, device>::get_attr(const std::string &attr_name) 
     {
-      return std::move(pimpl->fill_attr_outbuf(attr_name));
+      return pimpl->fill_attr_outbuf(std::vector<std::string>(1, attr_name));
+    }
+
+    template <typename real_t, backend_t device>
+    std::vector<real_t> particles_t<real_t, device>::get_attrs(const std::vector<std::string> &attr_names) 
+    {
+      return pimpl->fill_attr_outbuf(attr_names);
+    }
+
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::save_state(const std::string &path) 
+    {
+      if (!pimpl->init_called)
+        throw std::runtime_error("libcloudph++: please call init() before calling save_state()");
+      if (pimpl->should_now_run_async)
+        throw std::runtime_error("libcloudph++: save_state() cannot be called between step_cond() and step_async()");
+      pimpl->save_state(path);
+    }
+
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::load_state(const std::string &path) 
+    {
+      if (!pimpl->init_called)
+        throw std::runtime_error("libcloudph++: please call init() before calling load_state()");
+      if (pimpl->should_now_run_async)
+        throw std::runtime_error("libcloudph++: load_state() cannot be called between step_cond() and step_async()");
+      pimpl->load_state(path);
     }
   };
 };
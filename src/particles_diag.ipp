@@ -352,6 +352,8 @@ namespace libcloudphxx
     template <typename real_t, backend_t device>
     void particles_t<real_t, device>::diag_RH_ge_Sc()
     {
+      pimpl->mpi_exchange_finish();
+
       // intentionally using the same tmp vector as inside moms_cmp below
       // thrust_device::vector<real_t> &RH_minus_Sc(pimpl->tmp_device_real_part);
       auto RH_minus_Sc_g = pimpl->tmp_device_real_part.get_guard();
@@ -383,6 +385,8 @@ namespace libcloudphxx
     template <typename real_t, backend_t device>
     void particles_t<real_t, device>::diag_rw_ge_rc()
     {
+      pimpl->mpi_exchange_finish();
+
       // intentionally using the same tmp vector as inside moms_cmp below
       // thrust_device::vector<real_t> &rc2(pimpl->tmp_device_real_part);
       auto rc2_g = pimpl->tmp_device_real_part.get_guard();
@@ -420,6 +424,24 @@ namespace libcloudphxx
       pimpl->moms_calc(pimpl->rw2.begin(), n/2.);
     }
 
+    // computes n-th moments of the dry spectrum in bins with given dry radius edges (selection is ignored)
+    template <typename real_t, backend_t device>
+    std::vector<real_t> particles_t<real_t, device>::diag_dry_spectrum(const std::vector<real_t> &r_edges, const int &n)
+    {
+      std::vector<real_t> edges(r_edges.size());
+      std::transform(r_edges.begin(), r_edges.end(), edges.begin(), [](const real_t &r) { return r * r * r; });
+      return pimpl->moms_spectrum(edges, pimpl->rd3, n/3.);
+    }
+
+    // computes n-th moments of the wet spectrum in bins with given wet radius edges (selection is ignored)
+    template <typename real_t, backend_t device>
+    std::vector<real_t> particles_t<real_t, device>::diag_wet_spectrum(const std::vector<real_t> &r_edges, const int &n)
+    {
+      std::vector<real_t> edges(r_edges.size());
+      std::transform(r_edges.begin(), r_edges.end(), edges.begin(), [](const real_t &r) { return r * r; });
+      return pimpl->moms_spectrum(edges, pimpl->rw2, n/2.);
+    }
+
     // computes n-th moment of the ice equatorial radius spectrum for the selected particles
     template <typename real_t, backend_t device>
     void particles_t<real_t, device>::diag_ice_a_mom(const int &n)
@@ -592,6 +614,8 @@ namespace libcloudphxx
       if(pimpl->opts_init.ice_switch == false)
         throw std::runtime_error("libcloudph++: ice is switched off in opts_init, but diag_ice was called");
 
+      pimpl->mpi_exchange_finish();
+
       // updating terminal velocities
       pimpl->hskpng_vterm_all();
 
@@ -649,6 +673,51 @@ namespace libcloudphxx
       pimpl->moms_calc(pimpl->chem_bgn[c], 1.);
     }
 
+    // mean number of electroneutrality function evaluations per SD in chem_dissoc
+    // (of the last chemistry substep); zero in cells without SDs flagged for chemistry
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::diag_chem_dissoc_iter()
+    {
+      if(pimpl->opts_init.chem_switch == false)
+        throw std::runtime_error("libcloudph++: chemistry is switched off in opts_init, but diag_chem_dissoc_iter was called");
+
+      const thrust_device::vector<unsigned int> &iter(pimpl->chem_dissoc_iter);
+      const thrust_device::vector<thrust_size_t> &ijk(pimpl->chem_cmp_ijk); // grouped by cell in chem_gather
+
+      pimpl->count_n = 0;
+      if (iter.size() == 0) return;
+      assert(iter.size() == ijk.size());
+
+      // number of SDs in each cell
+      auto tmp_sd_g = pimpl->tmp_device_real_cell.get_guard();
+      thrust_device::vector<real_t> &n_sd = tmp_sd_g.get();
+
+      thrust::reduce_by_key(
+        ijk.begin(), ijk.end(),                 // input - keys
+        thrust::make_constant_iterator<real_t>(1), // input - values
+        pimpl->count_ijk.begin(),               // output - keys
+        n_sd.begin()                            // output - values
+      );
+
+      // total number of evaluations in each cell
+      pimpl->count_n = thrust::reduce_by_key(
+        ijk.begin(), ijk.end(),                 // input - keys
+        iter.begin(),                           // input - values
+        pimpl->count_ijk.begin(),               // output - keys
+        pimpl->count_mom.begin(),               // output - values
+        thrust::equal_to<thrust_size_t>(),      // key comparison
+        thrust::plus<real_t>()                  // reduction type
+      ).first - pimpl->count_ijk.begin();
+      assert(pimpl->count_n <= pimpl->n_cell);
+
+      thrust::transform(
+        pimpl->count_mom.begin(), pimpl->count_mom.begin() + pimpl->count_n, // input - 1st arg
+        n_sd.begin(),                                                          // input - 2nd arg
+        pimpl->count_mom.begin(),                                              // output
+        thrust::divides<real_t>()                                              // op
+      );
+    }
+
     template <typename real_t, backend_t device>
     std::map<common::output_t, real_t> particles_t<real_t, device>::diag_puddle()
     {
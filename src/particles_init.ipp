@@ -93,7 +93,15 @@ namespace libcloudphxx
       // reserve memory for data of the size of the max number of SDs
       pimpl->reserve_hskpng_npart(); 
 
-      if(!pimpl->opts_init.no_ccn_at_init)
+      if(pimpl->init_attrs != NULL)
+      {
+        // pre-generated SDs passed to init_from_attrs()
+        pimpl->init_SD_with_attrs(*pimpl->init_attrs);
+
+        if(pimpl->opts_init.diag_incloud_time)
+          pimpl->init_incloud_time();
+      }
+      else if(!pimpl->opts_init.no_ccn_at_init)
       {
         // initial parameters (from dry distribution or dry radius-concentration pairs)
         if(pimpl->opts_init.dry_distros.size() > 0)
@@ -113,6 +121,9 @@ namespace libcloudphxx
       pimpl->init_vterm(); // init cached vt0 for the Beard fast vt formula
       pimpl->hskpng_vterm_invalid(); // init vt of SD
 
+      // analysis of relaxation distributions and relaxation buffers
+      pimpl->init_rlx();
+
       // initialising rc2, needed for cond with sstp_cond_act > 1
       pimpl->hskpng_approximate_rc2_invalid();
 
@@ -129,5 +140,33 @@ namespace libcloudphxx
       // set rng seed to be used after init
       pimpl->rng.reseed(pimpl->opts_init.rng_seed);
     }
+
+    // init with pre-generated SDs
+    template <typename real_t, backend_t device>
+    void particles_t<real_t, device>::init_from_attrs(
+      const sd_attrs_t<real_t> &attrs,
+      const arrinfo_t<real_t> th,
+      const arrinfo_t<real_t> rv,
+      const arrinfo_t<real_t> rhod,
+      const arrinfo_t<real_t> p,
+      const arrinfo_t<real_t> courant_x,
+      const arrinfo_t<real_t> courant_y,
+      const arrinfo_t<real_t> courant_z,
+      const std::map<enum chem_species_t, const arrinfo_t<real_t> > ambient_chem
+    )
+    {
+      // attrs are used (not stored) inside init()
+      pimpl->init_attrs = &attrs;
+      try
+      {
+        init(th, rv, rhod, p, courant_x, courant_y, courant_z, ambient_chem);
+      }
+      catch(...)
+      {
+        pimpl->init_attrs = NULL;
+        throw;
+      }
+      pimpl->init_attrs = NULL;
+    }
   };
 };
@@ -13,6 +13,9 @@ namespace libcloudphxx
     template <typename real_t>
     particles_t<real_t, multi_CUDA>::particles_t(opts_init_t<real_t> _opts_init) 
     {
+      if(_opts_init.n_ens > 1)
+        throw std::runtime_error("ensemble of parcels (opts_init.n_ens > 1) doesnt work in multi_CUDA backend.");
+
       pimpl.reset(new impl(_opts_init));
   
       // make opts_init point to global opts init
@@ -46,10 +49,60 @@ namespace libcloudphxx
       );
     }
 
+    template <typename real_t>
+    void particles_t<real_t, multi_CUDA>::init_from_attrs(
+      const sd_attrs_t<real_t> &attrs,
+      const arrinfo_t<real_t> th,
+      const arrinfo_t<real_t> rv,
+      const arrinfo_t<real_t> rhod,
+      const arrinfo_t<real_t> p,
+      const arrinfo_t<real_t> courant_1,
+      const arrinfo_t<real_t> courant_2,
+      const arrinfo_t<real_t> courant_3,
+      const std::map<enum chem_species_t, const arrinfo_t<real_t> > ambient_chem
+    )
+    {
+      if(pimpl->particles[0]->pimpl->mpi_size > 1)
+        throw std::runtime_error("init_from_attrs doesnt work in multi_CUDA backend with MPI.");
+
+      if(pimpl->glob_opts_init.rlx_switch)
+        std::cerr << "libcloudph++ WARNING: relaxation is not fully supported in the multi_CUDA backend. Mean calculation and addition of SD will be done locally on each GPU." << std::endl;
+
+      // each GPU takes the SDs from its part of the domain
+      pimpl->mcuda_run(
+        &particles_t<real_t, CUDA>::init_from_attrs,
+        attrs, th, rv, rhod, p, courant_1, courant_2, courant_3, ambient_chem
+      );
+
+      unsigned long long n_taken = 0;
+      for(auto &prtcls : pimpl->particles)
+        n_taken += prtcls->pimpl->init_attrs_n_taken;
+      if(n_taken != attrs.n_sd)
+        throw std::runtime_error(detail::formatter() << "libcloudph++: " << attrs.n_sd - n_taken << " of the imported SDs have x outside of the domain");
+    }
+
     template <typename real_t>
     std::vector<real_t> particles_t<real_t, multi_CUDA>::get_attr(const std::string &attr_name) 
     {
       throw std::runtime_error("get_attr doesnt work in multi_CUDA backend.");
     }
+
+    template <typename real_t>
+    std::vector<real_t> particles_t<real_t, multi_CUDA>::get_attrs(const std::vector<std::string> &) 
+    {
+      throw std::runtime_error("get_attrs doesnt work in multi_CUDA backend.");
+    }
+
+    template <typename real_t>
+    void particles_t<real_t, multi_CUDA>::save_state(const std::string &) 
+    {
+      throw std::runtime_error("save_state doesnt work in multi_CUDA backend.");
+    }
+
+    template <typename real_t>
+    void particles_t<real_t, multi_CUDA>::load_state(const std::string &) 
+    {
+      throw std::runtime_error("load_state doesnt work in multi_CUDA backend.");
+    }
   };
 };
@@ -171,6 +171,54 @@ namespace libcloudphxx
       pimpl->mcuda_run(&particles_t<real_t, CUDA>::diag_wet_mom, k);
     }
 
+    template <typename real_t>
+    unsigned long long particles_t<real_t, multi_CUDA>::outbuf_enqueue()
+    {
+      throw std::runtime_error("outbuf_enqueue doesnt work in multi_CUDA backend.");
+    }
+
+    template <typename real_t>
+    const real_t *particles_t<real_t, multi_CUDA>::outbuf_front(unsigned long long &)
+    {
+      throw std::runtime_error("outbuf_front doesnt work in multi_CUDA backend.");
+    }
+
+    template <typename real_t>
+    void particles_t<real_t, multi_CUDA>::outbuf_pop()
+    {
+      throw std::runtime_error("outbuf_pop doesnt work in multi_CUDA backend.");
+    }
+
+    template <typename real_t>
+    std::vector<real_t> particles_t<real_t, multi_CUDA>::outbuf_profile()
+    {
+      throw std::runtime_error("outbuf_profile doesnt work in multi_CUDA backend.");
+    }
+
+    template <typename real_t>
+    std::vector<real_t> particles_t<real_t, multi_CUDA>::outbuf_column()
+    {
+      throw std::runtime_error("outbuf_column doesnt work in multi_CUDA backend.");
+    }
+
+    template <typename real_t>
+    real_t particles_t<real_t, multi_CUDA>::outbuf_domain()
+    {
+      throw std::runtime_error("outbuf_domain doesnt work in multi_CUDA backend.");
+    }
+
+    template <typename real_t>
+    std::vector<real_t> particles_t<real_t, multi_CUDA>::diag_dry_spectrum(const std::vector<real_t> &, const int &)
+    {
+      throw std::runtime_error("diag_dry_spectrum doesnt work in multi_CUDA backend.");
+    }
+
+    template <typename real_t>
+    std::vector<real_t> particles_t<real_t, multi_CUDA>::diag_wet_spectrum(const std::vector<real_t> &, const int &)
+    {
+      throw std::runtime_error("diag_wet_spectrum doesnt work in multi_CUDA backend.");
+    }
+
     template <typename real_t>
     void particles_t<real_t, multi_CUDA>::diag_ice_c_mom(const int &k)
     {
@@ -234,6 +282,12 @@ namespace libcloudphxx
       pimpl->mcuda_run(&particles_t<real_t, CUDA>::diag_chem, spec);
     }
 
+    template <typename real_t>
+    void particles_t<real_t, multi_CUDA>::diag_chem_dissoc_iter()
+    {
+      pimpl->mcuda_run(&particles_t<real_t, CUDA>::diag_chem_dissoc_iter);
+    }
+
     template <typename real_t>
     void particles_t<real_t, multi_CUDA>::diag_rw_ge_rc()
     {
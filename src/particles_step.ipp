@@ -78,6 +78,15 @@ namespace libcloudphxx
         throw std::runtime_error("libcloudph++: turbulent advection, coalescence and condesation are switched off and diss_rate is not empty");
 // </TODO>
 
+      // e2l maps are empty after rebalancing of the MPI decomposition
+      if (pimpl->l2e[&pimpl->th].size() == 0)
+      {
+        pimpl->init_e2l(th, &pimpl->th);
+        pimpl->init_e2l(rv, &pimpl->rv);
+      }
+      if (pimpl->l2e[&pimpl->rhod].size() == 0)
+        if (!rhod.is_null()) pimpl->init_e2l(rhod, &pimpl->rhod);
+
       if (pimpl->l2e[&pimpl->courant_x].size() == 0) // TODO: y, z,...
       {
         // TODO: copy-pasted from init
@@ -111,6 +120,9 @@ namespace libcloudphxx
       // fill in mpi courant halos
       pimpl->xchng_courants();
 
+      // complete the copy of SDs started in the previous step_async
+      pimpl->mpi_exchange_finish();
+
       nancheck(pimpl->th, " th after sync-in");
       nancheck(pimpl->rv, " rv after sync-in");
       nancheck(pimpl->courant_x, " courant_x after sync-in");
@@ -270,13 +282,17 @@ namespace libcloudphxx
       // TODO2: shouldn't we run hskpng_Tpr before chemistry?
       if (opts.chem_dsl or opts.chem_dsc or opts.chem_rct) 
       {
+        // volumes, flags and the compacted arrays do not change during the chemistry substeps
+        // (chemistry alters neither rw2 nor the cell-sorted SD order), so they are prepared once
+        // calculate new volume of droplets (needed for chemistry)
+        pimpl->chem_vol_ante();
+        // set flag for those SD that are big enough to have chemical reactions
+        pimpl->chem_flag_ante();
+        // gather the flagged SDs into dense arrays used in all the stages below (scattered back in chem_post_step)
+        pimpl->chem_gather();
+
         for (int step = 0; step < pimpl->sstp_chem; ++step) 
         {   
-          // calculate new volume of droplets (needed for chemistry)
-          pimpl->chem_vol_ante();
-          // set flag for those SD that are big enough to have chemical reactions
-          pimpl->chem_flag_ante();
-
           if (opts.chem_dsl)
           {
             //adjust trace gases to substepping
@@ -304,8 +320,9 @@ namespace libcloudphxx
             //cleanup - TODO think of something better
             pimpl->chem_cleanup();
           }
-          pimpl->chem_post_step();
         }
+        // write the flagged SDs back and release the temporary arrays
+        pimpl->chem_post_step();
       }
 
       if(opts.cond) // || (opts.src && pimpl->src_stp_ctr % pimpl->opts_init.supstp_src == 0) || (opts.rlx && pimpl->rlx_stp_ctr % pimpl->opts_init.supstp_rlx == 0))
@@ -407,21 +424,12 @@ namespace libcloudphxx
         // calc tke (diss_rate now holds TKE, not dissipation rate! Hence this must be done after coal, which requires diss rate)
         pimpl->hskpng_tke();
       }
-      if (opts.turb_adve)
-      {
-        // calc turbulent perturbation of velocity
-        pimpl->hskpng_turb_vel(pimpl->dt);
-      }
-      else if (opts.turb_cond)
-      {
-        // calc turbulent perturbation only of vertical velocity
-        pimpl->hskpng_turb_vel(pimpl->dt, true);
-      }
-
-      if(opts.turb_cond)
+      if (opts.turb_adve || opts.turb_cond)
       {
-        // calculate the time derivatie of the turbulent supersaturation perturbation; applied in the next step during condensation substepping - is the delay a problem?
-        pimpl->hskpng_turb_dot_ss(); 
+        // calc turbulent perturbation of velocity (only of the vertical one without turb_adve)
+        // and, with turb_cond, the time derivatie of the turbulent supersaturation perturbation;
+        // the latter is applied in the next step during condensation substepping - is the delay a problem?
+        pimpl->hskpng_turb_vel(pimpl->dt, !opts.turb_adve, opts.turb_cond);
       }
 
       // advection, it invalidates i,j,k and ijk!
@@ -480,14 +488,23 @@ namespace libcloudphxx
       // boundary condition + accumulated rainfall to be returned
       pimpl->bcnd();
       
-      // copy advected SDs using asynchronous MPI;
+      // start copying advected SDs using asynchronous MPI;
+      // it is completed (together with post_copy) lazily, i.e. in the next sync_in()
+      // or before the first diagnostic/attribute access that needs SD data
       if (opts.adve || opts.turb_adve)
-        pimpl->mpi_exchange();
+        pimpl->mpi_exchange_start(opts.rcyc);
 
+      // multi_CUDA copies between GPUs right after step_async, so the MPI copy has to be completed now
+      if(pimpl->opts_init.dev_count)
+        pimpl->mpi_exchange_finish();
       // stuff has to be done after distmem copy 
       // if it is a spawn of multi_CUDA, multi_CUDA will handle finalize
-      if(!pimpl->opts_init.dev_count)
-        pimpl->post_copy(opts);
+      else if(!pimpl->mpi_exchange_pending)
+        pimpl->post_copy(opts.rcyc);
+
+      // shift x-slab boundaries between MPI processes if SDs are unevenly distributed
+      if(pimpl->opts_init.rebalance_freq > 0 && ++pimpl->rebalance_stp_ctr % pimpl->opts_init.rebalance_freq == 0)
+        pimpl->rebalance();
 
       pimpl->selected_before_counting = false;
     }
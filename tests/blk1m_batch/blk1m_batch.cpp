@@ -0,0 +1,162 @@
+// batched raw-array blk_1m cellwise routines (called through the container adaptors) compared with the zip-based
+// implementation they replaced; for std::vector, for contiguous Blitz++ arrays (passed without a copy)
+// and for non-contiguous Blitz++ slices (copied to temporary arrays)
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+#include <blitz/tv2fastiter.h> // otherwise Clang fails in debug mode
+#include <blitz/array.h>
+
+#include <libcloudph++/blk_1m/options.hpp>
+#include <libcloudph++/blk_1m/adj_cellwise.hpp>
+#include <libcloudph++/blk_1m/rhs_cellwise.hpp>
+
+#include "adj_cellwise_zip.hpp"
+#include "rhs_cellwise_zip.hpp"
+
+namespace b1m = libcloudphxx::blk_1m;
+namespace b1m_zip = libcloudphxx::blk_1m_zip;
+using real_t = double;
+using vec_t = std::vector<real_t>;
+
+const int nx = 37, nz = 29, n = nx * nz; // more cells than in one lock-step block / OpenMP chunk
+const real_t dt = 1;
+
+// fields: rhod, p, th, rv, rc, rr, ria, rib and the tendencies
+enum { rhod, p, th, rv, rc, rr, ria, rib, dot_th, dot_rv, dot_rc, dot_rr, dot_ria, dot_rib, n_fld };
+
+std::vector<vec_t> init_state()
+{
+  std::vector<vec_t> s(n_fld, vec_t(n));
+  for (int i = 0; i < n; ++i)
+  {
+    const real_t a = real_t(i) / n, b = real_t((7 * i) % n) / n, c = real_t((13 * i) % n) / n;
+    s[rhod][i] = 1.1 - .2 * a;
+    s[p][i]    = 1e5 - 2e4 * a;
+    s[th][i]   = 265 + 30 * b;
+    s[rv][i]   = 2e-3 + 1.2e-2 * c;      // sub- and supersaturated cells
+    s[rc][i]   = (i % 3) * 1e-3 * a;
+    s[rr][i]   = (i % 4) * 5e-4 * b;
+    s[ria][i]  = (i % 5) * 1e-4 * c;
+    s[rib][i]  = (i % 2) * 2e-4 * a;
+    for (int f = dot_th; f < n_fld; ++f)
+      s[f][i] = 1e-6 * (f - dot_th + 1) * (a - .5); // non-zero, the routines add to the tendencies
+  }
+  return s;
+}
+
+void compare(const std::vector<vec_t> &ref, const std::vector<vec_t> &res, const std::string &what)
+{
+  for (int f = 0; f < n_fld; ++f)
+    for (int i = 0; i < n; ++i)
+      if (std::abs(res[f][i] - ref[f][i]) > 1e-12 * std::abs(ref[f][i]) + 1e-300)
+        throw std::runtime_error(what + ": results differ from the zip-based implementation");
+}
+
+// Blitz++ arrays with a halo in x and z, holding a copy of the state in the interior
+struct bz_state_t
+{
+  std::vector<blitz::Array<real_t, 2>> arr;
+
+  bz_state_t(const std::vector<vec_t> &s)
+  {
+    for (int f = 0; f < n_fld; ++f)
+    {
+      arr.emplace_back(blitz::Range(-1, nx), blitz::Range(-1, nz));
+      arr[f] = -44;
+      for (int i = 0; i < nx; ++i)
+        for (int k = 0; k < nz; ++k)
+          arr[f](i, k) = s[f][i * nz + k];
+    }
+  }
+
+  std::vector<vec_t> get() const
+  {
+    std::vector<vec_t> s(n_fld, vec_t(n));
+    for (int f = 0; f < n_fld; ++f)
+    {
+      for (int i = 0; i < nx; ++i)
+        for (int k = 0; k < nz; ++k)
+          s[f][i * nz + k] = arr[f](i, k);
+      // halo untouched
+      if (arr[f](-1, -1) != -44 || arr[f](nx, nz) != -44)
+        throw std::runtime_error("halo overwritten");
+    }
+    return s;
+  }
+};
+
+// runs fn on the state kept in std::vectors, in contiguous Blitz++ arrays and in non-contiguous Blitz++ slices
+void test(
+  const std::string &what,
+  const std::function<void(std::vector<vec_t>&)> &ref_fn,
+  const std::function<void(std::vector<vec_t>&)> &vec_fn,
+  const std::function<void(std::vector<blitz::Array<real_t, 1>>&)> &bz1_fn,
+  const std::function<void(std::vector<blitz::Array<real_t, 2>>&)> &bz2_fn
+)
+{
+  std::vector<vec_t> ref = init_state(), res = init_state();
+  ref_fn(ref);
+  vec_fn(res);
+  compare(ref, res, what + " (std::vector)");
+
+  // contiguous 1D arrays, used without a copy
+  {
+    std::vector<vec_t> s = init_state();
+    std::vector<blitz::Array<real_t, 1>> arr;
+    for (auto &v : s) arr.emplace_back(v.data(), blitz::shape(n), blitz::neverDeleteData);
+    if (libcloudphxx::common::detail::contiguous_data(arr[th], 0) != s[th].data())
+      throw std::runtime_error("contiguous Blitz++ array not passed directly");
+    bz1_fn(arr);
+    compare(ref, s, what + " (contiguous Blitz++ arrays)");
+  }
+
+  // interior slices of arrays with a halo, copied
+  {
+    bz_state_t bz(init_state());
+    std::vector<blitz::Array<real_t, 2>> arr;
+    for (auto &a : bz.arr) arr.push_back(a(blitz::Range(0, nx-1), blitz::Range(0, nz-1)));
+    if (libcloudphxx::common::detail::contiguous_data(arr[th], 0) != nullptr)
+      throw std::runtime_error("non-contiguous Blitz++ slice treated as contiguous");
+    bz2_fn(arr);
+    compare(ref, bz.get(), what + " (Blitz++ slices)");
+  }
+}
+
+// the same call for the reference, std::vector and Blitz++ containers
+#define TEST(what, ns_call) test(what, \
+  [&](std::vector<vec_t> &s) { b1m_zip::ns_call; }, \
+  [&](std::vector<vec_t> &s) { b1m::ns_call; }, \
+  [&](std::vector<blitz::Array<real_t, 1>> &s) { b1m::ns_call; }, \
+  [&](std::vector<blitz::Array<real_t, 2>> &s) { b1m::ns_call; } \
+)
+
+int main()
+{
+  for (bool th_dry : {true, false})
+  {
+    b1m::opts_t<real_t> opts;
+    opts.th_dry = th_dry;
+    opts.const_p = !th_dry;
+    const std::string var = th_dry ? ", th_dry" : ", const_p";
+
+    opts.adj_nwtrph = true;
+    TEST("adj_cellwise_nwtrph" + var,
+      adj_cellwise(opts, s[rhod], s[p], s[th], s[rv], s[rc], s[rr], dt));
+
+    TEST("rhs_cellwise_revap" + var,
+      rhs_cellwise_revap(opts, s[dot_th], s[dot_rv], s[dot_rc], s[dot_rr], s[rhod], s[p], s[th], s[rv], s[rc], s[rr], dt));
+
+    TEST("rhs_cellwise_ice" + var,
+      rhs_cellwise_ice(opts, s[dot_th], s[dot_rv], s[dot_rc], s[dot_rr], s[dot_ria], s[dot_rib], s[rhod], s[p], s[th], s[rv], s[rc], s[rr], s[ria], s[rib], dt));
+
+    opts.adj_nwtrph = false;
+    TEST("rhs_cellwise" + var,
+      rhs_cellwise(opts, s[dot_rc], s[dot_rr], s[rc], s[rr]));
+  }
+  std::cerr << "OK" << std::endl;
+}
@@ -0,0 +1,134 @@
+#include <libcloudph++/lgrngn/factory.hpp>
+#include <libcloudph++/common/lognormal.hpp>
+#include <libcloudph++/common/unary_function.hpp>
+#include <iostream>
+#include <algorithm>
+#include "mpi.h"
+
+// the copy of SDs between MPI processes is started in step_async and completed in the next
+// step_sync/sync_in; a run in which it is completed right after step_async (by get_attr)
+// has to give the same SDs in each process
+
+using namespace libcloudphxx::lgrngn;
+namespace lognormal = libcloudphxx::common::lognormal;
+
+const quantity<si::length, double> mean_rd = double(40e-9) * si::metres;
+const quantity<si::dimensionless, double> sdev_rd = double(1.4);
+const quantity<power_typeof_helper<si::length, static_rational<-3>>::type, double> n_stp = double(60e6) / si::cubic_metres;
+
+template <typename T>
+struct log_dry_radii : public libcloudphxx::common::unary_function<T>
+{
+  T funval(const T lnrd) const
+  {
+    return T(lognormal::n_e(mean_rd, sdev_rd, n_stp, quantity<si::dimensionless, double>(lnrd)) * si::cubic_metres);
+  }
+};
+
+const int nx_min = 2, nz = 3;
+
+// positions of the SDs of this process, in a fixed order
+std::vector<std::pair<double, double>> positions(particles_proto_t<double> *prtcls)
+{
+  const std::vector<double> x = prtcls->get_attr("x"), z = prtcls->get_attr("z");
+  std::vector<std::pair<double, double>> xz(x.size());
+  for(std::size_t i = 0; i < x.size(); ++i) xz[i] = {x[i], z[i]};
+  std::sort(xz.begin(), xz.end());
+  return xz;
+}
+
+// positions of SDs after advection across the process boundaries, with the copy of SDs completed
+// either right after step_async or in the next step_sync/sync_in
+std::vector<std::pair<double, double>> run(backend_t backend, const double courant, const bool deferred)
+{
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  opts_init_t<double> opts_init;
+  opts_init.dt = 1.;
+  opts_init.nx = nx_min + rank; // uneven decomposition
+  opts_init.nz = nz;
+  opts_init.dx = 1;
+  opts_init.dz = 1;
+  opts_init.x1 = opts_init.nx * opts_init.dx;
+  opts_init.z1 = opts_init.nz * opts_init.dz;
+  opts_init.sd_conc = 32;
+  opts_init.n_sd_max = 100 * opts_init.sd_conc * opts_init.nz;
+  opts_init.rng_seed = 4444 + rank; // the same initial SDs in both runs
+  opts_init.coal_switch = false;
+  opts_init.sedi_switch = false;
+  opts_init.dry_distros.emplace(
+    kappa_rd_insol_t<double>{double(0.61), double(0.)},
+    std::make_shared<log_dry_radii<double>>()
+  );
+
+  std::unique_ptr<particles_proto_t<double>> prtcls(factory<double>(backend, opts_init));
+
+  const int n_cell = opts_init.nx * opts_init.nz;
+  std::vector<double> vth(n_cell, 300.), vrhod(n_cell, 1.), vrv(n_cell, 0.01),
+                      vCx((opts_init.nx + 1) * opts_init.nz, courant),
+                      vCz(opts_init.nx * (opts_init.nz + 1), 0);
+  long int strides[] = {0, 1, 1};
+
+  arrinfo_t<double> th(vth.data(), strides), rhod(vrhod.data(), strides), rv(vrv.data(), strides),
+                    Cx(vCx.data(), strides), Cz(vCz.data(), strides);
+
+  prtcls->init(th, rv, rhod, arrinfo_t<double>(), Cx, arrinfo_t<double>(), Cz);
+
+  opts_t<double> opts;
+  opts.adve = true;
+  opts.sedi = opts.cond = opts.coal = false;
+
+  for(int it = 0; it < 20; ++it)
+  {
+    if(deferred && it % 2 == 1)
+    {
+      prtcls->sync_in(th, rv, rhod, Cx, arrinfo_t<double>(), Cz);
+      prtcls->step_cond(opts, th, rv);
+    }
+    else
+      prtcls->step_sync(opts, th, rv, rhod, Cx, arrinfo_t<double>(), Cz);
+    prtcls->step_async(opts);
+
+    if(!deferred)
+      prtcls->get_attr("x"); // completes the copy now
+  }
+
+  // the last copy of the deferred run is completed here
+  if(deferred)
+    prtcls->sync_in(th, rv, rhod, Cx, arrinfo_t<double>(), Cz);
+
+  return positions(prtcls.get());
+}
+
+void test(backend_t backend, const double courant)
+{
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  const std::vector<std::pair<double, double>> xz_eager = run(backend, courant, false);
+  MPI_Barrier(MPI_COMM_WORLD);
+  const std::vector<std::pair<double, double>> xz_deferred = run(backend, courant, true);
+
+  if(rank == 0)
+    std::cerr << "courant: " << courant << " SDs in process 0: " << xz_eager.size() << " (immediate) " << xz_deferred.size() << " (deferred)" << std::endl;
+  if(xz_eager.size() != xz_deferred.size())
+    throw std::runtime_error("number of SDs differs between deferred and immediate completion of the MPI exchange");
+  if(xz_eager != xz_deferred)
+    throw std::runtime_error("SD positions differ between deferred and immediate completion of the MPI exchange");
+}
+
+int main(int argc, char *argv[])
+{
+  int provided_thread_lvl;
+  MPI_Init_thread(nullptr, nullptr, MPI_THREAD_MULTIPLE, &provided_thread_lvl);
+
+  for(auto backend : {backend_t(serial), backend_t(OpenMP)})
+    for(double courant : {.3, -.7})
+    {
+      MPI_Barrier(MPI_COMM_WORLD);
+      test(backend, courant);
+    }
+
+  MPI_Finalize();
+}
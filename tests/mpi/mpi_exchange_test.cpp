@@ -0,0 +1,125 @@
+#include <libcloudph++/lgrngn/factory.hpp>
+#include <libcloudph++/common/lognormal.hpp>
+#include <libcloudph++/common/unary_function.hpp>
+#include <iostream>
+#include <cmath>
+#include "mpi.h"
+
+// SDs advected across MPI process boundaries (processes with different nx, SDs sent
+// in one byte buffer per neighbour and received only when their data is needed):
+// the total number of SDs and the total multiplicity have to be conserved
+
+using namespace libcloudphxx::lgrngn;
+namespace lognormal = libcloudphxx::common::lognormal;
+
+const quantity<si::length, double> mean_rd = double(40e-9) * si::metres;
+const quantity<si::dimensionless, double> sdev_rd = double(1.4);
+const quantity<power_typeof_helper<si::length, static_rational<-3>>::type, double> n_stp = double(60e6) / si::cubic_metres;
+
+template <typename T>
+struct log_dry_radii : public libcloudphxx::common::unary_function<T>
+{
+  T funval(const T lnrd) const
+  {
+    return T(lognormal::n_e(mean_rd, sdev_rd, n_stp, quantity<si::dimensionless, double>(lnrd)) * si::cubic_metres);
+  }
+};
+
+const int nx_min = 2, nz = 3;
+
+// global number of SDs and global multiplicity (rhod = 1 and dv = 1, hence mom0 = n per cell)
+std::pair<double, double> totals(particles_proto_t<double> *prtcls, const int &n_cell)
+{
+  double lcl[2] = {0, 0}, glb[2];
+
+  prtcls->diag_all();
+  prtcls->diag_sd_conc();
+  double *out = prtcls->outbuf();
+  for(int i = 0; i < n_cell; ++i) lcl[0] += out[i];
+
+  prtcls->diag_all();
+  prtcls->diag_wet_mom(0);
+  out = prtcls->outbuf();
+  for(int i = 0; i < n_cell; ++i) lcl[1] += out[i];
+
+  MPI_Allreduce(lcl, glb, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  return {glb[0], glb[1]};
+}
+
+void test(backend_t backend, const double courant)
+{
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  opts_init_t<double> opts_init;
+  opts_init.dt = 1.;
+  opts_init.nx = nx_min + rank; // uneven decomposition
+  opts_init.nz = nz;
+  opts_init.dx = 1;
+  opts_init.dz = 1;
+  opts_init.x1 = opts_init.nx * opts_init.dx;
+  opts_init.z1 = opts_init.nz * opts_init.dz;
+  opts_init.sd_conc = 32;
+  opts_init.n_sd_max = 100 * opts_init.sd_conc * opts_init.nz;
+  opts_init.rng_seed = 4444 + rank;
+  opts_init.coal_switch = false;
+  opts_init.sedi_switch = false;
+  opts_init.diag_incloud_time = true; // one more attribute in the buffers
+  opts_init.dry_distros.emplace(
+    kappa_rd_insol_t<double>{double(0.61), double(0.)},
+    std::make_shared<log_dry_radii<double>>()
+  );
+
+  std::unique_ptr<particles_proto_t<double>> prtcls(factory<double>(backend, opts_init));
+
+  const int n_cell = opts_init.nx * opts_init.nz;
+  std::vector<double> vth(n_cell, 300.), vrhod(n_cell, 1.), vrv(n_cell, 0.01),
+                      vCx((opts_init.nx + 1) * opts_init.nz, courant),
+                      vCz(opts_init.nx * (opts_init.nz + 1), 0);
+  long int strides[] = {0, 1, 1};
+
+  arrinfo_t<double> th(vth.data(), strides), rhod(vrhod.data(), strides), rv(vrv.data(), strides),
+                    Cx(vCx.data(), strides), Cz(vCz.data(), strides);
+
+  prtcls->init(th, rv, rhod, arrinfo_t<double>(), Cx, arrinfo_t<double>(), Cz);
+
+  const std::pair<double, double> init = totals(prtcls.get(), n_cell);
+
+  opts_t<double> opts;
+  opts.adve = true;
+  opts.sedi = opts.cond = opts.coal = false;
+
+  for(int it = 0; it < 40; ++it)
+  {
+    prtcls->step_sync(opts, th, rv, rhod, Cx, arrinfo_t<double>(), Cz);
+    prtcls->step_async(opts);
+
+    // diagnostics only every few steps, so that some copies complete only in the next step_sync
+    if(it % 7 != 6) continue;
+
+    const std::pair<double, double> now = totals(prtcls.get(), n_cell);
+    if(rank == 0)
+      std::cerr << "courant: " << courant << " step: " << it << " SDs: " << now.first << " (" << init.first << ")"
+                << " multiplicity: " << now.second << " (" << init.second << ")" << std::endl;
+    if(now.first != init.first)
+      throw std::runtime_error("number of SDs not conserved in the MPI exchange");
+    if(std::abs(now.second - init.second) > 1e-10 * init.second)
+      throw std::runtime_error("multiplicity not conserved in the MPI exchange");
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int provided_thread_lvl;
+  MPI_Init_thread(nullptr, nullptr, MPI_THREAD_MULTIPLE, &provided_thread_lvl);
+
+  for(auto backend : {backend_t(serial), backend_t(OpenMP)})
+    for(double courant : {.3, -.7})
+    {
+      MPI_Barrier(MPI_COMM_WORLD);
+      test(backend, courant);
+    }
+
+  MPI_Finalize();
+}
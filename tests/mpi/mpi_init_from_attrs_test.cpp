@@ -0,0 +1,148 @@
+#include <libcloudph++/lgrngn/factory.hpp>
+#include <iostream>
+#include <algorithm>
+#include <tuple>
+#include <cmath>
+#include <memory>
+#include "mpi.h"
+
+// SDs passed to init_from_attrs on process 0 (the other processes pass none) have to end up
+// in the processes that own their x positions, with unchanged attributes; an SD outside of
+// the domain has to give an error in all processes
+
+using namespace libcloudphxx::lgrngn;
+
+const int nx_min = 2, nz = 3, n_sd = 240;
+
+// SD attributes in the coordinates of the whole domain
+struct glob_attrs_t
+{
+  std::vector<unsigned long long> n;
+  std::vector<double> rd3, kappa, x, z;
+
+  glob_attrs_t(const double x1, const double z1)
+  {
+    for(int i = 0; i < n_sd; ++i)
+    {
+      n.push_back(1000 + i);
+      rd3.push_back(std::pow((50 + i) * 1e-9, 3));
+      kappa.push_back(.61);
+      x.push_back(x1 * (i + .5) / n_sd);
+      z.push_back(z1 * ((7 * i) % n_sd + .5) / n_sd);
+    }
+  }
+};
+
+void test(backend_t backend)
+{
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  opts_init_t<double> opts_init;
+  opts_init.dt = 1.;
+  opts_init.nx = nx_min + rank; // uneven decomposition
+  opts_init.nz = nz;
+  opts_init.dx = 1;
+  opts_init.dz = 1;
+  opts_init.x1 = opts_init.nx * opts_init.dx;
+  opts_init.z1 = opts_init.nz * opts_init.dz;
+  opts_init.n_sd_max = n_sd;
+  opts_init.coal_switch = false;
+  opts_init.sedi_switch = false;
+
+  int nx_bfr = 0, nx_tot;
+  MPI_Exscan(&opts_init.nx, &nx_bfr, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  if(rank == 0) nx_bfr = 0;
+  MPI_Allreduce(&opts_init.nx, &nx_tot, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+  const glob_attrs_t glob(nx_tot * opts_init.dx, opts_init.z1);
+
+  sd_attrs_t<double> attrs;
+  if(rank == 0)
+  {
+    attrs.n_sd = n_sd;
+    attrs.n = glob.n.data();
+    attrs.rd3 = glob.rd3.data();
+    attrs.kappa = glob.kappa.data();
+    attrs.x = glob.x.data();
+    attrs.z = glob.z.data();
+  }
+
+  const int n_cell = opts_init.nx * opts_init.nz;
+  std::vector<double> vth(n_cell, 300.), vrhod(n_cell, 1.), vrv(n_cell, 0.01);
+  long int strides[] = {0, 1, 1};
+  arrinfo_t<double> th(vth.data(), strides), rhod(vrhod.data(), strides), rv(vrv.data(), strides);
+
+  {
+    std::unique_ptr<particles_proto_t<double>> prtcls(factory<double>(backend, opts_init));
+    prtcls->init_from_attrs(attrs, th, rv, rhod);
+
+    // SDs of this process, (global x, z, n, rd3) sorted
+    typedef std::tuple<double, double, unsigned long long, double> sd_t;
+    std::vector<sd_t> got, expected;
+    {
+      const std::vector<double> x = prtcls->get_attr("x"), z = prtcls->get_attr("z"),
+                                n = prtcls->get_attr("n"), rd3 = prtcls->get_attr("rd3");
+      for(std::size_t i = 0; i < x.size(); ++i)
+      {
+        if(!(x[i] >= 0 && x[i] < opts_init.x1))
+          throw std::runtime_error("imported SD outside of the subdomain of the process");
+        got.emplace_back(x[i] + nx_bfr * opts_init.dx, z[i], n[i], rd3[i]);
+      }
+    }
+    for(int i = 0; i < n_sd; ++i)
+      if(glob.x[i] >= nx_bfr * opts_init.dx && glob.x[i] < (nx_bfr + opts_init.nx) * opts_init.dx)
+        expected.emplace_back(glob.x[i], glob.z[i], glob.n[i], glob.rd3[i]);
+    std::sort(got.begin(), got.end());
+    std::sort(expected.begin(), expected.end());
+
+    std::cerr << "process " << rank << " SDs: " << got.size() << " (expected " << expected.size() << ")" << std::endl;
+    if(got.size() != expected.size())
+      throw std::runtime_error("wrong number of imported SDs in the process");
+    for(std::size_t i = 0; i < got.size(); ++i)
+      if(
+        std::abs(std::get<0>(got[i]) - std::get<0>(expected[i])) > 1e-12 ||
+        std::get<1>(got[i]) != std::get<1>(expected[i]) ||
+        std::get<2>(got[i]) != std::get<2>(expected[i]) ||
+        std::get<3>(got[i]) != std::get<3>(expected[i])
+      )
+        throw std::runtime_error("imported SD attributes differ from the passed ones");
+  }
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  // one SD to the right of the whole domain
+  {
+    std::vector<double> x_out(glob.x);
+    x_out[n_sd / 2] = (nx_tot + 1) * opts_init.dx;
+    if(rank == 0) attrs.x = x_out.data();
+
+    std::unique_ptr<particles_proto_t<double>> prtcls(factory<double>(backend, opts_init));
+    bool thrown = false;
+    try
+    {
+      prtcls->init_from_attrs(attrs, th, rv, rhod);
+    }
+    catch(std::runtime_error &)
+    {
+      thrown = true;
+    }
+    if(!thrown)
+      throw std::runtime_error("init_from_attrs with an SD outside of the domain did not fail");
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int provided_thread_lvl;
+  MPI_Init_thread(nullptr, nullptr, MPI_THREAD_MULTIPLE, &provided_thread_lvl);
+
+  for(auto backend : {backend_t(serial), backend_t(OpenMP)})
+  {
+    MPI_Barrier(MPI_COMM_WORLD);
+    test(backend);
+  }
+
+  MPI_Finalize();
+}
@@ -0,0 +1,320 @@
+#include <libcloudph++/lgrngn/factory.hpp>
+#include <libcloudph++/common/lognormal.hpp>
+#include <libcloudph++/common/unary_function.hpp>
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "mpi.h"
+
+// x-slab rebalancing starting from a deliberately uneven decomposition (the last process holds
+// most of the columns): the total number of SDs and the total multiplicity have to be conserved,
+// the new per-process nx have to sum up to the global nx and rebalance_hook has to report them;
+// relaxation after rebalancing has to use the volume of the new x-slab; a checkpoint written after
+// rebalancing can be loaded only in the rebalanced decomposition
+
+using namespace libcloudphxx::lgrngn;
+namespace lognormal = libcloudphxx::common::lognormal;
+
+const quantity<si::length, double> mean_rd = double(40e-9) * si::metres;
+const quantity<si::dimensionless, double> sdev_rd = double(1.4);
+const quantity<power_typeof_helper<si::length, static_rational<-3>>::type, double> n_stp = double(60e6) / si::cubic_metres;
+
+template <typename T>
+struct log_dry_radii : public libcloudphxx::common::unary_function<T>
+{
+  T funval(const T lnrd) const
+  {
+    return T(lognormal::n_e(mean_rd, sdev_rd, n_stp, quantity<si::dimensionless, double>(lnrd)) * si::cubic_metres);
+  }
+};
+
+const int nz = 3;
+
+// global number of SDs and global multiplicity (rhod = 1 and dv = 1, hence mom0 = n per cell)
+std::pair<double, double> totals(particles_proto_t<double> *prtcls, const int &n_cell)
+{
+  double lcl[2] = {0, 0}, glb[2];
+
+  prtcls->diag_all();
+  prtcls->diag_sd_conc();
+  double *out = prtcls->outbuf();
+  for(int i = 0; i < n_cell; ++i) lcl[0] += out[i];
+
+  prtcls->diag_all();
+  prtcls->diag_wet_mom(0);
+  out = prtcls->outbuf();
+  for(int i = 0; i < n_cell; ++i) lcl[1] += out[i];
+
+  MPI_Allreduce(lcl, glb, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  return {glb[0], glb[1]};
+}
+
+void test(backend_t backend)
+{
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  // decomposition as reported by rebalance_hook
+  int hook_calls = 0, hook_bfr = -1, hook_nx = -1;
+
+  opts_init_t<double> opts_init;
+  opts_init.dt = 1.;
+  opts_init.nx = rank == size - 1 ? 2 * size + 2 : 2; // uneven SD distribution
+  opts_init.nz = nz;
+  opts_init.dx = 1;
+  opts_init.dz = 1;
+  opts_init.x1 = opts_init.nx * opts_init.dx;
+  opts_init.z1 = opts_init.nz * opts_init.dz;
+  opts_init.sd_conc = 32;
+  opts_init.n_sd_max = 100 * opts_init.sd_conc * opts_init.nz;
+  opts_init.rng_seed = 4444 + rank;
+  opts_init.coal_switch = false;
+  opts_init.sedi_switch = false;
+  opts_init.rebalance_freq = 2;
+  opts_init.rebalance_hook = [&](const int &bfr, const int &nx)
+  {
+    ++hook_calls;
+    hook_bfr = bfr;
+    hook_nx = nx;
+  };
+  opts_init.dry_distros.emplace(
+    kappa_rd_insol_t<double>{double(0.61), double(0.)},
+    std::make_shared<log_dry_radii<double>>()
+  );
+
+  int nx_total;
+  MPI_Allreduce(&opts_init.nx, &nx_total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+  std::unique_ptr<particles_proto_t<double>> prtcls(factory<double>(backend, opts_init));
+
+  // Eulerian arrays following the current decomposition
+  int nx = opts_init.nx;
+  std::vector<double> vth, vrhod, vrv, vCx, vCz;
+  auto resize = [&]()
+  {
+    vth.assign(nx * nz, 300.);
+    vrhod.assign(nx * nz, 1.);
+    vrv.assign(nx * nz, 0.01);
+    vCx.assign((nx + 1) * nz, .2);
+    vCz.assign(nx * (nz + 1), 0);
+  };
+  resize();
+  long int strides[] = {0, 1, 1};
+  auto arr = [&](std::vector<double> &v) { return arrinfo_t<double>(v.data(), strides); };
+
+  prtcls->init(arr(vth), arr(vrv), arr(vrhod), arrinfo_t<double>(), arr(vCx), arrinfo_t<double>(), arr(vCz));
+
+  const std::pair<double, double> init = totals(prtcls.get(), nx * nz);
+
+  opts_t<double> opts;
+  opts.adve = true;
+  opts.sedi = opts.cond = opts.coal = false;
+
+  for(int it = 0; it < 20; ++it)
+  {
+    prtcls->step_sync(opts, arr(vth), arr(vrv), arr(vrhod), arr(vCx), arrinfo_t<double>(), arr(vCz));
+    prtcls->step_async(opts);
+
+    if(hook_calls > 0 && hook_nx != nx)
+    {
+      nx = hook_nx;
+      resize();
+    }
+
+    const std::pair<double, double> now = totals(prtcls.get(), nx * nz);
+    if(rank == 0)
+      std::cerr << "step: " << it << " nx: " << nx << " SDs: " << now.first << " (" << init.first << ")"
+                << " multiplicity: " << now.second << " (" << init.second << ")" << std::endl;
+    if(now.first != init.first)
+      throw std::runtime_error("number of SDs not conserved in rebalancing");
+    if(std::abs(now.second - init.second) > 1e-10 * init.second)
+      throw std::runtime_error("multiplicity not conserved in rebalancing");
+  }
+
+  if(size == 1)
+  {
+    if(hook_calls != 0)
+      throw std::runtime_error("rebalance_hook called with a single process");
+    return;
+  }
+
+  if(hook_calls == 0)
+    throw std::runtime_error("uneven decomposition was not rebalanced");
+
+  // decomposition reported by the hook is consistent and covers the whole domain
+  if(nx != prtcls->opts_init->nx)
+    throw std::runtime_error("rebalance_hook reported a different nx than opts_init");
+
+  int nx_sum, bfr = 0;
+  MPI_Allreduce(&nx, &nx_sum, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  MPI_Exscan(&nx, &bfr, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  if(rank == 0) bfr = 0; // MPI_Exscan leaves it undefined on rank 0
+  if(nx_sum != nx_total)
+    throw std::runtime_error("per-process nx do not sum up to the global nx after rebalancing");
+  if(hook_bfr != bfr)
+    throw std::runtime_error("rebalance_hook reported wrong bounds");
+  if(nx == opts_init.nx && rank == size - 1)
+    throw std::runtime_error("the most loaded process kept all its columns");
+
+  // checkpoint of the rebalanced state
+  const std::string path = "mpi_rebalance_test.ckpt";
+  const std::pair<double, double> saved = totals(prtcls.get(), nx * nz);
+  prtcls->save_state(path);
+
+  // the initial decomposition: processes that hold different columns now refuse to load it
+  {
+    const int nx_rbl = nx;
+    nx = opts_init.nx;
+    resize();
+    std::unique_ptr<particles_proto_t<double>> restarted(factory<double>(backend, opts_init));
+    restarted->init(arr(vth), arr(vrv), arr(vrhod), arrinfo_t<double>(), arr(vCx), arrinfo_t<double>(), arr(vCz));
+    bool threw = false;
+    try { restarted->load_state(path); }
+    catch(std::runtime_error &) { threw = true; }
+    nx = nx_rbl;
+    if(threw != (nx != opts_init.nx || bfr != 2 * rank)) // initially all but the last process hold 2 columns
+      throw std::runtime_error("checkpoint loaded in a different x-slab");
+  }
+
+  // the decomposition reported by rebalance_hook
+  {
+    resize();
+    opts_init_t<double> opts_init_rst(opts_init);
+    opts_init_rst.nx = nx;
+    opts_init_rst.x1 = nx * opts_init.dx;
+    std::unique_ptr<particles_proto_t<double>> restarted(factory<double>(backend, opts_init_rst));
+    restarted->init(arr(vth), arr(vrv), arr(vrhod), arrinfo_t<double>(), arr(vCx), arrinfo_t<double>(), arr(vCz));
+    restarted->load_state(path);
+    const std::pair<double, double> loaded = totals(restarted.get(), nx * nz);
+    if(loaded.first != saved.first || std::abs(loaded.second - saved.second) > 1e-10 * saved.second)
+      throw std::runtime_error("state not restored in the rebalanced decomposition");
+  }
+
+  std::remove((path + "." + std::to_string(rank)).c_str());
+}
+
+// relaxation towards a distribution of a kappa range with no SDs at first, switched on after the
+// decomposition was rebalanced; with the relaxation timescale equal to dt all the missing aerosol is
+// added in one step, so the mean concentration of the relaxed aerosol has to be the same in all processes
+void test_rlx(backend_t backend)
+{
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  int hook_calls = 0, hook_nx = -1;
+
+  opts_init_t<double> opts_init;
+  opts_init.dt = 1.;
+  opts_init.nx = rank == size - 1 ? 2 * size + 2 : 2; // uneven SD distribution
+  opts_init.nz = nz;
+  opts_init.dx = 1;
+  opts_init.dz = 1;
+  opts_init.x1 = opts_init.nx * opts_init.dx;
+  opts_init.z1 = opts_init.nz * opts_init.dz;
+  opts_init.sd_conc = 32;
+  opts_init.n_sd_max = 100 * opts_init.sd_conc * opts_init.nz;
+  opts_init.rng_seed = 4444 + rank;
+  opts_init.coal_switch = false;
+  opts_init.sedi_switch = false;
+  opts_init.rebalance_freq = 2;
+  opts_init.rebalance_hook = [&](const int &, const int &nx)
+  {
+    ++hook_calls;
+    hook_nx = nx;
+  };
+  opts_init.dry_distros.emplace(
+    kappa_rd_insol_t<double>{double(0.61), double(0.)},
+    std::make_shared<log_dry_radii<double>>()
+  );
+  opts_init.rlx_switch = true;
+  opts_init.rlx_bins = 16;
+  opts_init.rlx_sd_per_bin = 1;
+  opts_init.rlx_timescale = opts_init.dt;
+  opts_init.rlx_dry_distros.emplace(
+    double(1.28),
+    std::make_tuple(
+      std::make_shared<log_dry_radii<double>>(),
+      std::make_pair(double(1), double(2)),
+      std::make_pair(double(0), opts_init.z1 - opts_init.dz) // all levels but the top one
+    )
+  );
+
+  std::unique_ptr<particles_proto_t<double>> prtcls(factory<double>(backend, opts_init));
+
+  int nx = opts_init.nx;
+  std::vector<double> vth, vrhod, vrv, vCx, vCz;
+  auto resize = [&]()
+  {
+    vth.assign(nx * nz, 300.);
+    vrhod.assign(nx * nz, 1.);
+    vrv.assign(nx * nz, 0.01);
+    vCx.assign((nx + 1) * nz, .2);
+    vCz.assign(nx * (nz + 1), 0);
+  };
+  resize();
+  long int strides[] = {0, 1, 1};
+  auto arr = [&](std::vector<double> &v) { return arrinfo_t<double>(v.data(), strides); };
+
+  prtcls->init(arr(vth), arr(vrv), arr(vrhod), arrinfo_t<double>(), arr(vCx), arrinfo_t<double>(), arr(vCz));
+
+  opts_t<double> opts;
+  opts.adve = true;
+  opts.sedi = opts.cond = opts.coal = false;
+
+  // steps until the first rebalancing
+  for(int it = 0; it < 20 && hook_calls == 0; ++it)
+  {
+    prtcls->step_sync(opts, arr(vth), arr(vrv), arr(vrhod), arr(vCx), arrinfo_t<double>(), arr(vCz));
+    prtcls->step_async(opts);
+  }
+  if(hook_calls > 0 && hook_nx != nx)
+  {
+    nx = hook_nx;
+    resize();
+  }
+  if(size > 1 && hook_calls == 0)
+    throw std::runtime_error("uneven decomposition was not rebalanced");
+
+  // one step with relaxation, no rebalancing at its end (rebalance_freq = 2)
+  opts.adve = false;
+  opts.rlx = true;
+  prtcls->step_sync(opts, arr(vth), arr(vrv), arr(vrhod), arr(vCx), arrinfo_t<double>(), arr(vCz));
+  prtcls->step_async(opts);
+
+  // mean concentration of the relaxed aerosol in this process
+  prtcls->diag_kappa_rng(1, 2);
+  prtcls->diag_dry_mom(0);
+  const double *out = prtcls->outbuf();
+  double mean = 0;
+  for(int i = 0; i < nx * nz; ++i) mean += out[i];
+  mean /= nx * nz;
+
+  double mean_min, mean_max;
+  MPI_Allreduce(&mean, &mean_min, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+  MPI_Allreduce(&mean, &mean_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  if(rank == 0)
+    std::cerr << "relaxed aerosol concentration, min: " << mean_min << " max: " << mean_max << std::endl;
+  if(!(mean_min > 0))
+    throw std::runtime_error("no aerosol added by relaxation");
+  if(mean_max - mean_min > 1e-3 * mean_max)
+    throw std::runtime_error("relaxation after rebalancing differs between processes");
+}
+
+int main(int argc, char *argv[])
+{
+  int provided_thread_lvl;
+  MPI_Init_thread(nullptr, nullptr, MPI_THREAD_MULTIPLE, &provided_thread_lvl);
+
+  for(auto backend : {backend_t(serial), backend_t(OpenMP)})
+  {
+    MPI_Barrier(MPI_COMM_WORLD);
+    test(backend);
+    MPI_Barrier(MPI_COMM_WORLD);
+    test_rlx(backend);
+  }
+
+  MPI_Finalize();
+}
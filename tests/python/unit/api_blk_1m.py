@@ -2,6 +2,7 @@ import sys
 sys.path.insert(0, "../../bindings/python/")
 
 from numpy import array as arr_t # ndarray dtype default to float64, while array's is int64!
+from numpy import arange, allclose, ones, zeros, linspace
 
 from libcloudphxx import blk_1m
 
@@ -26,6 +27,8 @@ print("melB =", opts.melB)
 print("r_c0 =", opts.r_c0)
 print("r_eps =", opts.r_eps)
 print("adj_nwtrph =", opts.adj_nwtrph)
+print("nwtrph_tetens =", opts.nwtrph_tetens)
+print("nwtrph_eps =", opts.nwtrph_eps)
 print("th_dry =", opts.th_dry)
 print("const_p =", opts.const_p)
 
@@ -64,6 +67,34 @@ for name, opt in test_cases.items():
   opts.const_p = opt[2]
   test_sat_adj(opts, name)
 
+# test the Newton-Raphson saturation adjustment with Tetens formula against the exact one
+def test_sat_adj_tetens(opts, name):
+  print("Testing Tetens saturation adjustment with " + name)
+  n = 100 # more than one block of cells
+  rhod_n = rhod.repeat(n)
+  p_n    = p.repeat(n)
+  th_n   = [th.repeat(n), th.repeat(n)]
+  rv_n   = [0.02 * (arange(n) % 3) / 2., 0.02 * (arange(n) % 3) / 2.]
+  rc_n   = [0.001 * (arange(n) % 2), 0.001 * (arange(n) % 2)]
+  rr_n   = rr.repeat(n)
+  for i, tetens in enumerate([False, True]):
+    opts.nwtrph_tetens = tetens
+    blk_1m.adj_cellwise(opts, rhod_n, p_n, th_n[i], rv_n[i], rc_n[i], rr_n, dt)
+  opts.nwtrph_tetens = False
+  assert allclose(rc_n[0], rc_n[1], rtol=0, atol=5e-5)
+  assert allclose(th_n[0], th_n[1], rtol=0, atol=.2)
+  assert allclose(rv_n[0] + rc_n[0], rv_n[1] + rc_n[1], rtol=0, atol=1e-15)
+  # subsaturated cells without cloud water left untouched
+  untouched = (arange(n) % 6) == 0
+  assert (rc_n[1][untouched] == 0).all() and (rv_n[1][untouched] == 0).all() and (th_n[1][untouched] == th[0]).all()
+
+for name, opt in test_cases.items():
+  if not opt[0]: continue
+  opts.adj_nwtrph = opt[0]
+  opts.th_dry = opt[1]
+  opts.const_p = opt[2]
+  test_sat_adj_tetens(opts, name)
+
 # test RHS cellwise
 def test_rhs_cell(opts, name):
   print("Testing RHS cellwise with " + name)
@@ -97,6 +128,20 @@ flux = blk_1m.rhs_columnwise(opts, dot_rr, rhod, rr, dz)
 assert flux == 0
 assert dot_rr == dot_rr_old # no rain water -> no precip
 
+# many columns at once (vertical dimension last) give the same as one column at a time
+print("Testing RHS columnwise with many columns")
+nx, nz = 5, 10
+rhod_2d = ones((nx, nz)) * linspace(1.2, .8, nz)
+rr_2d = 1e-3 * linspace(.1, 1, nx * nz).reshape(nx, nz)
+dot_rr_2d = zeros(rr_2d.shape)
+flux_2d = blk_1m.rhs_columnwise(opts, dot_rr_2d, rhod_2d, rr_2d, dz)
+assert flux_2d.shape == (nx,)
+for i in range(nx):
+  dot_rr_1d = zeros(nz)
+  assert blk_1m.rhs_columnwise(opts, dot_rr_1d, rhod_2d[i].copy(), rr_2d[i].copy(), dz) == flux_2d[i]
+  assert (dot_rr_1d == dot_rr_2d[i]).all()
+assert (flux_2d < 0).all()
+
 #test RHS cellwise ice
 def test_rhs_cell_ice(opts, name):
   print("Testing RHS cellwise ice with " + name)
@@ -53,3 +53,55 @@ flux = blk_2m.rhs_columnwise(opts, dot_rr, dot_nr, rhod, rr, nr, dt, dz)
 assert flux == 0
 assert dot_rr == dot_rr_old and dot_nr == dot_nr_old # no rain water -> no precip
 
+
+# many columns at once (vertical dimension last) give the same as one column at a time
+from numpy import linspace, ones, zeros
+nx, ny, nz = 3, 2, 10
+rhod_3d = ones((nx, ny, nz)) * linspace(1.2, .8, nz)
+rr_3d = 1e-3 * linspace(.1, 1, nx * ny * nz).reshape(nx, ny, nz)
+nr_3d = 1e6 * linspace(1, .1, nx * ny * nz).reshape(nx, ny, nz)
+dot_rr_3d, dot_nr_3d = zeros(rr_3d.shape), zeros(nr_3d.shape)
+flux_3d = blk_2m.rhs_columnwise(opts, dot_rr_3d, dot_nr_3d, rhod_3d, rr_3d, nr_3d, dt, dz)
+assert flux_3d.shape == (nx, ny)
+for i in range(nx):
+  for j in range(ny):
+    dot_rr_1d, dot_nr_1d = zeros(nz), zeros(nz)
+    flux_1d = blk_2m.rhs_columnwise(opts, dot_rr_1d, dot_nr_1d, rhod_3d[i,j].copy(), rr_3d[i,j].copy(), nr_3d[i,j].copy(), dt, dz)
+    assert flux_1d == flux_3d[i,j] and flux_1d < 0
+    assert (dot_rr_1d == dot_rr_3d[i,j]).all()
+    assert (dot_nr_1d == dot_nr_3d[i,j]).all()
+
+
+# rhs_cellwise on many cells: the serial and OpenMP backends give the same as one cell at a time
+from libcloudphxx import lgrngn
+n = 1000
+rhod_n = linspace(1.2, .8, n)
+th_n   = linspace(285, 300, n)
+rv_n   = linspace(5e-3, 2.5e-2, n)[::-1].copy() # sub- and supersaturated cells
+rc_n   = 1e-3 * (linspace(0, 1, n) % .3)
+nc_n   = 1e8 * (linspace(0, 1, n) % .3)
+rr_n   = 1e-4 * (linspace(0, 1, n) % .2)
+nr_n   = 1e5 * (linspace(0, 1, n) % .2)
+
+def rhs_n(*backend):
+  dots = [zeros(n) for _ in range(6)]
+  blk_2m.rhs_cellwise(opts, *dots, rhod_n, th_n, rv_n, rc_n, nc_n, rr_n, nr_n, dt, *backend)
+  return dots
+
+ref = rhs_n()
+assert all((d != 0).any() for d in ref)
+for backend in [lgrngn.backend_t.serial, lgrngn.backend_t.OpenMP]:
+  for d, d_ref in zip(rhs_n(backend), ref):
+    assert (d == d_ref).all()
+
+for i in range(0, n, 37):
+  dots = [zeros(1) for _ in range(6)]
+  blk_2m.rhs_cellwise(opts, *dots, *[arr_t([a[i]]) for a in (rhod_n, th_n, rv_n, rc_n, nc_n, rr_n, nr_n)], dt)
+  for d, d_ref in zip(dots, ref):
+    assert d[0] == d_ref[i]
+
+try:
+  rhs_n(lgrngn.backend_t.CUDA)
+  assert False
+except RuntimeError:
+  pass
@@ -696,6 +696,14 @@ assert (kappa[:n] == kappa1).all()
 assert (kappa[n:2*n] == kappa2).all()
 assert (kappa[2*n:] == kappa1).all()
 
+# test if get_attrs gives the same as get_attr and if multiplicities are exported
+attrs = prtcls.get_attrs(["kappa", "n", "x"])
+assert attrs.shape == (3, kappa.size)
+assert (attrs[0] == kappa).all()
+assert (attrs[1] == prtcls.get_attr("n")).all()
+assert (attrs[2] == prtcls.get_attr("x")).all()
+assert (attrs[1] > 0).all() and (attrs[1] == attrs[1].round()).all()
+
 
 # ----------
 # 3D dry_sizes + sd_conc + tail
@@ -0,0 +1,97 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+
+from libcloudphxx import lgrngn
+
+import numpy as np
+from math import exp, log, sqrt, pi
+import os, tempfile
+
+def lognormal(lnr):
+  mean_r = .04e-6 / 2
+  stdev  = 1.4
+  n_tot  = 60e6
+  return n_tot * exp(
+    -pow((lnr - log(mean_r)), 2) / 2 / pow(log(stdev),2)
+  ) / log(stdev) / sqrt(2*pi);
+
+Opts_init = lgrngn.opts_init_t()
+kappa = .61
+rd_insol = 0.
+Opts_init.dry_distros = {(kappa, rd_insol):lognormal}
+Opts_init.coal_switch = True
+Opts_init.sedi_switch = True
+Opts_init.terminal_velocity = lgrngn.vt_t.beard76
+Opts_init.kernel = lgrngn.kernel_t.geometric
+
+Opts_init.dt = 1
+Opts_init.sstp_cond = 2
+Opts_init.sstp_coal = 2
+
+Opts_init.nz = 2
+Opts_init.nx = 2
+Opts_init.dz = 10
+Opts_init.dx = 10
+Opts_init.z1 = Opts_init.nz * Opts_init.dz
+Opts_init.x1 = Opts_init.nx * Opts_init.dx
+
+Opts_init.rng_seed = 44
+Opts_init.sd_conc = 64
+Opts_init.n_sd_max = Opts_init.sd_conc * (Opts_init.nx * Opts_init.nz)
+
+Backend = lgrngn.backend_t.serial
+
+Opts = lgrngn.opts_t()
+Opts.adve = False
+Opts.sedi = True
+Opts.cond = True
+Opts.coal = True
+Opts.rcyc = False
+
+Rhod =   1. * np.ones((Opts_init.nx, Opts_init.nz))
+Th   = 300. * np.ones((Opts_init.nx, Opts_init.nz))
+Rv   = 0.02 * np.ones((Opts_init.nx, Opts_init.nz))
+
+path = os.path.join(tempfile.mkdtemp(), "prtcls.ckpt")
+
+def run(prtcls, th, rv, n_steps):
+  for it in range(n_steps):
+    prtcls.step_sync(Opts, th, rv, Rhod)
+    prtcls.step_async(Opts)
+
+# reference run, saving the state halfway
+prtcls = lgrngn.factory(Backend, Opts_init)
+prtcls.init(Th, Rv, Rhod)
+th, rv = np.copy(Th), np.copy(Rv)
+run(prtcls, th, rv, 10)
+prtcls.save_state(path)
+th_ckpt, rv_ckpt = np.copy(th), np.copy(rv)
+run(prtcls, th, rv, 10)
+
+# restarted run
+restarted = lgrngn.factory(Backend, Opts_init)
+restarted.init(Th, Rv, Rhod)
+restarted.load_state(path)
+run(restarted, th_ckpt, rv_ckpt, 10)
+
+# restart has to be bitwise reproducible
+for attr in ["rw2", "rd3", "kappa", "x", "z"]:
+  ref = np.array(prtcls.get_attr(attr))
+  rst = np.array(restarted.get_attr(attr))
+  assert(ref.shape == rst.shape)
+  assert((ref == rst).all())
+
+assert((th == th_ckpt).all())
+assert((rv == rv_ckpt).all())
+assert(prtcls.diag_puddle() == restarted.diag_puddle())
+
+# checkpoint of a different setup cannot be loaded
+Opts_init.nx = 1
+Opts_init.x1 = Opts_init.nx * Opts_init.dx
+other = lgrngn.factory(Backend, Opts_init)
+other.init(Th[:1,:], Rv[:1,:], Rhod[:1,:])
+try:
+  other.load_state(path)
+  raise Exception("checkpoint of a different setup loaded")
+except RuntimeError:
+  pass
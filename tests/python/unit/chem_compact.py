@@ -0,0 +1,128 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+
+from libcloudphxx import lgrngn, common
+import numpy as np
+
+# chemistry is computed only for the SDs flagged in chem_flag_ante, gathered (grouped by cell)
+# into dense arrays once per step and scattered back after all the chemistry substeps;
+# as when all SDs were walked through with the flag as a stencil:
+# - each cell evolves as if it was simulated alone (same SDs, same ambient conditions)
+# - SDs too concentrated to be flagged (haze) are not altered
+# Henry's law for all trace gases at once (fused reduction of the changes in mass) conserves,
+# as the per-species passes did, the total mass of each trace gas (gas + dissolved) in each cell
+
+nz = 3
+dz = 10.
+dt = 1.
+chem = lgrngn.chem_species_t
+species = [chem.SO2, chem.O3, chem.H2O2, chem.CO2, chem.NH3, chem.HNO3, chem.S_VI, chem.H]
+gases = [chem.SO2, chem.O3, chem.H2O2, chem.CO2, chem.NH3, chem.HNO3]
+
+# ambient conditions differing between cells
+p = 95000.
+T = np.array([283., 285.2, 288.])
+rv = 1.01 * np.array([common.r_vs(T_, p) for T_ in T])
+th_std = T * pow(1e5 / p, 287. / 1005.)
+rhod = np.array([common.rhod(p, th_std[k], rv[k]) for k in range(nz)])
+th = np.array([common.th_std2dry(th_std[k], rv[k]) for k in range(nz)])
+
+M_air = 28.97e-3
+ambient_chem_init = {
+  chem.SO2  : 200e-12 * 64e-3 / M_air * np.array([1., 2., .5]),
+  chem.O3   : 50e-9   * 48e-3 / M_air * np.ones(nz),
+  chem.H2O2 : 500e-12 * 34e-3 / M_air * np.array([.5, 1., 2.]),
+  chem.CO2  : 360e-6  * 44e-3 / M_air * np.ones(nz),
+  chem.NH3  : 100e-12 * 17e-3 / M_air * np.array([2., 1., 1.]),
+  chem.HNO3 : 100e-12 * 63e-3 / M_air * np.array([1., 1., 3.])
+}
+
+# in each cell: cloud droplets (flagged) and concentrated haze (not flagged), interleaved
+r_haze_max = 1e-6
+sd_k, sd_n, sd_rd, sd_rw = [], [], [], []
+for k in range(nz):
+  for i in range(4):
+    sd_k  += [k, k]
+    sd_n  += [int(1e8 * (i + 1) * (k + 1)), int(3e8 * (i + 1))]
+    sd_rd += [(.05 + .02 * i + .01 * k) * 1e-6, (.3 + .1 * i) * 1e-6]
+    sd_rw += [(5 + 3 * i + k) * 1e-6, (.4 + .15 * i) * 1e-6]
+sd_k, sd_n, sd_rd, sd_rw = np.array(sd_k), np.array(sd_n, dtype=np.uint64), np.array(sd_rd), np.array(sd_rw)
+assert (sd_rw[1::2] < r_haze_max).all() and (sd_rw[0::2] > r_haze_max).all()
+
+def run(cells, chem_rct = True):
+  n_cell = len(cells)
+  opts_init = lgrngn.opts_init_t()
+  opts_init.dt = dt
+  opts_init.nz = n_cell
+  opts_init.dz = dz
+  opts_init.z1 = n_cell * dz
+  opts_init.n_sd_max = len(sd_k)
+  opts_init.chem_switch = True
+  opts_init.chem_rho = 1.8e3
+  opts_init.coal_switch = False
+  opts_init.sedi_switch = False
+  opts_init.sstp_chem = 4
+
+  sel = np.isin(sd_k, cells)
+  z = (np.searchsorted(cells, sd_k[sel]) + .5) * dz
+  ambient_chem = dict((g, v[cells].copy()) for g, v in ambient_chem_init.items())
+  th_, rv_, rhod_ = th[cells].copy(), rv[cells].copy(), rhod[cells].copy()
+
+  prtcls = lgrngn.factory(lgrngn.backend_t.serial, opts_init)
+  prtcls.init_from_attrs(th_, rv_, rhod_, ambient_chem = ambient_chem,
+    n = sd_n[sel], rd3 = sd_rd[sel]**3, kappa = .61 * np.ones(sel.sum()), z = z, rw2 = sd_rw[sel]**2)
+
+  # dissolved species in all SDs or only in the haze
+  def aq(haze = False):
+    if haze:
+      prtcls.diag_wet_rng(0, r_haze_max)
+    else:
+      prtcls.diag_all()
+    out = []
+    for s in species:
+      prtcls.diag_chem(s)
+      out.append(np.frombuffer(prtcls.outbuf()).copy())
+    return np.array(out)
+
+  haze_init = aq(haze = True)
+  aq_init, gas_init = aq(), np.array([ambient_chem[g] for g in gases])
+
+  opts = lgrngn.opts_t()
+  opts.adve = False
+  opts.sedi = False
+  opts.coal = False
+  opts.cond = False
+  opts.chem_dsl = True
+  opts.chem_dsc = True
+  opts.chem_rct = chem_rct
+
+  for _ in range(20):
+    prtcls.step_sync(opts, th_, rv_, rhod_, ambient_chem = ambient_chem)
+    prtcls.step_async(opts)
+
+  assert (aq(haze = True) == haze_init).all(), "chemistry altered SDs that are not flagged"
+
+  return aq_init, gas_init, aq(), np.array([ambient_chem[g] for g in gases])
+
+_, gas_0, aq, gas = run(list(range(nz)))
+print("aqueous S_VI per cell:", aq[species.index(chem.S_VI)])
+
+for k in range(nz):
+  _, _, aq_k, gas_k = run([k])
+  assert np.allclose(aq[:, k], aq_k[:, 0], rtol=1e-12, atol=0), "aqueous chemistry of cell %d differs when simulated alone" % k
+  assert np.allclose(gas[:, k], gas_k[:, 0], rtol=1e-12, atol=0), "trace gases of cell %d differ when simulated alone" % k
+
+# gases were taken up by the droplets
+assert (gas[gases.index(chem.SO2)] < gas_0[gases.index(chem.SO2)]).all(), "no SO2 dissolved"
+
+# without oxidation: gas + dissolved mass of each trace gas conserved in each cell
+# (dissolved species are counted as hydrated, hence the ratio of molar masses)
+M_gas = {chem.SO2 : 64e-3, chem.O3 : 48e-3, chem.H2O2 : 34e-3, chem.CO2 : 44e-3, chem.NH3 : 17e-3, chem.HNO3 : 63e-3}
+M_aq  = {chem.SO2 : 82e-3, chem.O3 : 48e-3, chem.H2O2 : 34e-3, chem.CO2 : 62e-3, chem.NH3 : 35e-3, chem.HNO3 : 63e-3}
+aq_0, gas_0, aq, gas = run(list(range(nz)), chem_rct = False)
+for i, g in enumerate(gases):
+  total_0 = gas_0[i] + aq_0[species.index(g)] * M_gas[g] / M_aq[g]
+  total   = gas[i]   + aq[species.index(g)]   * M_gas[g] / M_aq[g]
+  print(g, "dissolved fraction:", aq[species.index(g)] * M_gas[g] / M_aq[g] / total)
+  assert (aq[species.index(g)] != aq_0[species.index(g)]).all(), "%s not dissolved" % g
+  assert np.allclose(total, total_0, rtol=1e-10, atol=0), "%s mass not conserved in Henry's law" % g
@@ -0,0 +1,105 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+
+from libcloudphxx import lgrngn, common
+import numpy as np
+
+# S(IV) oxidation in a supersaturated parcel computed with the explicit (rk4)
+# and the per-SD implicit (ros2) chemistry solvers, and H+ after dissociation computed
+# with the root finding started from the fixed bracket and from the previous H+ (chem_dissoc_warm_start)
+
+p = 95000.
+T = 285.2
+rv = 1.03 * common.r_vs(T, p) * np.ones((1,))
+th_std = T * pow(1e5 / p, 287. / 1005.)
+rhod = common.rhod(p, th_std, rv[0]) * np.ones((1,))
+th = common.th_std2dry(th_std, rv[0]) * np.ones((1,))
+
+# trace gas mass mixing ratios (volume mixing ratio * M_gas / M_air)
+M_air = 28.97e-3
+ambient_chem_init = {
+  lgrngn.chem_species_t.SO2  : 200e-12 * 64e-3 / M_air,
+  lgrngn.chem_species_t.O3   : 50e-9   * 48e-3 / M_air,
+  lgrngn.chem_species_t.H2O2 : 500e-12 * 34e-3 / M_air,
+  lgrngn.chem_species_t.CO2  : 360e-6  * 44e-3 / M_air,
+  lgrngn.chem_species_t.NH3  : 100e-12 * 17e-3 / M_air,
+  lgrngn.chem_species_t.HNO3 : 100e-12 * 63e-3 / M_air
+}
+
+def lognormal(lnr):
+  mean_r = .04e-6
+  stdev = 1.4
+  n_tot = 100e6
+  return n_tot * np.exp(
+    -pow((lnr - np.log(mean_r)), 2) / 2 / pow(np.log(stdev), 2)
+  ) / np.log(stdev) / np.sqrt(2 * np.pi)
+
+def run(chem_solver, warm_start = False):
+  opts_init = lgrngn.opts_init_t()
+  opts_init.dt = 1.
+  opts_init.sd_conc = 64
+  opts_init.n_sd_max = 64
+  opts_init.dry_distros = {(.61, 0.):lognormal}
+  opts_init.chem_switch = True
+  opts_init.chem_rho = 1.8e3
+  opts_init.coal_switch = False
+  opts_init.sedi_switch = False
+  opts_init.sstp_cond = 10
+  opts_init.sstp_chem = 5
+  opts_init.chem_solver = chem_solver
+  opts_init.chem_dissoc_warm_start = warm_start
+  print("chem_solver =", opts_init.chem_solver, "chem_ros2_eps =", opts_init.chem_ros2_eps,
+        "chem_dissoc_warm_start =", opts_init.chem_dissoc_warm_start)
+
+  ambient_chem = dict((k, v * np.ones((1,))) for k, v in ambient_chem_init.items())
+  th_, rv_ = th.copy(), rv.copy()
+
+  prtcls = lgrngn.factory(lgrngn.backend_t.serial, opts_init)
+  prtcls.init(th_, rv_, rhod, ambient_chem = ambient_chem)
+
+  prtcls.diag_all()
+  prtcls.diag_chem(lgrngn.chem_species_t.S_VI)
+  S_VI_init = np.frombuffer(prtcls.outbuf())[0]
+
+  opts = lgrngn.opts_t()
+  opts.adve = False
+  opts.sedi = False
+  opts.coal = False
+  opts.cond = True
+  opts.chem_dsl = True
+  opts.chem_dsc = True
+  opts.chem_rct = True
+
+  n_iter = 0
+  for _ in range(100):
+    prtcls.step_sync(opts, th_, rv_, rhod, ambient_chem = ambient_chem)
+    prtcls.step_async(opts)
+    prtcls.diag_chem_dissoc_iter()
+    n_iter += np.frombuffer(prtcls.outbuf())[0]
+
+  prtcls.diag_all()
+  prtcls.diag_chem(lgrngn.chem_species_t.S_VI)
+  S_VI = np.frombuffer(prtcls.outbuf())[0]
+  prtcls.diag_chem(lgrngn.chem_species_t.SO2)
+  S_IV = np.frombuffer(prtcls.outbuf())[0]
+  prtcls.diag_chem(lgrngn.chem_species_t.H)
+  H = np.frombuffer(prtcls.outbuf())[0]
+  return S_VI_init, S_VI, S_IV, H, n_iter
+
+S_VI_init, S_VI_rk4, S_IV_rk4, H_cold, n_iter_cold = run(lgrngn.chem_solver_t.rk4)
+_, S_VI_ros2, S_IV_ros2, _, _ = run(lgrngn.chem_solver_t.ros2)
+print("S_VI: init", S_VI_init, "rk4", S_VI_rk4, "ros2", S_VI_ros2)
+print("S_IV: rk4", S_IV_rk4, "ros2", S_IV_ros2)
+
+assert np.isfinite(S_VI_ros2) and np.isfinite(S_IV_ros2) and S_IV_ros2 >= 0
+assert S_VI_rk4 > S_VI_init and S_VI_ros2 > S_VI_init, "no S(IV) oxidation"
+assert np.isclose(S_VI_ros2 - S_VI_init, S_VI_rk4 - S_VI_init, rtol=5e-2, atol=0), "rk4 and ros2 S(VI) production differ"
+
+# warm-started dissociation
+_, _, _, H_warm, n_iter_warm = run(lgrngn.chem_solver_t.rk4, warm_start = True)
+print("H: cold", H_cold, "warm", H_warm)
+print("mean function evaluations per SD: cold", n_iter_cold / 100, "warm", n_iter_warm / 100)
+
+assert n_iter_cold > 0, "no SDs flagged for chemistry"
+assert np.isclose(H_warm, H_cold, rtol=1e-4, atol=0), "H+ differs between cold- and warm-started root finding"
+assert n_iter_warm < n_iter_cold, "warm start did not reduce the number of iterations"
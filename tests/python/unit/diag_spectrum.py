@@ -0,0 +1,63 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+
+from libcloudphxx import lgrngn
+
+import numpy as np
+from math import exp, log, sqrt, pi
+
+def lognormal(lnr):
+  mean_r = .04e-6 / 2
+  stdev  = 1.4
+  n_tot  = 60e6
+  return n_tot * exp(
+    -pow((lnr - log(mean_r)), 2) / 2 / pow(log(stdev),2)
+  ) / log(stdev) / sqrt(2*pi);
+
+Opts_init = lgrngn.opts_init_t()
+Opts_init.dry_distros = {(.61, 0.):lognormal}
+Opts_init.dt = 1
+
+Opts_init.nz = 3
+Opts_init.nx = 2
+Opts_init.dz = 10
+Opts_init.dx = 10
+Opts_init.z1 = Opts_init.nz * Opts_init.dz
+Opts_init.x1 = Opts_init.nx * Opts_init.dx
+
+Opts_init.rng_seed = 44
+Opts_init.sd_conc = 256
+Opts_init.n_sd_max = Opts_init.sd_conc * (Opts_init.nx * Opts_init.nz)
+
+n_cell = Opts_init.nx * Opts_init.nz
+
+Rhod =   1. * np.ones((Opts_init.nx, Opts_init.nz))
+Th   = 300. * np.ones((Opts_init.nx, Opts_init.nz))
+Rv   = 0.01 * np.ones((Opts_init.nx, Opts_init.nz))
+
+prtcls = lgrngn.factory(lgrngn.backend_t.serial, Opts_init)
+prtcls.init(Th, Rv, Rhod)
+
+r_edges = np.logspace(np.log10(1e-9), np.log10(1e-6), 41)
+
+for diag_spectrum, diag_rng, diag_mom in [
+  (prtcls.diag_dry_spectrum, prtcls.diag_dry_rng, prtcls.diag_dry_mom),
+  (prtcls.diag_wet_spectrum, prtcls.diag_wet_rng, prtcls.diag_wet_mom)
+]:
+  for k in [0, 3]:
+    spec = diag_spectrum(r_edges, k)
+    assert(isinstance(spec, np.ndarray) and spec.shape == (len(r_edges) - 1, n_cell))
+
+    # the same, bin by bin
+    for b in range(len(r_edges) - 1):
+      diag_rng(r_edges[b], r_edges[b+1])
+      diag_mom(k)
+      ref = np.frombuffer(prtcls.outbuf())
+      assert(np.allclose(spec[b], ref, rtol=1e-10, atol=0))
+
+# bin edges have to be increasing
+try:
+  prtcls.diag_wet_spectrum(r_edges[::-1].copy(), 0)
+  raise Exception("decreasing bin edges accepted")
+except RuntimeError:
+  pass
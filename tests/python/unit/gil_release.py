@@ -0,0 +1,104 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+
+from libcloudphxx import lgrngn
+
+import numpy as np
+import threading
+import time
+from math import exp, log, sqrt, pi
+
+def lognormal(lnr):
+  mean_r = .04e-6 / 2
+  stdev  = 1.4
+  n_tot  = 60e6
+  return n_tot * exp(
+    -pow((lnr - log(mean_r)), 2) / 2 / pow(log(stdev),2)
+  ) / log(stdev) / sqrt(2*pi);
+
+Opts_init = lgrngn.opts_init_t()
+Opts_init.dry_distros = {(.61, 0.):lognormal}
+Opts_init.dt = 1
+Opts_init.nx = 2
+Opts_init.nz = 3
+Opts_init.dx = 10
+Opts_init.dz = 10
+Opts_init.x1 = Opts_init.nx * Opts_init.dx
+Opts_init.z1 = Opts_init.nz * Opts_init.dz
+Opts_init.rng_seed = 44
+Opts_init.sd_conc = 64
+Opts_init.n_sd_max = Opts_init.sd_conc * Opts_init.nx * Opts_init.nz
+
+Opts = lgrngn.opts_t()
+Opts.adve = False
+Opts.sedi = False
+
+shape = (Opts_init.nx, Opts_init.nz)
+
+# each member initialised (with callbacks into lognormal) and stepped in its own thread
+def run(out, i):
+  th   = 300. * np.ones(shape)
+  rv   = 0.01 * np.ones(shape)
+  rhod =   1. * np.ones(shape)
+  prtcls = lgrngn.factory(lgrngn.backend_t.serial, Opts_init)
+  prtcls.init(th, rv, rhod)
+  for t in range(5):
+    prtcls.step_sync(Opts, th, rv, rhod)
+    prtcls.step_async(Opts)
+  prtcls.diag_all()
+  prtcls.diag_wet_mom(3)
+  out[i] = np.frombuffer(prtcls.outbuf()).copy()
+
+ref = {}
+run(ref, 0)
+
+out = {}
+threads = [threading.Thread(target=run, args=(out, i)) for i in range(4)]
+for t in threads: t.start()
+for t in threads: t.join()
+
+for i in range(4):
+  assert(np.array_equal(out[i], ref[0]))
+
+# another Python thread has to make progress while the C++ code is running
+# (with the GIL held, it would not be able to record any time stamp within a call)
+Opts_init.nx = 64
+Opts_init.nz = 64
+Opts_init.x1 = Opts_init.nx * Opts_init.dx
+Opts_init.z1 = Opts_init.nz * Opts_init.dz
+Opts_init.sd_conc = 128
+Opts_init.n_sd_max = Opts_init.sd_conc * Opts_init.nx * Opts_init.nz
+Opts_init.sstp_cond = 20
+shape = (Opts_init.nx, Opts_init.nz)
+
+th   = 300. * np.ones(shape)
+rv   = 0.01 * np.ones(shape)
+rhod =   1. * np.ones(shape)
+prtcls = lgrngn.factory(lgrngn.backend_t.serial, Opts_init)
+prtcls.init(th, rv, rhod)
+
+ticks = []
+done = threading.Event()
+def ticker():
+  while not done.is_set():
+    ticks.append(time.perf_counter())
+    time.sleep(1e-3)
+thread = threading.Thread(target=ticker)
+thread.start()
+
+calls = []
+for t in range(3):
+  for call in [lambda: prtcls.step_sync(Opts, th, rv, rhod), lambda: prtcls.step_async(Opts)]:
+    t0 = time.perf_counter()
+    call()
+    calls.append((t0, time.perf_counter()))
+
+done.set()
+thread.join()
+
+# ticks in the middle halves of the calls
+duration = sum((t1 - t0) / 2 for t0, t1 in calls)
+n_ticks = sum(1 for t0, t1 in calls for tick in ticks if t0 + (t1 - t0) / 4 < tick < t1 - (t1 - t0) / 4)
+print("time in the middle halves of the calls:", duration, "s, ticks of the other thread:", n_ticks)
+assert(duration > .05)
+assert(n_ticks >= 5)
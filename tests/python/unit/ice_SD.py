@@ -60,4 +60,28 @@ for time_dep_switch in [True, False]:
     assert np.isnan(ri[0]) == False
     assert np.isnan(rv[0]) == False
     assert rv[0] >= 0
-    assert ri[0] >= 0
\ No newline at end of file
+    assert ri[0] >= 0
+# above freezing the ice stages are skipped, results are the same as without ice nucleation
+for time_dep_switch in [True, False]:
+    print("warm parcel, time dependent ice nucleation = ", time_dep_switch)
+    p = 90000.
+    T = 283.
+    rv_res = []
+    for ice_nucl in [True, False]:
+        rv = np.array([1.01 * common.r_vs(T, p)])
+        th = np.array([T / common.exner(p)])
+        rhod = np.array([common.rhod(p, th[0], rv[0])])
+
+        opts_init.time_dep_ice_nucl = time_dep_switch
+        opts.ice_nucl = ice_nucl
+        prtcls = lgrngn.factory(backend, opts_init)
+        prtcls.init(th, rv, rhod)
+        for _ in range(50):
+            prtcls.step_sync(opts, th, rv, rhod)
+            prtcls.step_async(opts)
+        prtcls.diag_all()
+        prtcls.diag_ice_mix_ratio()
+        assert np.frombuffer(prtcls.outbuf())[0] == 0
+        rv_res.append(rv[0])
+    print("rv with and without ice nucleation ", rv_res)
+    assert rv_res[0] == rv_res[1]
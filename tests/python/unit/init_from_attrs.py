@@ -0,0 +1,83 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+
+from libcloudphxx import lgrngn
+
+import numpy as np
+
+Opts_init = lgrngn.opts_init_t()
+Opts_init.dt = 1
+
+Opts_init.nz = 2
+Opts_init.nx = 2
+Opts_init.dz = 10
+Opts_init.dx = 10
+Opts_init.z1 = Opts_init.nz * Opts_init.dz
+Opts_init.x1 = Opts_init.nx * Opts_init.dx
+
+n_sd = 100
+Opts_init.n_sd_max = n_sd
+
+Rhod =   1. * np.ones((Opts_init.nx, Opts_init.nz))
+Th   = 300. * np.ones((Opts_init.nx, Opts_init.nz))
+Rv   = 0.01 * np.ones((Opts_init.nx, Opts_init.nz))
+
+# pre-generated SDs, e.g. from another model
+rng = np.random.RandomState(44)
+n     = rng.randint(1, 1000, n_sd).astype(np.uint64)
+rd3   = (rng.uniform(0.01e-6, 1e-6, n_sd))**3
+kappa = rng.uniform(0.1, 1.2, n_sd)
+x     = rng.uniform(0, Opts_init.x1, n_sd)
+z     = rng.uniform(0, Opts_init.z1, n_sd)
+rw2   = rd3**(2./3) * 4
+
+Backend = lgrngn.backend_t.serial
+
+# wet radii given
+prtcls = lgrngn.factory(Backend, Opts_init)
+prtcls.init_from_attrs(Th, Rv, Rhod, n=n, rd3=rd3, kappa=kappa, x=x, z=z, rw2=rw2)
+
+# order of SDs does not have to be preserved
+order = np.lexsort((z, x))
+got = {attr : np.array(prtcls.get_attr(attr)) for attr in ["rd3", "kappa", "x", "z", "rw2"]}
+got_order = np.lexsort((got["z"], got["x"]))
+for attr, ref in [("rd3", rd3), ("kappa", kappa), ("x", x), ("z", z), ("rw2", rw2)]:
+  assert(got[attr].shape == (n_sd,))
+  assert(np.allclose(got[attr][got_order], ref[order], rtol=1e-12, atol=0))
+
+# number of SDs and particles per cell
+prtcls.diag_all()
+prtcls.diag_sd_conc()
+sd_conc = np.frombuffer(prtcls.outbuf()).reshape(Opts_init.nx, Opts_init.nz)
+ref_conc = np.histogram2d(x, z, bins=[Opts_init.nx, Opts_init.nz], range=[[0, Opts_init.x1], [0, Opts_init.z1]])[0]
+assert((sd_conc == ref_conc).all())
+
+prtcls.diag_all()
+prtcls.diag_wet_mom(0)
+n_conc = np.frombuffer(prtcls.outbuf()).reshape(Opts_init.nx, Opts_init.nz)
+dv = Opts_init.dx * Opts_init.dz
+ref_n = np.histogram2d(x, z, bins=[Opts_init.nx, Opts_init.nz], range=[[0, Opts_init.x1], [0, Opts_init.z1]], weights=n.astype(np.float64))[0] / dv
+assert(np.allclose(n_conc, ref_n / Rhod, rtol=1e-12))
+
+# wet radii not given - equilibrium with ambient RH
+prtcls = lgrngn.factory(Backend, Opts_init)
+prtcls.init_from_attrs(Th, Rv, Rhod, n=n, rd3=rd3, kappa=kappa, x=x, z=z)
+assert((np.array(prtcls.get_attr("rw2")) >= np.array(prtcls.get_attr("rd3"))**(2./3)).all())
+
+# positions are mandatory
+prtcls = lgrngn.factory(Backend, Opts_init)
+try:
+  prtcls.init_from_attrs(Th, Rv, Rhod, n=n, rd3=rd3, kappa=kappa, x=x)
+  raise Exception("init_from_attrs without z positions did not fail")
+except RuntimeError:
+  pass
+
+# SDs outside of the domain are not dropped silently
+x_out = x.copy()
+x_out[:3] = Opts_init.x1 + 1
+prtcls = lgrngn.factory(Backend, Opts_init)
+try:
+  prtcls.init_from_attrs(Th, Rv, Rhod, n=n, rd3=rd3, kappa=kappa, x=x_out, z=z)
+  raise Exception("init_from_attrs with SDs outside of the domain did not fail")
+except RuntimeError as e:
+  assert("3 of the imported SDs" in str(e))
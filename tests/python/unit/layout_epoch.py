@@ -0,0 +1,97 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+
+from libcloudphxx import lgrngn
+
+import numpy as np
+import os, tempfile
+
+# the number of SDs per cell (count_ijk, count_num) and the coalescence scale factors and in-cell
+# offsets are cached until the particle layout changes; diagnostics that overwrite the counts
+# between the calls must not alter the results:
+# - "cached": the caches are used as in any simulation
+# - "diag": moment diagnostics overwrite the counts after step_sync and after step_async
+# - "forced": save_state/load_state before each step, load_state invalidates the layout,
+#   so the counts and the coalescence factors are recomputed (the state itself is restored bitwise)
+
+Opts_init = lgrngn.opts_init_t()
+Opts_init.coal_switch = True
+Opts_init.sedi_switch = False
+Opts_init.kernel = lgrngn.kernel_t.hall
+Opts_init.terminal_velocity = lgrngn.vt_t.beard76
+
+Opts_init.dt = 1
+Opts_init.sstp_cond = 2
+Opts_init.sstp_coal = 4
+
+Opts_init.nz = 2
+Opts_init.nx = 3
+Opts_init.dz = 10
+Opts_init.dx = 10
+Opts_init.z1 = Opts_init.nz * Opts_init.dz
+Opts_init.x1 = Opts_init.nx * Opts_init.dx
+
+Opts_init.rng_seed = 44
+
+# cloud droplets placed randomly, hence different numbers of SDs in each cell
+n_sd = 32 * Opts_init.nx * Opts_init.nz
+Opts_init.n_sd_max = n_sd
+rng = np.random.RandomState(44)
+sd_n     = (3e8 * rng.uniform(.5, 2, n_sd)).astype(np.uint64) # ~100 per cm3
+sd_rd3   = rng.uniform(.05e-6, .2e-6, n_sd)**3
+sd_rw2   = rng.uniform(5e-6, 30e-6, n_sd)**2
+sd_x     = rng.uniform(0, Opts_init.x1, n_sd)
+sd_z     = rng.uniform(0, Opts_init.z1, n_sd)
+
+Backend = lgrngn.backend_t.serial
+
+Opts = lgrngn.opts_t()
+Opts.adve = False
+Opts.sedi = False
+Opts.cond = True
+Opts.coal = True
+Opts.rcyc = False
+
+Rhod =   1. * np.ones((Opts_init.nx, Opts_init.nz))
+Th   = 300. * np.ones((Opts_init.nx, Opts_init.nz))
+Rv   = 0.0225 * np.ones((Opts_init.nx, Opts_init.nz))
+
+path = os.path.join(tempfile.mkdtemp(), "layout_epoch.ckpt")
+
+def diag(prtcls):
+  out = []
+  prtcls.diag_all()
+  prtcls.diag_sd_conc()
+  out.append(np.frombuffer(prtcls.outbuf()).copy())
+  for k in range(4):
+    prtcls.diag_all()
+    prtcls.diag_wet_mom(k)
+    out.append(np.frombuffer(prtcls.outbuf()).copy())
+  return np.array(out)
+
+def run(mode):
+  prtcls = lgrngn.factory(Backend, Opts_init)
+  th, rv = np.copy(Th), np.copy(Rv)
+  prtcls.init_from_attrs(th, rv, Rhod, n = sd_n, rd3 = sd_rd3, kappa = .61 * np.ones(n_sd), x = sd_x, z = sd_z, rw2 = sd_rw2)
+  for it in range(30):
+    if mode == "forced":
+      prtcls.save_state(path)
+      prtcls.load_state(path)
+    prtcls.step_sync(Opts, th, rv, Rhod)
+    if mode == "diag":
+      diag(prtcls)
+    prtcls.step_async(Opts)
+    if mode == "diag":
+      diag(prtcls)
+  return prtcls, th, rv
+
+ref, ref_th, ref_rv = run("forced")
+ref_diag = diag(ref)
+ref_attrs = ref.get_attrs(["n", "rw2", "rd3"])
+assert ref_attrs[0].sum() < sd_n.sum(), "no coalescence"
+
+for mode in ["cached", "diag"]:
+  prtcls, th, rv = run(mode)
+  assert np.array_equal(prtcls.get_attrs(["n", "rw2", "rd3"]), ref_attrs), "SD attributes differ (%s)" % mode
+  assert np.array_equal(diag(prtcls), ref_diag), "diagnosed moments differ (%s)" % mode
+  assert (th == ref_th).all() and (rv == ref_rv).all(), "Eulerian fields differ (%s)" % mode
@@ -0,0 +1,95 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+sys.path.insert(0, "../../../build/bindings/python/")
+
+from libcloudphxx import lgrngn
+
+from numpy import frombuffer, ones, copy, array_equal
+from math import exp, log, sqrt, pi
+
+# T, p and RH are recomputed only if th, rv or rhod changed, and the per-cell SD counts
+# only if the SDs were resorted; check that the diagnostics never return stale values
+
+def lognormal(lnr):
+  mean_r = .04e-6 / 2
+  stdev  = 1.4
+  n_tot  = 60e6
+  return n_tot * exp(
+    -pow((lnr - log(mean_r)), 2) / 2 / pow(log(stdev),2)
+  ) / log(stdev) / sqrt(2*pi);
+
+opts_init = lgrngn.opts_init_t()
+opts_init.dry_distros = {(.61, 0.):lognormal}
+opts_init.coal_switch = 0
+opts_init.sedi_switch = 0
+opts_init.dt = 1
+opts_init.sd_conc = 64
+opts_init.n_sd_max = 512
+opts_init.nx = 2
+opts_init.dx = 1
+opts_init.x1 = opts_init.nx * opts_init.dx
+opts_init.nz = 2
+opts_init.dz = 1
+opts_init.z1 = opts_init.nz * opts_init.dz
+
+rhod = 1. * ones((opts_init.nx, opts_init.nz))
+Cx = 1. * ones((opts_init.nx+1, opts_init.nz))
+Cz = 0. * ones((opts_init.nx, opts_init.nz+1))
+th = 300 * ones((opts_init.nx, opts_init.nz))
+rv = .0025 * ones((opts_init.nx, opts_init.nz))
+th2 = th + 5
+rv2 = rv + .001
+
+opts = lgrngn.opts_t()
+opts.adve = 0
+opts.sedi = 0
+opts.coal = 0
+opts.cond = 0
+
+def thermo(prtcls):
+  out = []
+  for diag in [prtcls.diag_temperature, prtcls.diag_pressure, prtcls.diag_RH]:
+    diag()
+    out.append(copy(frombuffer(prtcls.outbuf())))
+  return out
+
+def counts(prtcls):
+  out = []
+  for _ in range(2):
+    prtcls.diag_sd_conc()
+    out.append(copy(frombuffer(prtcls.outbuf())))
+    prtcls.diag_all()
+    prtcls.diag_wet_mom(3)
+    out.append(copy(frombuffer(prtcls.outbuf())))
+  return out
+
+# reference: th2 and rv2 passed at init
+ref = lgrngn.factory(lgrngn.backend_t.serial, opts_init)
+ref.init(th2, rv2, rhod, Cx=Cx, Cz=Cz)
+T_ref = thermo(ref)
+
+prtcls = lgrngn.factory(lgrngn.backend_t.serial, opts_init)
+prtcls.init(th, rv, rhod, Cx=Cx, Cz=Cz)
+T_0 = thermo(prtcls)
+assert all(array_equal(a, b) for a, b in zip(T_0, thermo(prtcls)))
+assert not any(array_equal(a, b) for a, b in zip(T_0, T_ref))
+
+# new th and rv passed in step_sync have to be seen by the diagnostics
+prtcls.step_sync(opts, th2, rv2)
+assert all(array_equal(a, b) for a, b in zip(thermo(prtcls), T_ref))
+prtcls.step_async(opts)
+assert all(array_equal(a, b) for a, b in zip(thermo(prtcls), T_ref))
+
+# repeated diagnostics with the same SDs give the same results
+c_0 = counts(prtcls)
+assert array_equal(c_0[0], c_0[2]) and array_equal(c_0[1], c_0[3])
+assert c_0[0].sum() == 4 * opts_init.sd_conc
+
+# advection resorts the SDs, so the counts have to follow
+opts.adve = 1
+Cx[:] = .5
+prtcls.step_sync(opts, th2, rv2, Cx=Cx, Cz=Cz)
+prtcls.step_async(opts)
+c_1 = counts(prtcls)
+assert array_equal(c_1[0], c_1[2]) and array_equal(c_1[1], c_1[3])
+assert c_1[0].sum() == 4 * opts_init.sd_conc
@@ -30,6 +30,7 @@ Opts_init.dz = 1
 Opts_init.dx = 1
 Opts_init.z1 = Opts_init.nz * Opts_init.dz
 Opts_init.x1 = Opts_init.nx * Opts_init.dx
+Opts_init.SGS_mix_len = Opts_init.dz * np.ones(Opts_init.nz)
 
 Opts_init.rng_seed = int(time())
 Opts_init.sd_conc = 100
@@ -69,3 +70,54 @@ tab_out = np.copy(np.frombuffer(prtcls.outbuf()).reshape(Opts_init.nx, Opts_init
 print("after 100s \n", tab_out)
 
 assert(np.array_equal(tab_in,tab_out) == False) # turbulence should have moved SDs around
+
+# the turbulent velocity is driven by a counter-based random stream keyed from rng_seed,
+# hence a run with the same seed moves the SDs in exactly the same way
+prtcls = lgrngn.factory(Backend, Opts_init)
+prtcls.init(Th, Rv, Rhod)
+for it in range(100):
+  prtcls.step_sync(Opts, Th, Rv, Rhod, diss_rate = diss_rate)
+  prtcls.step_async(Opts)
+
+prtcls.diag_all()
+prtcls.diag_sd_conc()
+assert(np.array_equal(tab_out, np.frombuffer(prtcls.outbuf()).reshape(Opts_init.nx, Opts_init.nz)))
+
+# statistics of the normal variates: SDs released from one point with no initial perturbation
+# are displaced after one step by u' dt, with u' = sqrt((1 - exp(-2 dt / tau)) 2/3 tke) r
+# and r drawn from the counter-based stream (GA17 formulae for tke and tau);
+# displacements in x and z have to be independent, normally distributed, with zero mean
+# and the variance consistent with tke
+n_sd = 20000
+Opts_init.nx = Opts_init.nz = 1
+Opts_init.x1 = Opts_init.nx * Opts_init.dx
+Opts_init.z1 = Opts_init.nz * Opts_init.dz
+Opts_init.SGS_mix_len = Opts_init.dz * np.ones(Opts_init.nz)
+Opts_init.dry_distros = dict()
+Opts_init.sd_conc = 0
+Opts_init.n_sd_max = n_sd
+
+eps, L = 1e-4, Opts_init.SGS_mix_len[0]
+C_E, C_tau = .845, 1.5
+tke = pow(L * eps / C_E, 2./3)
+tau = L / pow(2 * pi, 1./3) * sqrt(C_tau / tke)
+var_ref = (1 - exp(-2 * Opts_init.dt / tau)) * 2./3 * tke * Opts_init.dt**2
+
+Rhod, Th, Rv = 1. * np.ones((1, 1)), 300. * np.ones((1, 1)), 0.01 * np.ones((1, 1))
+prtcls = lgrngn.factory(Backend, Opts_init)
+prtcls.init_from_attrs(Th, Rv, Rhod,
+  n = np.ones(n_sd, dtype=np.uint64), rd3 = (.04e-6)**3 * np.ones(n_sd), kappa = kappa * np.ones(n_sd),
+  x = .5 * Opts_init.dx * np.ones(n_sd), z = .5 * Opts_init.dz * np.ones(n_sd)
+)
+prtcls.step_sync(Opts, Th, Rv, Rhod, diss_rate = eps * np.ones((1, 1)))
+prtcls.step_async(Opts)
+
+dx = np.array(prtcls.get_attr("x")) - .5 * Opts_init.dx
+dz = np.array(prtcls.get_attr("z")) - .5 * Opts_init.dz
+print("displacement variance: ", dx.var(), dz.var(), " expected: ", var_ref)
+for d in [dx, dz]:
+  r = d / sqrt(var_ref)
+  assert(abs(r.mean()) < 5 / sqrt(n_sd))                  # mean 0
+  assert(abs(r.var() - 1) < 5 * sqrt(2. / n_sd))          # variance 1
+  assert(abs((r**4).mean() / r.var()**2 - 3) < 5 * sqrt(24. / n_sd)) # kurtosis of the normal distribution
+assert(abs(np.corrcoef(dx, dz)[0, 1]) < 5 / sqrt(n_sd))  # independent components
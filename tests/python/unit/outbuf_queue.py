@@ -0,0 +1,78 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+
+from libcloudphxx import lgrngn
+
+import numpy as np
+from math import exp, log, sqrt, pi
+
+def lognormal(lnr):
+  mean_r = .04e-6 / 2
+  stdev  = 1.4
+  n_tot  = 60e6
+  return n_tot * exp(
+    -pow((lnr - log(mean_r)), 2) / 2 / pow(log(stdev),2)
+  ) / log(stdev) / sqrt(2*pi);
+
+Opts_init = lgrngn.opts_init_t()
+Opts_init.dry_distros = {(.61, 0.):lognormal}
+Opts_init.dt = 1
+
+Opts_init.nx = 3
+Opts_init.nz = 4
+Opts_init.dx = 10
+Opts_init.dz = 5
+Opts_init.x1 = Opts_init.nx * Opts_init.dx
+Opts_init.z1 = Opts_init.nz * Opts_init.dz
+
+Opts_init.rng_seed = 44
+Opts_init.sd_conc = 16
+Opts_init.n_sd_max = Opts_init.sd_conc * (Opts_init.nx * Opts_init.nz)
+Opts_init.outbuf_queue_len = 2
+
+shape = (Opts_init.nx, Opts_init.nz)
+Rhod =   1. * np.ones(shape)
+Th   = 300. * np.ones(shape)
+Rv   = 0.01 * np.ones(shape)
+
+prtcls = lgrngn.factory(lgrngn.backend_t.serial, Opts_init)
+prtcls.init(Th, Rv, Rhod)
+
+assert(prtcls.outbuf_front() is None)
+
+refs = []
+for k in [0, 3]:
+  prtcls.diag_all()
+  prtcls.diag_wet_mom(k)
+  refs.append(np.frombuffer(prtcls.outbuf()).copy())
+
+  prtcls.diag_all()
+  prtcls.diag_wet_mom(k)
+  assert(prtcls.outbuf_enqueue() == len(refs) - 1)
+
+# both buffers queued, drained in order
+bufs = []
+for i, ref in enumerate(refs):
+  seq, buf = prtcls.outbuf_front()
+  assert(seq == i)
+  assert(np.array_equal(buf, ref))
+  bufs.append(buf)
+  prtcls.outbuf_pop()
+
+assert(prtcls.outbuf_front() is None)
+
+# arrays returned by outbuf_front() are not overwritten when their slots are reused
+for k in [1, 2]:
+  prtcls.diag_all()
+  prtcls.diag_wet_mom(k)
+  prtcls.outbuf_enqueue()
+for buf, ref in zip(bufs, refs):
+  assert(np.array_equal(buf, ref))
+while prtcls.outbuf_front() is not None:
+  prtcls.outbuf_pop()
+
+try:
+  prtcls.outbuf_pop()
+  raise Exception("pop from an empty queue accepted")
+except RuntimeError:
+  pass
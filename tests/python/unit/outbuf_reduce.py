@@ -0,0 +1,62 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+
+from libcloudphxx import lgrngn
+
+import numpy as np
+from math import exp, log, sqrt, pi
+
+def lognormal(lnr):
+  mean_r = .04e-6 / 2
+  stdev  = 1.4
+  n_tot  = 60e6
+  return n_tot * exp(
+    -pow((lnr - log(mean_r)), 2) / 2 / pow(log(stdev),2)
+  ) / log(stdev) / sqrt(2*pi);
+
+Opts_init = lgrngn.opts_init_t()
+Opts_init.dry_distros = {(.61, 0.):lognormal}
+Opts_init.dt = 1
+
+Opts_init.nx = 3
+Opts_init.ny = 2
+Opts_init.nz = 4
+Opts_init.dx = 10
+Opts_init.dy = 10
+Opts_init.dz = 5
+Opts_init.x1 = Opts_init.nx * Opts_init.dx
+Opts_init.y1 = Opts_init.ny * Opts_init.dy
+Opts_init.z1 = Opts_init.nz * Opts_init.dz
+
+Opts_init.rng_seed = 44
+Opts_init.sd_conc = 16
+Opts_init.n_sd_max = Opts_init.sd_conc * (Opts_init.nx * Opts_init.ny * Opts_init.nz)
+
+shape = (Opts_init.nx, Opts_init.ny, Opts_init.nz)
+# density decreasing with height
+Rhod = np.ones(shape) * np.linspace(1.2, 0.9, Opts_init.nz)
+Th   = 300. * np.ones(shape)
+Rv   = 0.01 * np.ones(shape)
+
+prtcls = lgrngn.factory(lgrngn.backend_t.serial, Opts_init)
+prtcls.init(Th, Rv, Rhod)
+
+for k in [0, 3]:
+  prtcls.diag_all()
+  prtcls.diag_wet_mom(k)
+  mom = np.frombuffer(prtcls.outbuf()).reshape(shape).copy()
+
+  prtcls.diag_all()
+  prtcls.diag_wet_mom(k)
+  profile = np.array(prtcls.outbuf_profile())
+  prtcls.diag_all()
+  prtcls.diag_wet_mom(k)
+  column = np.array(prtcls.outbuf_column())
+  prtcls.diag_all()
+  prtcls.diag_wet_mom(k)
+  domain = prtcls.outbuf_domain()
+
+  # all cells have the same volume
+  assert(np.allclose(profile, (mom * Rhod).sum(axis=(0,1)) / Rhod.sum(axis=(0,1)), rtol=1e-12))
+  assert(np.allclose(column, (mom * Rhod).sum(axis=2).flatten() * Opts_init.dz, rtol=1e-12))
+  assert(np.isclose(domain, (mom * Rhod).sum() / Rhod.sum(), rtol=1e-12))
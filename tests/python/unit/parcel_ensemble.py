@@ -0,0 +1,81 @@
+import sys
+sys.path.insert(0, "../../bindings/python/")
+
+from libcloudphxx import lgrngn
+
+import numpy as np
+
+rho_stp = 1.2248
+
+Opts_init = lgrngn.opts_init_t()
+Opts_init.dry_sizes = {(.61, 0.) : {.1e-6 : [60e6 * rho_stp, 8], .05e-6 : [100e6 * rho_stp, 8]}}
+Opts_init.dt = 1
+Opts_init.sstp_cond = 5
+Opts_init.n_sd_max = 64
+
+Opts = lgrngn.opts_t()
+Opts.adve = False
+Opts.sedi = False
+Opts.coal = False
+Opts.cond = True
+
+# parcels differing in humidity, temperature and density
+th   = np.array([300., 301., 299.])
+rv   = np.array([.0125, .0135, .0115])
+rhod = np.array([1.1, 1.0, .9])
+n_ens = th.size
+
+def run(prtcls, th, rv, rhod):
+  prtcls.init(th, rv, rhod)
+  for t in range(5):
+    prtcls.step_sync(Opts, th, rv, rhod)
+    prtcls.step_async(Opts)
+  prtcls.diag_all()
+  prtcls.diag_wet_mom(3)
+  return np.frombuffer(prtcls.outbuf()).copy()
+
+# all members at once
+ens_th, ens_rv = th.copy(), rv.copy()
+Opts_init.n_ens = n_ens
+Opts_init.n_sd_max = 64 * n_ens
+ens = run(lgrngn.factory(lgrngn.backend_t.serial, Opts_init), ens_th, ens_rv, rhod.copy())
+assert(ens.size == n_ens)
+
+# one by one
+Opts_init.n_ens = 1
+Opts_init.n_sd_max = 64
+for m in range(n_ens):
+  one_th, one_rv = th[m:m+1].copy(), rv[m:m+1].copy()
+  one = run(lgrngn.factory(lgrngn.backend_t.serial, Opts_init), one_th, one_rv, rhod[m:m+1].copy())
+  assert(np.isclose(ens[m], one[0], rtol=1e-10))
+  assert(np.isclose(ens_th[m], one_th[0], rtol=1e-10))
+  assert(np.isclose(ens_rv[m], one_rv[0], rtol=1e-10))
+
+# the same with SDs from a dry size distribution: multiplicities are evaluated for the volume
+# of the first parcel and rescaled to the volume of each member (1 kg of dry air, i.e. 1/rhod)
+def lognormal(lnr):
+  from math import exp, log, sqrt, pi
+  mean_r, stdev, n_tot = .04e-6, 1.4, 60e6 * rho_stp
+  return n_tot * exp(-pow((lnr - log(mean_r)), 2) / 2 / pow(log(stdev), 2)) / log(stdev) / sqrt(2 * pi)
+
+Opts_init.dry_sizes = dict()
+Opts_init.dry_distros = {.61 : lognormal}
+Opts_init.sd_conc = 1024
+
+def conc(prtcls, th, rv, rhod):
+  prtcls.init(th, rv, rhod)
+  prtcls.diag_all()
+  prtcls.diag_dry_mom(0)
+  return np.frombuffer(prtcls.outbuf()).copy()
+
+Opts_init.n_ens = n_ens
+Opts_init.n_sd_max = Opts_init.sd_conc * n_ens
+ens = conc(lgrngn.factory(lgrngn.backend_t.serial, Opts_init), th.copy(), rv.copy(), rhod.copy())
+
+Opts_init.n_ens = 1
+Opts_init.n_sd_max = Opts_init.sd_conc
+for m in range(n_ens):
+  one = conc(lgrngn.factory(lgrngn.backend_t.serial, Opts_init), th[m:m+1].copy(), rv[m:m+1].copy(), rhod[m:m+1].copy())
+  # SD radii are drawn randomly within the bins, hence only approximately equal
+  # (without the rescaling, members would differ by the ratio of their rhod)
+  assert(np.isclose(ens[m], one[0], rtol=1e-2))
@@ -121,33 +121,34 @@ print(('wet mom1', wet_mom1))
 if (abs( (7.84 / 2.12) - (wet_mom1[0] + wet_mom1[2]) / (wet_mom1[1] + wet_mom1[3]) ) > 0.015):
   raise Exception("incorrect radius after source")
 
-# --------------- test source with dry_distros matching ------------------
-print(' --- dry_distros matching src ---')
-opts_init = lgrngn.opts_init_t()
-opts = lgrngn.opts_t()
-opts_init.dry_distros = {(kappa, rd_insol):lognormal}
-opts_init.sd_conc = 1024
-src_sd_conc = 512
-supstp_src = 50
-opts.src_dry_distros = {(kappa, rd_insol):(lognormal_src, src_sd_conc, supstp_src)}
-opts_init.n_sd_max = int((opts_init.sd_conc * 2 + src_sd_conc * 2) * 2) # assuming nx=nz=2
-opts_init.src_type = lgrngn.src_t.matching
-
-sd_conc, wet_mom0, wet_mom1 = test(opts_init, opts)
-
-print('diag_sd_conc', sd_conc)
-if not((sd_conc[0] == 1164 or sd_conc[0] == 1165) and (sd_conc[2] == 1164 or sd_conc[2] == 1165)):
-  raise Exception("wrong amount of SDs were added")
-if not(sd_conc[1] == 1024 and sd_conc[3] == 1024):
-  raise Exception("SDs were added in wrong cells")
-
-print(('wet mom0', wet_mom0))
-if (abs( 2 - (wet_mom0[0] + wet_mom0[2]) / (wet_mom0[1] + wet_mom0[3]) ) > 0.015):
-  raise Exception("incorrect multiplicity after source")
-
-print(('wet mom1', wet_mom1))
-if (abs( (7.84 / 2.12) - (wet_mom1[0] + wet_mom1[2]) / (wet_mom1[1] + wet_mom1[3]) ) > 0.015):
-  raise Exception("incorrect radius after source")
+# --------------- test source with dry_distros matching (and its indexed variant) ------------------
+for src_type in [lgrngn.src_t.matching, lgrngn.src_t.matching_indexed]:
+  print(' --- dry_distros', src_type, 'src ---')
+  opts_init = lgrngn.opts_init_t()
+  opts = lgrngn.opts_t()
+  opts_init.dry_distros = {(kappa, rd_insol):lognormal}
+  opts_init.sd_conc = 1024
+  src_sd_conc = 512
+  supstp_src = 50
+  opts.src_dry_distros = {(kappa, rd_insol):(lognormal_src, src_sd_conc, supstp_src)}
+  opts_init.n_sd_max = int((opts_init.sd_conc * 2 + src_sd_conc * 2) * 2) # assuming nx=nz=2
+  opts_init.src_type = src_type
+
+  sd_conc, wet_mom0, wet_mom1 = test(opts_init, opts)
+
+  print('diag_sd_conc', sd_conc)
+  if not((sd_conc[0] == 1164 or sd_conc[0] == 1165) and (sd_conc[2] == 1164 or sd_conc[2] == 1165)):
+    raise Exception("wrong amount of SDs were added")
+  if not(sd_conc[1] == 1024 and sd_conc[3] == 1024):
+    raise Exception("SDs were added in wrong cells")
+
+  print(('wet mom0', wet_mom0))
+  if (abs( 2 - (wet_mom0[0] + wet_mom0[2]) / (wet_mom0[1] + wet_mom0[3]) ) > 0.015):
+    raise Exception("incorrect multiplicity after source")
+
+  print(('wet mom1', wet_mom1))
+  if (abs( (7.84 / 2.12) - (wet_mom1[0] + wet_mom1[2]) / (wet_mom1[1] + wet_mom1[3]) ) > 0.015):
+    raise Exception("incorrect radius after source")
 
 # --------- test source with dry_sizes ------------
 print(' --- dry_sizes src ---')